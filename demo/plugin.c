@@ -1,117 +1,1843 @@
+#define _POSIX_C_SOURCE 199309L // for clock_gettime()
+
 #include "plugin.h"
 
-#include <station/plugin.typ.h>
-#include <station/buffer.typ.h>
+#include <station/plugin.typ.h>
+#include <station/buffer.typ.h>
+
+#include <station/signal.typ.h>
+
+#include <station/concurrent.fun.h>
+#include <station/sdl.fun.h>
+#include <station/buffer.fun.h>
+#include <station/font.fun.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdatomic.h>
+#include <stdalign.h>
+#include <stdarg.h>
+#include <signal.h>
+#include <time.h> // for clock_gettime(), clock()
+#include <unistd.h> // for alarm(), sysconf()
+#include <poll.h>
+
+
+// Signal handler function
+static STATION_SIGNAL_HANDLER_FUNC(signal_handler) // implicit arguments: signo, siginfo, std_signals, rt_signals, data
+{
+    (void) siginfo;
+    (void) std_signals;
+    (void) rt_signals;
+    (void) data;
+
+    if ((signo >= SIGRTMIN) && (signo <= SIGRTMAX))
+    {
+        if (signo <= SIGRTMIN + (SIGRTMAX-SIGRTMIN)/2)
+            printf("Caught real-time signal SIGRTMIN%+i!\n", signo - SIGRTMIN);
+        else
+            printf("Caught real-time signal SIGRTMAX%+i!\n", signo - SIGRTMAX);
+    }
+
+    return true;
+}
+
+// Concurrent processing callback function
+static STATION_PFUNC_CALLBACK(pfunc_cb_flag) // implicit arguments: data, thread_idx
+{
+    (void) thread_idx;
+
+    atomic_bool *flag = data;
+    *flag = true;
+}
+
+// Callback for stress-tests alternating blocking and non-blocking calls
+static station_pfunc_callback_t stress_test_callback(unsigned iteration)
+{
+    return (iteration % 4 < 2) ? pfunc_cb_flag : NULL;
+}
+
+// Wait until a stress-test call is done, non-blocking calls set the flag from the callback
+static void stress_test_wait(station_pfunc_callback_t callback, atomic_bool *flag)
+{
+    if (callback != NULL)
+    {
+        // Busy-wait until done
+        while (!*flag);
+        *flag = false;
+    }
+}
+
+// Alternate scheduling modes and caller participation between stress-test iterations
+static void stress_test_iteration(station_concurrent_processing_context_t *context, unsigned iteration)
+{
+    static const station_concurrent_processing_schedule_t schedules[] = {
+        STATION_CONCURRENT_PROCESSING_SCHEDULE_DYNAMIC,
+        STATION_CONCURRENT_PROCESSING_SCHEDULE_WORK_STEALING,
+        STATION_CONCURRENT_PROCESSING_SCHEDULE_STATIC,
+        STATION_CONCURRENT_PROCESSING_SCHEDULE_GUIDED,
+        STATION_CONCURRENT_PROCESSING_SCHEDULE_ADAPTIVE,
+    };
+
+    context->schedule = schedules[iteration % (sizeof(schedules) / sizeof(*schedules))];
+    context->caller_participation = iteration % 2;
+}
+
+// Fail the stress-test with a message if condition doesn't hold
+static void stress_test_check(bool condition, const char *format, ...)
+{
+    if (condition)
+        return;
+
+    va_list args;
+    va_start(args, format);
+    vprintf(format, args);
+    va_end(args);
+
+    printf("\n");
+    exit(1);
+}
+
+// Concurrent processing function
+static STATION_PFUNC(pfunc_inc) // implicit arguments: data, task_idx, thread_idx
+{
+    (void) thread_idx;
+
+    struct plugin_resources *resources = data;
+
+    // Increment the counter safely
+    mtx_lock(&resources->counter_mutex);
+    resources->counter += task_idx;
+    mtx_unlock(&resources->counter_mutex);
+}
+
+// Concurrent processing function
+static STATION_PFUNC(pfunc_dec) // implicit arguments: data, task_idx, thread_idx
+{
+    (void) thread_idx;
+
+    struct plugin_resources *resources = data;
+
+    // Decrement the counter safely
+    mtx_lock(&resources->counter_mutex);
+    resources->counter -= task_idx;
+    mtx_unlock(&resources->counter_mutex);
+}
+
+// Concurrent processing function
+static STATION_PFUNC(pfunc_queue) // implicit arguments: data, task_idx, thread_idx
+{
+    (void) thread_idx;
+
+    struct plugin_resources *resources = data;
+
+    while (!station_queue_push(resources->queue, &task_idx)); // wait until push
+    task_idx = 0;
+    while (!station_queue_pop(resources->queue, &task_idx)); // wait until pop
+
+    // Increment the counter safely
+    mtx_lock(&resources->counter_mutex);
+    resources->counter += task_idx;
+    mtx_unlock(&resources->counter_mutex);
+}
+
+// Concurrent processing function
+static STATION_PFUNC(pfunc_max_thread_idx) // implicit arguments: data, task_idx, thread_idx
+{
+    (void) task_idx;
+
+    atomic_uint *max_thread_idx = data;
+
+    // Remember the largest index of a thread processing tasks
+    unsigned value = atomic_load(max_thread_idx);
+    while ((value < thread_idx) && !atomic_compare_exchange_weak(max_thread_idx, &value, thread_idx));
+}
+
+// Concurrent processing function updating a block of data
+static STATION_PFUNC(pfunc_sticky) // implicit arguments: data, task_idx, thread_idx
+{
+    struct sticky_data *sticky = data;
+
+    float *block = sticky->blocks + (size_t)task_idx * BENCH_STICKY_BLOCK_SIZE;
+    for (unsigned i = 0; i < BENCH_STICKY_BLOCK_SIZE; i++)
+        block[i] = block[i] * 0.5f + 1.0f;
+
+    // Remember which thread has the block in its cache
+    sticky->owners[task_idx] = thread_idx;
+}
+
+// Concurrent processing function for ranges of tasks in 64-bit task index space
+static STATION_PFUNC_RANGE64(pfunc_range64_sum) // implicit arguments: data, task_idx_begin, task_idx_end, thread_idx
+{
+    (void) thread_idx;
+
+    struct range64_data *range64_data = data;
+
+    // Sum of [B; B+L-1] is B*L + L*(L-1)/2, one of L and L-1 is even
+    station_tasks_number64_t length = task_idx_end - task_idx_begin;
+    station_task_idx64_t sum = task_idx_begin * length +
+        ((length % 2 == 0) ? (length / 2) * (length - 1) : length * ((length - 1) / 2));
+
+    // Accumulate safely
+    mtx_lock(range64_data->mutex);
+    range64_data->num_tasks += length;
+    range64_data->sum += sum;
+    mtx_unlock(range64_data->mutex);
+}
+
+// Concurrent processing function
+static STATION_PFUNC(pfunc_arena) // implicit arguments: data, task_idx, thread_idx
+{
+    struct plugin_resources *resources = data;
+
+    // Temporary memory without malloc(), it is freed at the end of execute
+    int *array = station_concurrent_processing_arena_allocate(
+            resources->concurrent_processing_context, thread_idx,
+            sizeof(int) * ARENA_NUM_INTS, _Alignof(int));
+    if (array == NULL)
+        return;
+
+    for (int i = 0; i < ARENA_NUM_INTS; i++)
+        array[i] = task_idx;
+
+    int sum = 0;
+    for (int i = 0; i < ARENA_NUM_INTS; i++)
+        sum += array[i];
+
+    // Increment the counter safely
+    mtx_lock(&resources->counter_mutex);
+    resources->counter += sum / ARENA_NUM_INTS;
+    mtx_unlock(&resources->counter_mutex);
+}
+
+// Concurrent processing function
+static STATION_PFUNC(pfunc_search) // implicit arguments: data, task_idx, thread_idx
+{
+    (void) thread_idx;
+
+    struct plugin_resources *resources = data;
+
+    // Count processed tasks safely
+    mtx_lock(&resources->counter_mutex);
+    resources->counter++;
+    mtx_unlock(&resources->counter_mutex);
+
+    // Remaining tasks are pointless after the target is found
+    if (task_idx == SEARCH_TARGET)
+        station_concurrent_processing_cancel(resources->concurrent_processing_context, 0);
+}
+
+// Concurrent reduction accumulate function
+static STATION_PFUNC_ACCUMULATE(pfunc_sum_accumulate) // implicit arguments: data, partial, task_idx, thread_idx
+{
+    (void) data;
+    (void) thread_idx;
+
+    // No mutex is needed, as every thread has own partial sum
+    *(long*)partial += task_idx;
+}
+
+// Concurrent reduction combine function
+static STATION_PFUNC_COMBINE(pfunc_sum_combine) // implicit arguments: data, partial, other_partial
+{
+    (void) data;
+
+    *(long*)partial += *(const long*)other_partial;
+}
+
+// Concurrent processing function summing a half of the range by nested executes
+static STATION_PFUNC(pfunc_nested_split) // implicit arguments: data, task_idx, thread_idx
+{
+    (void) thread_idx;
+
+    struct nested_data *range = data;
+    station_task_idx_t middle = range->begin + (range->end - range->begin) / 2;
+
+    struct nested_data half = {.context = range->context,
+        .begin = (task_idx == 0) ? range->begin : middle,
+        .end = (task_idx == 0) ? middle : range->end};
+
+    // Threads of the context are busy with the current job, so they help with the nested one
+    if (half.end - half.begin <= NESTED_LEAF_SIZE)
+        station_concurrent_processing_reduce(half.context, half.end - half.begin, 0,
+                pfunc_nested_accumulate, pfunc_sum_combine, &half, sizeof(range->sums[task_idx]),
+                NULL, &range->sums[task_idx], NULL, NULL, false);
+    else
+    {
+        station_concurrent_processing_execute(half.context, 2, 1, pfunc_nested_split, &half,
+                NULL, NULL, false);
+
+        range->sums[task_idx] = half.sums[0] + half.sums[1];
+    }
+}
+
+// Concurrent reduction accumulate function for a range of tasks
+static STATION_PFUNC_ACCUMULATE(pfunc_nested_accumulate) // implicit arguments: data, partial, task_idx, thread_idx
+{
+    (void) thread_idx;
+
+    const struct nested_data *range = data;
+
+    *(long*)partial += range->begin + task_idx;
+}
+
+// Concurrent processing function submitting more jobs than the queue holds
+static STATION_PFUNC(pfunc_nested_submit) // implicit arguments: data, task_idx, thread_idx
+{
+    (void) task_idx;
+    (void) thread_idx;
+
+    struct nested_submit_data *submit_data = data;
+
+    // Submission fails instead of waiting for the own job when the queue is full
+    for (unsigned i = 0; i < NESTED_NUM_SUBMITS; i++)
+        if (station_concurrent_processing_submit(submit_data->context, 1, 1,
+                    pfunc_nested_count, submit_data, NULL, NULL) != 0)
+            submit_data->num_submitted++;
+}
+
+// Concurrent processing function counting processed jobs
+static STATION_PFUNC(pfunc_nested_count) // implicit arguments: data, task_idx, thread_idx
+{
+    (void) task_idx;
+    (void) thread_idx;
+
+    struct nested_submit_data *submit_data = data;
+    atomic_fetch_add(&submit_data->num_done, 1);
+}
+
+// Scan combine function
+static STATION_PFUNC_COMBINE(pfunc_add_combine) // implicit arguments: data, partial, other_partial
+{
+    (void) data;
+
+    *(uint32_t*)partial += *(const uint32_t*)other_partial;
+}
+
+// Histogram bin function
+static STATION_PFUNC_BIN(pfunc_key_bin) // implicit arguments: data, element_idx
+{
+    const uint32_t *keys = data;
+
+    return keys[element_idx] % ALGORITHMS_NUM_BINS;
+}
+
+// Stream compaction predicate function
+static STATION_PFUNC_PREDICATE(pfunc_key_is_even) // implicit arguments: data, element_idx
+{
+    const uint32_t *keys = data;
+
+    return keys[element_idx] % 2 == 0;
+}
+
+// Concurrent processing function for tiles of iteration domain
+static STATION_PFUNC_TILE(pfunc_tile_mark) // implicit arguments: data, tile, thread_idx
+{
+    (void) thread_idx;
+
+    unsigned char *marks = data;
+
+    // Tiles don't overlap, so no mutex is needed
+    for (station_task_idx_t z = tile->z.begin; z < tile->z.end; z++)
+        for (station_task_idx_t y = tile->y.begin; y < tile->y.end; y++)
+            for (station_task_idx_t x = tile->x.begin; x < tile->x.end; x++)
+                marks[((z - TILED_ORIGIN_Z) * TILED_HEIGHT + (y - TILED_ORIGIN_Y)) * TILED_WIDTH +
+                    (x - TILED_ORIGIN_X)]++;
+}
+
+// Concurrent processing functions for nodes of task graph
+static STATION_PFUNC_RANGE(pfunc_graph_simulate) // implicit arguments: data, task_idx_begin, task_idx_end, thread_idx
+{
+    (void) thread_idx;
+
+    struct graph_data *graph_data = data;
+
+    for (station_task_idx_t task_idx = task_idx_begin; task_idx < task_idx_end; task_idx++)
+        graph_data->input[task_idx] = task_idx + graph_data->iteration;
+}
+
+static STATION_PFUNC_RANGE(pfunc_graph_double) // implicit arguments: data, task_idx_begin, task_idx_end, thread_idx
+{
+    (void) thread_idx;
+
+    struct graph_data *graph_data = data;
+
+    for (station_task_idx_t task_idx = task_idx_begin; task_idx < task_idx_end; task_idx++)
+        graph_data->doubled[task_idx] = graph_data->input[task_idx] * 2;
+}
+
+static STATION_PFUNC_RANGE(pfunc_graph_increment) // implicit arguments: data, task_idx_begin, task_idx_end, thread_idx
+{
+    (void) thread_idx;
+
+    struct graph_data *graph_data = data;
+
+    for (station_task_idx_t task_idx = task_idx_begin; task_idx < task_idx_end; task_idx++)
+        graph_data->incremented[task_idx] = graph_data->input[task_idx] + 1;
+}
+
+static STATION_PFUNC_RANGE(pfunc_graph_compose) // implicit arguments: data, task_idx_begin, task_idx_end, thread_idx
+{
+    (void) thread_idx;
+
+    struct graph_data *graph_data = data;
+
+    for (station_task_idx_t task_idx = task_idx_begin; task_idx < task_idx_end; task_idx++)
+        graph_data->composed[task_idx] =
+            graph_data->doubled[task_idx] + graph_data->incremented[task_idx];
+}
+
+// Concurrent processing functions for phases of multi-phase execute,
+// every phase reads elements written by other tasks of the previous one
+static STATION_PFUNC_RANGE(pfunc_phase_fill) // implicit arguments: data, task_idx_begin, task_idx_end, thread_idx
+{
+    (void) thread_idx;
+
+    struct phases_data *phases_data = data;
+
+    for (station_task_idx_t task_idx = task_idx_begin; task_idx < task_idx_end; task_idx++)
+        phases_data->filled[task_idx] = task_idx + phases_data->iteration;
+}
+
+static STATION_PFUNC(pfunc_phase_double) // implicit arguments: data, task_idx, thread_idx
+{
+    (void) thread_idx;
+
+    struct phases_data *phases_data = data;
+
+    phases_data->doubled[task_idx] = phases_data->filled[PHASES_NUM_TASKS - 1 - task_idx] * 2;
+}
+
+static STATION_PFUNC_RANGE(pfunc_phase_sum) // implicit arguments: data, task_idx_begin, task_idx_end, thread_idx
+{
+    (void) thread_idx;
+
+    struct phases_data *phases_data = data;
+
+    for (station_task_idx_t task_idx = task_idx_begin; task_idx < task_idx_end; task_idx++)
+        phases_data->summed[task_idx] =
+            phases_data->doubled[PHASES_NUM_TASKS - 1 - task_idx] + phases_data->filled[task_idx];
+}
+
+// Persistent concurrent processing function smoothing elements, every sweep reads
+// elements written by neighbouring threads in the previous one
+static STATION_PFUNC_PERSISTENT(pfunc_persistent_smooth) // implicit arguments: data, thread_idx, num_threads
+{
+    struct barrier_data *barrier_data = data;
+
+    // Every thread processes the same elements in every sweep
+    station_task_idx_t begin, end;
+    station_concurrent_processing_static_range(BARRIER_NUM_ELEMENTS, num_threads, thread_idx, &begin, &end);
+
+    for (unsigned sweep = 0; sweep < barrier_data->num_sweeps; sweep++)
+    {
+        const station_task_idx_t *src = barrier_data->elements[sweep % 2];
+        station_task_idx_t *dst = barrier_data->elements[(sweep + 1) % 2];
+
+        for (station_task_idx_t i = begin; i < end; i++)
+            dst[i] = ((i > 0) ? src[i - 1] : 0) + 2 * src[i] +
+                ((i < BARRIER_NUM_ELEMENTS - 1) ? src[i + 1] : 0);
+
+        if (!station_concurrent_processing_barrier(barrier_data->context, thread_idx))
+        {
+            printf("barrier is not available in persistent function\n");
+            exit(1);
+        }
+    }
+}
+
+// Persistent concurrent processing function only waiting at barriers
+static STATION_PFUNC_PERSISTENT(pfunc_persistent_barriers) // implicit arguments: data, thread_idx, num_threads
+{
+    (void) num_threads;
+
+    struct barrier_data *barrier_data = data;
+
+    for (unsigned sweep = 0; sweep < barrier_data->num_sweeps; sweep++)
+        station_concurrent_processing_barrier(barrier_data->context, thread_idx);
+}
+
+// Pipeline stage functions: source -> transform -> sink
+static STATION_PFUNC_STAGE(pfunc_stage_source) // implicit arguments: data, input, output, thread_idx
+{
+    (void) input;
+    (void) thread_idx;
+
+    struct pipeline_data *pipeline_data = data;
+
+    // The source stage has a single thread
+    if (pipeline_data->next_item == pipeline_data->num_items)
+        return false;
+
+    *(station_task_idx_t*)output = pipeline_data->next_item++;
+    return true;
+}
+
+static STATION_PFUNC_STAGE(pfunc_stage_transform) // implicit arguments: data, input, output, thread_idx
+{
+    (void) thread_idx;
+
+    const struct pipeline_data *pipeline_data = data;
+    station_task_idx_t item = *(const station_task_idx_t*)input;
+
+    // Drop every third item
+    if (item % 3 == 0)
+        return false;
+
+    // Simulate work
+    uint32_t hash = item;
+    for (unsigned i = 0; i < pipeline_data->transform_cost; i++)
+        hash = (hash ^ (hash >> 15)) * 0x2c1b3c6d;
+
+    ((uint64_t*)output)[0] = (uint64_t)item * 2 + 1;
+    ((uint64_t*)output)[1] = hash;
+    return true;
+}
+
+static STATION_PFUNC_STAGE(pfunc_stage_sink) // implicit arguments: data, input, output, thread_idx
+{
+    (void) output;
+    (void) thread_idx;
+
+    struct pipeline_data *pipeline_data = data;
+
+    // The sink stage has a single thread
+    pipeline_data->num_received++;
+    pipeline_data->sum += ((const uint64_t*)input)[0];
+    return true;
+}
+
+// Concurrent processing function
+static STATION_PFUNC(pfunc_bench) // implicit arguments: data, task_idx, thread_idx
+{
+    (void) thread_idx;
+
+    station_task_idx_t *array = data;
+
+    // Do almost nothing, so that scheduling overhead dominates
+    array[task_idx] = task_idx;
+}
+
+// Concurrent processing function
+static STATION_PFUNC(pfunc_bench_skewed) // implicit arguments: data, task_idx, thread_idx
+{
+    (void) thread_idx;
+
+    station_task_idx_t *array = data;
+
+    // Cost of a task grows with its index
+    station_task_idx_t value = task_idx;
+    for (station_task_idx_t i = 0; i < task_idx / BENCH_SKEWED_COST_DIVISOR; i++)
+        value = value * 1103515245 + 12345;
+
+    array[task_idx] = value;
+}
+
+// Concurrent processing function for ranges of tasks
+static STATION_PFUNC_RANGE(pfunc_bench_range) // implicit arguments: data, task_idx_begin, task_idx_end, thread_idx
+{
+    (void) thread_idx;
+
+    station_task_idx_t *array = data;
+
+    // Same as pfunc_bench(), but the loop is visible to the compiler
+    for (station_task_idx_t task_idx = task_idx_begin; task_idx < task_idx_end; task_idx++)
+        array[task_idx] = task_idx;
+}
+
+// Concurrent processing function for benchmarking
+static STATION_PFUNC_RANGE64(pfunc_bench_range64) // implicit arguments: data, task_idx_begin, task_idx_end, thread_idx
+{
+    (void) thread_idx;
+
+    station_task_idx_t *array = data;
+
+    // Same as pfunc_bench_range(), but with 64-bit task indices
+    for (station_task_idx64_t task_idx = task_idx_begin; task_idx < task_idx_end; task_idx++)
+        array[task_idx] = task_idx;
+}
+
+#ifdef STATION_IS_SDL_SUPPORTED
+// Concurrent processing function for tiles of texture
+static STATION_PFUNC_TILE(pfunc_draw) // implicit arguments: data, tile, thread_idx
+{
+    (void) thread_idx;
+
+    struct plugin_resources *resources = data;
+
+    uint32_t pitch = resources->sdl_window.texture.lock.pitch;
+
+    // Tile coordinates are texture coordinates, so pixels of the tile are found directly
+    for (station_task_idx_t y = tile->y.begin; y < tile->y.end; y++)
+    {
+        uint32_t *row = resources->sdl_window.texture.lock.pixels +
+            (y - resources->sdl_window.texture.lock.rectangle.y) * pitch;
+
+        for (station_task_idx_t x = tile->x.begin; x < tile->x.end; x++)
+        {
+            // Generate a simple animation
+            uint32_t pixel = ((x+y) + resources->frame) & 0xFF;
+            pixel = 0xFF000000 | (pixel << 16) | (pixel << 8) | pixel;
+
+            // Update the texture
+            row[x - resources->sdl_window.texture.lock.rectangle.x] = pixel;
+        }
+    }
+}
+#endif
+
+
+// Measure average time of calls in milliseconds
+static double benchmark_time(station_concurrent_processing_context_t *context,
+        void (*call)(station_concurrent_processing_context_t *context, void *data),
+        void *data, unsigned num_calls)
+{
+    // Monotonic clock isn't affected by adjustments of system time
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    for (unsigned i = 0; i < num_calls; i++)
+        call(context, data);
+
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    return ((end.tv_sec - start.tv_sec) * 1e3 + (end.tv_nsec - start.tv_nsec) * 1e-6) / num_calls;
+}
+
+// Perform a blocking execute
+static void call_execute(station_concurrent_processing_context_t *context, void *data)
+{
+    struct benchmark_execute_data *args = data;
+
+    if (args->pfunc != NULL)
+        station_concurrent_processing_execute(context, args->num_tasks, args->batch_size,
+                args->pfunc, args->pfunc_data, NULL, NULL, context->busy_wait); // blocking call
+    else if (args->pfunc_range != NULL)
+        station_concurrent_processing_execute_range(context, args->num_tasks, args->batch_size,
+                args->pfunc_range, args->pfunc_data, NULL, NULL, context->busy_wait); // blocking call
+    else
+        station_concurrent_processing_execute_range64(context, args->num_tasks, args->batch_size,
+                args->pfunc_range64, args->pfunc_data, NULL, NULL, context->busy_wait); // blocking call
+}
+
+// Perform a blocking reduction
+static void call_reduce(station_concurrent_processing_context_t *context, void *data)
+{
+    struct benchmark_execute_data *args = data;
+    long sum;
+
+    station_concurrent_processing_reduce(context, args->num_tasks, args->batch_size,
+            pfunc_sum_accumulate, pfunc_sum_combine, NULL,
+            sizeof(sum), NULL, &sum, NULL, NULL, context->busy_wait); // blocking call
+}
+
+// Measure average time of a blocking execute in milliseconds
+static double benchmark_execute(station_concurrent_processing_context_t *context,
+        station_tasks_number_t num_tasks, station_tasks_number_t batch_size,
+        station_pfunc_t pfunc, void *pfunc_data)
+{
+    return benchmark_time(context, call_execute, &(struct benchmark_execute_data){
+            .num_tasks = num_tasks, .batch_size = batch_size,
+            .pfunc = pfunc, .pfunc_data = pfunc_data}, BENCH_NUM_ITERATIONS);
+}
+
+// Measure average time of a blocking execute in milliseconds
+static double benchmark_execute_range(station_concurrent_processing_context_t *context,
+        station_tasks_number_t num_tasks, station_tasks_number_t batch_size,
+        station_pfunc_range_t pfunc_range, void *pfunc_data)
+{
+    return benchmark_time(context, call_execute, &(struct benchmark_execute_data){
+            .num_tasks = num_tasks, .batch_size = batch_size,
+            .pfunc_range = pfunc_range, .pfunc_data = pfunc_data}, BENCH_NUM_ITERATIONS);
+}
+
+// Measure average time of a blocking execute for ranges of tasks in 64-bit task index space in milliseconds
+static double benchmark_execute_range64(station_concurrent_processing_context_t *context,
+        station_tasks_number_t num_tasks, station_tasks_number_t batch_size,
+        station_pfunc_range64_t pfunc_range64, void *pfunc_data)
+{
+    return benchmark_time(context, call_execute, &(struct benchmark_execute_data){
+            .num_tasks = num_tasks, .batch_size = batch_size,
+            .pfunc_range64 = pfunc_range64, .pfunc_data = pfunc_data}, BENCH_NUM_ITERATIONS);
+}
+
+// Measure average time of a blocking reduction in milliseconds
+static double benchmark_reduce(station_concurrent_processing_context_t *context,
+        station_tasks_number_t num_tasks, station_tasks_number_t batch_size)
+{
+    return benchmark_time(context, call_reduce, &(struct benchmark_execute_data){
+            .num_tasks = num_tasks, .batch_size = batch_size}, BENCH_NUM_ITERATIONS);
+}
+
+// Perform a parallel algorithm
+static void call_algorithm(station_concurrent_processing_context_t *context, void *data)
+{
+    struct benchmark_algorithm_data *args = data;
+    struct algorithms_data *algorithms_data = args->data;
+    size_t num_elements = args->num_elements;
+
+    switch (args->algorithm)
+    {
+        case 0:
+            station_concurrent_processing_memcpy(context, algorithms_data->payloads, algorithms_data->keys,
+                    sizeof(*algorithms_data->keys) * num_elements, context->busy_wait);
+            break;
+
+        case 1:
+            station_concurrent_processing_memset(context, algorithms_data->payloads, 0,
+                    sizeof(*algorithms_data->payloads) * num_elements, context->busy_wait);
+            break;
+
+        case 2:
+            station_concurrent_processing_scan(context, algorithms_data->keys, algorithms_data->payloads,
+                    num_elements, sizeof(*algorithms_data->keys), pfunc_add_combine, NULL, NULL,
+                    false, context->busy_wait);
+            break;
+
+        case 3:
+            station_concurrent_processing_radix_sort(context,
+                    algorithms_data->keys, sizeof(*algorithms_data->keys),
+                    algorithms_data->payloads, sizeof(*algorithms_data->payloads),
+                    num_elements, context->busy_wait);
+            break;
+
+        case 4:
+            station_concurrent_processing_histogram(context, num_elements,
+                    pfunc_key_bin, algorithms_data->keys, ALGORITHMS_NUM_BINS, algorithms_data->histogram,
+                    context->busy_wait);
+            break;
+
+        case 5:
+            station_concurrent_processing_compact(context, algorithms_data->keys, algorithms_data->selected,
+                    num_elements, sizeof(*algorithms_data->keys), pfunc_key_is_even, algorithms_data->keys,
+                    NULL, context->busy_wait);
+            break;
+    }
+}
+
+// Measure average time of a parallel algorithm in milliseconds
+static double benchmark_algorithm(station_concurrent_processing_context_t *context,
+        unsigned algorithm, struct algorithms_data *data, size_t num_elements)
+{
+    double time = 0;
+
+    for (unsigned i = 0; i < BENCH_ALGORITHMS_NUM_ITERATIONS; i++)
+    {
+        // Sorting needs unsorted keys every time
+        for (size_t j = 0; j < num_elements; j++)
+            data->keys[j] = data->original[j];
+
+        time += benchmark_time(context, call_algorithm, &(struct benchmark_algorithm_data){
+                .algorithm = algorithm, .data = data, .num_elements = num_elements}, 1);
+    }
+
+    return time / BENCH_ALGORITHMS_NUM_ITERATIONS;
+}
+
+// Measure average time of a frame updating the same blocks in milliseconds,
+// and fraction of tasks processed by another thread than in the previous frame
+static double benchmark_sticky(station_concurrent_processing_context_t *context,
+        station_tasks_number_t batch_size, struct sticky_data *sticky,
+        station_thread_idx_t *prev_owners, double *migrated)
+{
+    unsigned long num_migrated = 0;
+    double time = 0;
+
+    // The first frame warms caches up
+    station_concurrent_processing_execute(context, BENCH_STICKY_NUM_TASKS, batch_size,
+            pfunc_sticky, sticky, NULL, NULL, context->busy_wait); // blocking call
+
+    for (unsigned i = 0; i < BENCH_STICKY_NUM_FRAMES; i++)
+    {
+        memcpy(prev_owners, sticky->owners, sizeof(*prev_owners) * BENCH_STICKY_NUM_TASKS);
+
+        time += benchmark_time(context, call_execute, &(struct benchmark_execute_data){
+                .num_tasks = BENCH_STICKY_NUM_TASKS, .batch_size = batch_size,
+                .pfunc = pfunc_sticky, .pfunc_data = sticky}, 1);
+
+        for (station_task_idx_t task_idx = 0; task_idx < BENCH_STICKY_NUM_TASKS; task_idx++)
+            if (sticky->owners[task_idx] != prev_owners[task_idx])
+                num_migrated++;
+    }
+
+    *migrated = (double)num_migrated / ((double)BENCH_STICKY_NUM_TASKS * BENCH_STICKY_NUM_FRAMES);
+    return time / BENCH_STICKY_NUM_FRAMES;
+}
+
+// Compare cache reuse of scheduling modes on repeated frames over the same data
+static void benchmark_sticky_modes(station_concurrent_processing_context_t *context)
+{
+    // Blocks of every thread are placed on its NUMA node
+    struct sticky_data sticky = {
+        .blocks = station_concurrent_processing_allocate_first_touch(context,
+                BENCH_STICKY_NUM_TASKS, sizeof(*sticky.blocks) * BENCH_STICKY_BLOCK_SIZE),
+        .owners = calloc(BENCH_STICKY_NUM_TASKS, sizeof(*sticky.owners)),
+    };
+    station_thread_idx_t *prev_owners = calloc(BENCH_STICKY_NUM_TASKS, sizeof(*prev_owners));
+
+    if ((sticky.blocks != NULL) && (sticky.owners != NULL) && (prev_owners != NULL))
+    {
+        const struct {
+            station_concurrent_processing_schedule_t schedule;
+            station_tasks_number_t batch_size;
+            const char *name;
+        } modes[] = {
+            {STATION_CONCURRENT_PROCESSING_SCHEDULE_STATIC, 0, "static:       "},
+            {STATION_CONCURRENT_PROCESSING_SCHEDULE_DYNAMIC, 1, "dynamic (1):  "},
+            {STATION_CONCURRENT_PROCESSING_SCHEDULE_DYNAMIC, BENCH_BATCH_SIZE, "dynamic (16): "},
+            {STATION_CONCURRENT_PROCESSING_SCHEDULE_WORK_STEALING, 1, "work-stealing:"},
+            {STATION_CONCURRENT_PROCESSING_SCHEDULE_GUIDED, 0, "guided:       "},
+        };
+
+        for (size_t i = 0; i < sizeof(modes) / sizeof(*modes); i++)
+        {
+            context->schedule = modes[i].schedule;
+
+            double migrated;
+            double time = benchmark_sticky(context, modes[i].batch_size, &sticky, prev_owners, &migrated);
+
+            printf("  %s %.3f ms (tasks migrated between threads %.1f%%)\n",
+                    modes[i].name, time, migrated * 100);
+        }
+
+        context->schedule = STATION_CONCURRENT_PROCESSING_SCHEDULE_DYNAMIC;
+    }
+    else
+        printf("  couldn't allocate arrays\n");
+
+    free(sticky.blocks);
+    free(sticky.owners);
+    free(prev_owners);
+}
+
+// Perform phases as separate blocking executes
+static void call_phases_separately(station_concurrent_processing_context_t *context, void *data)
+{
+    station_concurrent_processing_execute_range(context, PHASES_NUM_TASKS, 0,
+            pfunc_phase_fill, data, NULL, NULL, context->busy_wait); // blocking call
+    station_concurrent_processing_execute(context, PHASES_NUM_TASKS, BATCH_SIZE,
+            pfunc_phase_double, data, NULL, NULL, context->busy_wait); // blocking call
+    station_concurrent_processing_execute_range(context, PHASES_NUM_TASKS, 0,
+            pfunc_phase_sum, data, NULL, NULL, context->busy_wait); // blocking call
+}
+
+// Perform phases as one blocking multi-phase execute
+static void call_phases(station_concurrent_processing_context_t *context, void *data)
+{
+    struct benchmark_phases_data *args = data;
+
+    station_concurrent_processing_execute_phases(context, args->phases, args->num_phases,
+            NULL, NULL, context->busy_wait); // blocking call
+}
+
+// Compare a frame of phases executed one by one with the same phases executed as one job
+static void benchmark_phases(station_concurrent_processing_context_t *context)
+{
+    static struct phases_data phases_data;
+
+    const station_concurrent_processing_phase_t phases[] = {
+        {.pfunc_range = pfunc_phase_fill, .pfunc_data = &phases_data, .num_tasks = PHASES_NUM_TASKS},
+        {.pfunc = pfunc_phase_double, .pfunc_data = &phases_data,
+            .num_tasks = PHASES_NUM_TASKS, .batch_size = BATCH_SIZE},
+        {.pfunc_range = pfunc_phase_sum, .pfunc_data = &phases_data, .num_tasks = PHASES_NUM_TASKS},
+    };
+
+    printf("  separate executes: %.3f ms\n", benchmark_time(context, call_phases_separately,
+                &phases_data, BENCH_PHASES_NUM_FRAMES));
+
+    printf("  multi-phase:       %.3f ms\n", benchmark_time(context, call_phases,
+                &(struct benchmark_phases_data){.phases = phases,
+                .num_phases = sizeof(phases) / sizeof(*phases)}, BENCH_PHASES_NUM_FRAMES));
+}
+
+// Compare parallel algorithms with the same algorithms in a context without threads
+static void benchmark_algorithms(station_concurrent_processing_context_t *context)
+{
+    station_concurrent_processing_context_t sequential;
+
+    if (station_concurrent_processing_initialize_context(&sequential, 0, false) != 0)
+    {
+        printf("  couldn't create context\n");
+        return;
+    }
+
+    struct algorithms_data data = {
+        .keys = malloc(sizeof(*data.keys) * BENCH_ALGORITHMS_NUM_ELEMENTS),
+        .payloads = malloc(sizeof(*data.payloads) * BENCH_ALGORITHMS_NUM_ELEMENTS),
+        .original = malloc(sizeof(*data.original) * BENCH_ALGORITHMS_NUM_ELEMENTS),
+        .selected = malloc(sizeof(*data.selected) * BENCH_ALGORITHMS_NUM_ELEMENTS),
+    };
+
+    if ((data.keys != NULL) && (data.payloads != NULL) &&
+            (data.original != NULL) && (data.selected != NULL))
+    {
+        // Pseudo-random keys
+        uint32_t key = 1;
+        for (size_t i = 0; i < BENCH_ALGORITHMS_NUM_ELEMENTS; i++)
+        {
+            key ^= key << 13;
+            key ^= key >> 17;
+            key ^= key << 5;
+
+            data.original[i] = key;
+        }
+
+        const char *names[] = {
+            "memcpy:      ",
+            "memset:      ",
+            "scan:        ",
+            "radix sort:  ",
+            "histogram:   ",
+            "compaction:  ",
+        };
+
+        for (unsigned i = 0; i < sizeof(names) / sizeof(*names); i++)
+        {
+            double parallel_time = benchmark_algorithm(context, i, &data, BENCH_ALGORITHMS_NUM_ELEMENTS);
+            double sequential_time = benchmark_algorithm(&sequential, i, &data, BENCH_ALGORITHMS_NUM_ELEMENTS);
+
+            printf("  %s %.3f ms (sequential %.3f ms)\n", names[i], parallel_time, sequential_time);
+        }
+    }
+    else
+        printf("  couldn't allocate arrays\n");
+
+    free(data.keys);
+    free(data.payloads);
+    free(data.original);
+    free(data.selected);
+
+    station_concurrent_processing_destroy_context(&sequential);
+}
+
+// Create pipeline of source, transform and sink stages
+static struct station_concurrent_processing_pipeline* create_pipeline(struct pipeline_data *data)
+{
+    const station_concurrent_processing_pipeline_stage_t stages[] = {
+        {.pfunc = pfunc_stage_source, .pfunc_data = data, .num_threads = 1,
+            .output_size = sizeof(station_task_idx_t),
+            .output_alignment_log2 = 2, .output_capacity_log2 = PIPELINE_QUEUE_CAPACITY_LOG2},
+        {.pfunc = pfunc_stage_transform, .pfunc_data = data, .num_threads = PIPELINE_NUM_TRANSFORM_THREADS,
+            .output_size = sizeof(uint64_t) * 2,
+            .output_alignment_log2 = 3, .output_capacity_log2 = PIPELINE_QUEUE_CAPACITY_LOG2},
+        {.pfunc = pfunc_stage_sink, .pfunc_data = data, .num_threads = 1},
+    };
+
+    return station_concurrent_processing_create_pipeline(stages, sizeof(stages) / sizeof(*stages));
+}
+
+// Perform a blocking pipeline run
+static void call_pipeline(station_concurrent_processing_context_t *context, void *data)
+{
+    struct benchmark_pipeline_data *args = data;
+
+    args->data->next_item = 0;
+
+    station_concurrent_processing_run_pipeline(context, args->pipeline,
+            NULL, NULL, context->busy_wait); // blocking call
+}
+
+// Measure average time of a blocking pipeline run in milliseconds
+static double benchmark_pipeline_run(station_concurrent_processing_context_t *context,
+        struct station_concurrent_processing_pipeline *pipeline, struct pipeline_data *data)
+{
+    return benchmark_time(context, call_pipeline, &(struct benchmark_pipeline_data){
+            .pipeline = pipeline, .data = data}, BENCH_PIPELINE_NUM_ITERATIONS);
+}
+
+// Compare pipeline with the same pipeline in a context without threads, show statistics of stages
+static void benchmark_pipeline(station_concurrent_processing_context_t *context)
+{
+    station_concurrent_processing_context_t sequential;
+
+    if (station_concurrent_processing_initialize_context(&sequential, 0, false) != 0)
+    {
+        printf("  couldn't create context\n");
+        return;
+    }
+
+    struct pipeline_data data = {
+        .num_items = BENCH_PIPELINE_NUM_ITEMS,
+        .transform_cost = BENCH_PIPELINE_TRANSFORM_COST,
+    };
+
+    struct station_concurrent_processing_pipeline *pipeline = create_pipeline(&data);
+
+    if (pipeline != NULL)
+    {
+        double sequential_time = benchmark_pipeline_run(&sequential, pipeline, &data);
+        double parallel_time = benchmark_pipeline_run(context, pipeline, &data);
+
+        printf("  pipeline:      %.3f ms (sequential %.3f ms)\n", parallel_time, sequential_time);
+
+        // Statistics are available if concurrent processing is supported
+        const char *names[] = {"source:   ", "transform:", "sink:     "};
+
+        for (size_t i = 0; i < sizeof(names) / sizeof(*names); i++)
+        {
+            station_concurrent_processing_pipeline_stats_t stats;
+            if (!station_concurrent_processing_get_pipeline_stats(pipeline, i, &stats))
+                break;
+
+            printf("  %s    %.0f items/s, busy %.3f ms, starved %lu, blocked %lu",
+                    names[i], stats.throughput, stats.busy_ns * 1e-6,
+                    (unsigned long)stats.num_starved, (unsigned long)stats.num_blocked);
+
+            if (i < sizeof(names) / sizeof(*names) - 1)
+                printf(", queue occupancy %.2f (max %lu)", stats.mean_occupancy,
+                        (unsigned long)stats.max_occupancy);
+
+            printf("\n");
+        }
+
+        station_concurrent_processing_destroy_pipeline(pipeline);
+    }
+    else
+        printf("  couldn't create pipeline\n");
+
+    station_concurrent_processing_destroy_context(&sequential);
+}
+
+// Measure average latency of a blocking execute of tiny jobs separated by pauses,
+// and average CPU time consumed per iteration (both in milliseconds)
+static void benchmark_waiting(station_threads_number_t num_threads,
+        bool busy_wait, uint32_t spin_count, station_task_idx_t *array, const char *name)
+{
+    station_concurrent_processing_context_t context;
+
+    if (station_concurrent_processing_initialize_context_with_options(&context, num_threads,
+                &(station_concurrent_processing_context_options_t){
+                    .busy_wait = busy_wait, .spin_count = spin_count}) != 0)
+    {
+        printf("  %s: couldn't create context\n", name);
+        return;
+    }
+
+    double latency = 0;
+    clock_t cpu_start = clock();
+
+    for (unsigned i = 0; i < BENCH_WAIT_NUM_ITERATIONS; i++)
+    {
+        // Let threads fall asleep (or keep spinning)
+        thrd_sleep(&(struct timespec){.tv_nsec = BENCH_WAIT_GAP_NS}, NULL);
+
+        latency += benchmark_time(&context, call_execute, &(struct benchmark_execute_data){
+                .num_tasks = num_threads, .batch_size = 1, .pfunc = pfunc_bench, .pfunc_data = array}, 1);
+    }
+
+    clock_t cpu_end = clock();
+
+    station_concurrent_processing_destroy_context(&context);
+
+    printf("  %s: latency %.3f ms, CPU time %.3f ms\n", name,
+            latency / BENCH_WAIT_NUM_ITERATIONS,
+            (cpu_end - cpu_start) * 1e3 / CLOCKS_PER_SEC / BENCH_WAIT_NUM_ITERATIONS);
+}
+
+// Perform a blocking persistent execute of sweeps separated by barriers
+static void call_persistent_barriers(station_concurrent_processing_context_t *context, void *data)
+{
+    station_concurrent_processing_execute_persistent(context, pfunc_persistent_barriers,
+            data, NULL, NULL, context->busy_wait); // blocking call
+}
+
+// Measure average time of a barrier in a persistent execute and of a blocking execute
+// of a task per thread, as the alternative way to synchronize threads (both in microseconds)
+static void benchmark_barrier(station_threads_number_t num_threads,
+        bool busy_wait, uint32_t spin_count, station_task_idx_t *array, const char *name)
+{
+    station_concurrent_processing_context_t context;
+
+    if (station_concurrent_processing_initialize_context_with_options(&context, num_threads,
+                &(station_concurrent_processing_context_options_t){
+                    .busy_wait = busy_wait, .spin_count = spin_count}) != 0)
+    {
+        printf("  %3u threads, %s: couldn't create context\n", (unsigned)num_threads, name);
+        return;
+    }
+
+    struct barrier_data barrier_data = {.context = &context, .num_sweeps = BENCH_BARRIER_NUM_SWEEPS};
+
+    double barrier_time = benchmark_time(&context, call_persistent_barriers,
+            &barrier_data, 1) * 1e3 / BENCH_BARRIER_NUM_SWEEPS;
+
+    double execute_time = benchmark_time(&context, call_execute, &(struct benchmark_execute_data){
+            .num_tasks = num_threads, .batch_size = 1, .pfunc = pfunc_bench, .pfunc_data = array},
+            BENCH_BARRIER_NUM_SWEEPS) * 1e3;
+
+    station_concurrent_processing_destroy_context(&context);
+
+    printf("  %3u threads, %s: barrier %.3f us, execute %.3f us\n",
+            (unsigned)num_threads, name, barrier_time, execute_time);
+}
+
+// Stress-test of non-blocking executes
+static void stress_test_execute(struct plugin_resources *resources)
+{
+    station_concurrent_processing_context_t *context = resources->concurrent_processing_context;
+    atomic_bool flag = false;
+
+    printf("Performing stress-test of concurrent processing...\n");
+
+    for (unsigned i = 0; i < NUM_ITERATIONS; i++)
+    {
+        stress_test_iteration(context, i);
+
+        // Increment the counter to check if all task indices were processed
+        station_concurrent_processing_execute(context,
+                NUM_TASKS, BATCH_SIZE, pfunc_inc, resources,
+                pfunc_cb_flag, &flag, false); // non-blocking call
+                /* NULL, &flag, false); // blocking call */
+
+        stress_test_wait(pfunc_cb_flag, &flag);
+
+        // Sum of [0; N-1] is N*(N-1)/2
+        stress_test_check(resources->counter * 2 == (NUM_TASKS * (NUM_TASKS - 1)),
+                "counter has incorrect value");
+
+        // Decrement the counter back to zero to become twice as sure
+        station_concurrent_processing_execute(context,
+                NUM_TASKS, BATCH_SIZE, pfunc_dec, resources,
+                pfunc_cb_flag, &flag, false); // non-blocking call
+                /* NULL, &flag, false); // blocking call */
+
+        stress_test_wait(pfunc_cb_flag, &flag);
+
+        // Counter must be equal to zero again
+        stress_test_check(resources->counter == 0, "counter is not 0");
+    }
+}
+
+// Stress-test of submitted jobs
+static void stress_test_submit(struct plugin_resources *resources)
+{
+    station_concurrent_processing_context_t *context = resources->concurrent_processing_context;
+
+    printf("Performing stress-test of submitted jobs...\n");
+
+    for (unsigned i = 0; i < NUM_ITERATIONS; i++)
+    {
+        stress_test_iteration(context, i);
+
+        // Submit both jobs at once, they are processed one after another
+        station_concurrent_processing_job_t job_inc = station_concurrent_processing_submit(context,
+                NUM_TASKS, BATCH_SIZE, pfunc_inc, resources, NULL, NULL);
+        station_concurrent_processing_job_t job_dec = station_concurrent_processing_submit(context,
+                NUM_TASKS, BATCH_SIZE, pfunc_dec, resources, NULL, NULL);
+
+        // Jobs are completed in order, so waiting for the last one is enough
+        station_concurrent_processing_wait(context, job_dec, false);
+
+        stress_test_check(station_concurrent_processing_poll(context, job_inc), "job is not completed");
+
+        // Jobs which are not cancelled process all tasks
+        station_tasks_number_t num_processed = 0;
+        stress_test_check(station_concurrent_processing_num_processed_tasks(context, job_inc, &num_processed) &&
+                (num_processed == NUM_TASKS), "job processed %u tasks", (unsigned)num_processed);
+
+        // Counter must be equal to zero again
+        stress_test_check(resources->counter == 0, "counter is not 0");
+    }
+}
+
+// Stress-test of completion notification
+static void stress_test_notification(struct plugin_resources *resources)
+{
+    station_concurrent_processing_context_t *context = resources->concurrent_processing_context;
+
+    printf("Performing stress-test of completion notification...\n");
+
+    int fd = station_concurrent_processing_create_notification();
+
+    if (fd < 0)
+    {
+        printf("  notifications are not supported\n");
+        return;
+    }
+
+    context->notification_fd = fd;
+
+    for (unsigned i = 0; i < NUM_ITERATIONS; i++)
+    {
+        stress_test_iteration(context, i);
+
+        station_concurrent_processing_submit(context,
+                NUM_TASKS, BATCH_SIZE, pfunc_inc, resources, NULL, NULL);
+        station_concurrent_processing_submit(context,
+                NUM_TASKS, BATCH_SIZE, pfunc_dec, resources, NULL, NULL);
+
+        // Sleep until both jobs are completed, as an event loop would do
+        uint64_t num_notified = 0;
+        while (num_notified < 2)
+        {
+            struct pollfd pfd = {.fd = fd, .events = POLLIN};
+            poll(&pfd, 1, -1);
+
+            num_notified += station_concurrent_processing_read_notification(fd);
+        }
+
+        stress_test_check((num_notified == 2) && (resources->counter == 0),
+                "counter is not 0 after %u notifications", (unsigned)num_notified);
+    }
+
+    // Blocking executes are not notified
+    station_concurrent_processing_execute(context,
+            NUM_TASKS, BATCH_SIZE, pfunc_inc, resources, NULL, NULL, false);
+    station_concurrent_processing_execute(context,
+            NUM_TASKS, BATCH_SIZE, pfunc_dec, resources, NULL, NULL, false);
+
+    stress_test_check(station_concurrent_processing_read_notification(fd) == 0,
+            "blocking execute is notified");
+
+    context->notification_fd = -1;
+    station_concurrent_processing_destroy_notification(fd);
+}
+
+// Stress-test of contexts sharing threads
+static void stress_test_shared_threads(struct plugin_resources *resources)
+{
+    station_concurrent_processing_context_t *context = resources->concurrent_processing_context;
+
+    printf("Performing stress-test of shared threads...\n");
+
+    // Context using half of threads of the main one
+    station_concurrent_processing_context_t shared_context;
+
+    stress_test_check(station_concurrent_processing_initialize_shared_context(&shared_context, context,
+                (context->num_threads > 1) ? context->num_threads / 2 : 1) == 0,
+            "couldn't create context with shared threads");
+
+    atomic_uint max_thread_idx = 0;
+
+    for (unsigned i = 0; i < NUM_ITERATIONS; i++)
+    {
+        stress_test_iteration(&shared_context, i);
+
+        // Jobs of both contexts are processed by the same threads in order of submission
+        station_concurrent_processing_submit(&shared_context,
+                NUM_TASKS, BATCH_SIZE, pfunc_inc, resources, NULL, NULL);
+        station_concurrent_processing_submit(context,
+                NUM_TASKS, BATCH_SIZE, pfunc_dec, resources, NULL, NULL);
+        station_concurrent_processing_job_t job = station_concurrent_processing_submit(
+                &shared_context, NUM_TASKS, BATCH_SIZE, pfunc_max_thread_idx, &max_thread_idx,
+                NULL, NULL);
+
+        // Job handles are valid in all contexts sharing threads
+        station_concurrent_processing_wait(context, job, false);
+
+        stress_test_check(resources->counter == 0, "counter is not 0");
+    }
+
+    // Only the share of threads processes jobs of the context
+    stress_test_check(max_thread_idx < ((shared_context.num_threads > 0) ? shared_context.num_threads : 1),
+            "job of context with shared threads is processed by thread %u", (unsigned)max_thread_idx);
+
+    station_concurrent_processing_destroy_context(&shared_context);
+}
+
+// Stress-test of parking and waking threads between executes
+static void stress_test_num_threads(struct plugin_resources *resources)
+{
+    station_concurrent_processing_context_t *context = resources->concurrent_processing_context;
+
+    printf("Performing stress-test of changing number of threads...\n");
+
+    for (unsigned i = 0; i < NUM_ITERATIONS; i++)
+    {
+        station_concurrent_processing_set_num_threads(context, i % (context->max_num_threads + 1u));
+
+        stress_test_iteration(context, i);
+
+        station_concurrent_processing_execute(context,
+                NUM_TASKS, BATCH_SIZE, pfunc_inc, resources,
+                NULL, NULL, false); // blocking call
+
+        // Sum of [0; N-1] is N*(N-1)/2
+        stress_test_check(resources->counter * 2 == (NUM_TASKS * (NUM_TASKS - 1)),
+                "counter has incorrect value");
+
+        resources->counter = 0;
+    }
+
+    station_concurrent_processing_set_num_threads(context, context->max_num_threads);
+}
+
+// Stress-test of per-thread scratch arenas
+static void stress_test_arenas(struct plugin_resources *resources)
+{
+    station_concurrent_processing_context_t *context = resources->concurrent_processing_context;
+
+    printf("Performing stress-test of scratch arenas...\n");
+
+    stress_test_check(station_concurrent_processing_create_arenas(context, ARENA_SIZE, false),
+            "couldn't create scratch arenas");
+
+    for (unsigned i = 0; i < NUM_ITERATIONS; i++)
+    {
+        stress_test_iteration(context, i);
+
+        // Arenas are reset every execute, so they never run out
+        station_concurrent_processing_execute(context,
+                NUM_TASKS, BATCH_SIZE, pfunc_arena, resources,
+                NULL, NULL, false); // blocking call
+
+        // Sum of [0; N-1] is N*(N-1)/2
+        stress_test_check(resources->counter * 2 == (NUM_TASKS * (NUM_TASKS - 1)),
+                "counter has incorrect value");
+
+        resources->counter = 0;
+    }
+
+    size_t high_watermark = 0;
+    for (unsigned i = 0; i <= context->num_threads; i++)
+        if (high_watermark < station_concurrent_processing_arena_high_watermark(context, i))
+            high_watermark = station_concurrent_processing_arena_high_watermark(context, i);
+
+    printf("  largest arena usage: %zu of %zu bytes\n", high_watermark, context->arena_size);
+
+    station_concurrent_processing_create_arenas(context, 0, false);
+}
+
+// Stress-test of cancellation by jobs and by time budget
+static void stress_test_cancellation(struct plugin_resources *resources)
+{
+    station_concurrent_processing_context_t *context = resources->concurrent_processing_context;
+
+    printf("Performing stress-test of cancellation...\n");
+
+    for (unsigned i = 0; i < NUM_ITERATIONS; i++)
+    {
+        stress_test_iteration(context, i);
+
+        // Alternate cancellation from the job itself and tiny time budget
+        if (i % 2)
+            context->time_budget_ns = TIME_BUDGET_NS;
 
-#include <station/signal.typ.h>
+        station_concurrent_processing_job_t job = station_concurrent_processing_submit(context,
+                NUM_TASKS, 1, pfunc_search, resources, NULL, NULL);
 
-#include <station/concurrent.fun.h>
-#include <station/sdl.fun.h>
-#include <station/buffer.fun.h>
-#include <station/font.fun.h>
+        station_concurrent_processing_wait(context, job, false);
 
-#include <stdio.h>
-#include <stdlib.h>
-#include <stdatomic.h>
-#include <stdalign.h>
-#include <signal.h>
-#include <unistd.h> // for alarm()
+        context->time_budget_ns = 0;
 
+        // Reported number of tasks must match the number of tasks actually processed
+        station_tasks_number_t num_processed = 0;
+        stress_test_check(station_concurrent_processing_num_processed_tasks(context, job, &num_processed) &&
+                (num_processed == (station_tasks_number_t)resources->counter) && (num_processed <= NUM_TASKS),
+                "job processed %u tasks, counter is %i", (unsigned)num_processed, resources->counter);
 
-// Signal handler function
-static STATION_SIGNAL_HANDLER_FUNC(signal_handler) // implicit arguments: signo, siginfo, std_signals, rt_signals, data
+        resources->counter = 0;
+    }
+}
+
+// Stress-test of 64-bit task index space
+static void stress_test_range64(struct plugin_resources *resources)
 {
-    (void) siginfo;
-    (void) std_signals;
-    (void) rt_signals;
-    (void) data;
+    station_concurrent_processing_context_t *context = resources->concurrent_processing_context;
 
-    if ((signo >= SIGRTMIN) && (signo <= SIGRTMAX))
+    printf("Performing stress-test of 64-bit task index space...\n");
+
+    for (unsigned i = 0; i < NUM_ITERATIONS; i++)
     {
-        if (signo <= SIGRTMIN + (SIGRTMAX-SIGRTMIN)/2)
-            printf("Caught real-time signal SIGRTMIN%+i!\n", signo - SIGRTMIN);
-        else
-            printf("Caught real-time signal SIGRTMAX%+i!\n", signo - SIGRTMAX);
+        stress_test_iteration(context, i);
+
+        // Alternate automatic and explicit batch sizes
+        struct range64_data range64_data = {.mutex = &resources->counter_mutex};
+
+        station_concurrent_processing_execute_range64(context,
+                RANGE64_NUM_TASKS, (i % 4 < 2) ? 0 : RANGE64_BATCH_SIZE,
+                pfunc_range64_sum, &range64_data, NULL, NULL, false); // blocking call
+
+        // Sum of [0; N-1] is N*(N-1)/2, N is even
+        stress_test_check((range64_data.num_tasks == RANGE64_NUM_TASKS) &&
+                (range64_data.sum == (RANGE64_NUM_TASKS / 2) * (RANGE64_NUM_TASKS - 1)),
+                "tasks of 64-bit index space are processed incorrectly");
     }
+}
 
-    return true;
+// Stress-test of reduction
+static void stress_test_reduction(struct plugin_resources *resources)
+{
+    station_concurrent_processing_context_t *context = resources->concurrent_processing_context;
+    atomic_bool flag = false;
+
+    printf("Performing stress-test of reduction...\n");
+
+    for (unsigned i = 0; i < NUM_ITERATIONS; i++)
+    {
+        stress_test_iteration(context, i);
+
+        // Sum task indices without a mutex, alternating blocking and non-blocking calls
+        long sum = -1;
+
+        station_pfunc_callback_t callback = stress_test_callback(i);
+        station_concurrent_processing_reduce(context,
+                NUM_TASKS, BATCH_SIZE, pfunc_sum_accumulate, pfunc_sum_combine, NULL,
+                sizeof(sum), NULL, &sum, callback, &flag, false);
+
+        stress_test_wait(callback, &flag);
+
+        // Sum of [0; N-1] is N*(N-1)/2
+        stress_test_check(sum * 2 == (NUM_TASKS * (NUM_TASKS - 1)), "sum has incorrect value");
+    }
 }
 
-// Concurrent processing callback function
-static STATION_PFUNC_CALLBACK(pfunc_cb_flag) // implicit arguments: data, thread_idx
+// Stress-test of static partitioning
+static void stress_test_static_partitioning(struct plugin_resources *resources)
 {
-    (void) thread_idx;
+    station_concurrent_processing_context_t *context = resources->concurrent_processing_context;
 
-    atomic_bool *flag = data;
-    *flag = true;
+    printf("Performing stress-test of static partitioning...\n");
+
+    struct sticky_data sticky = {
+        .blocks = calloc((size_t)NUM_TASKS * BENCH_STICKY_BLOCK_SIZE, sizeof(*sticky.blocks)),
+        .owners = calloc(NUM_TASKS, sizeof(*sticky.owners)),
+    };
+
+    stress_test_check((sticky.blocks != NULL) && (sticky.owners != NULL), "couldn't allocate arrays");
+
+    for (unsigned i = 0; i < NUM_ITERATIONS / 16; i++)
+    {
+        stress_test_iteration(context, i);
+        context->schedule = STATION_CONCURRENT_PROCESSING_SCHEDULE_STATIC;
+
+        station_concurrent_processing_execute(context,
+                NUM_TASKS, BATCH_SIZE, pfunc_sticky, &sticky, NULL, NULL, false);
+
+        // Every task is processed by the thread which static range contains it
+        station_threads_number_t num_threads = context->num_threads;
+        if (num_threads == 0)
+            num_threads = 1;
+        else if (context->caller_participation)
+            num_threads++;
+
+        for (station_task_idx_t task_idx = 0; task_idx < NUM_TASKS; task_idx++)
+        {
+            station_task_idx_t begin, end;
+
+            stress_test_check(station_concurrent_processing_static_range(NUM_TASKS, num_threads,
+                        sticky.owners[task_idx], &begin, &end) && (task_idx >= begin) && (task_idx < end),
+                    "task %u is processed by thread %u outside of its range",
+                    (unsigned)task_idx, (unsigned)sticky.owners[task_idx]);
+        }
+    }
+
+    free(sticky.blocks);
+    free(sticky.owners);
 }
 
-// Concurrent processing function
-static STATION_PFUNC(pfunc_inc) // implicit arguments: data, task_idx, thread_idx
+// Stress-test of executes and submits from concurrent processing functions
+static void stress_test_nested(struct plugin_resources *resources)
 {
-    (void) thread_idx;
+    station_concurrent_processing_context_t *context = resources->concurrent_processing_context;
 
-    struct plugin_resources *resources = data;
+    printf("Performing stress-test of nested executes...\n");
 
-    // Increment the counter safely
-    mtx_lock(&resources->counter_mutex);
-    resources->counter += task_idx;
-    mtx_unlock(&resources->counter_mutex);
+    for (unsigned i = 0; i < NESTED_NUM_ITERATIONS; i++)
+    {
+        stress_test_iteration(context, i);
+
+        // Sum task indices by splitting the range in halves recursively
+        struct nested_data range = {.context = context,
+            .begin = 0, .end = NESTED_NUM_TASKS, .sums = {-1, -1}};
+
+        station_concurrent_processing_execute(context,
+                2, 1, pfunc_nested_split, &range, NULL, NULL, false);
+
+        // Sum of [0; N-1] is N*(N-1)/2
+        stress_test_check((range.sums[0] + range.sums[1]) * 2 == (long)NESTED_NUM_TASKS * (NESTED_NUM_TASKS - 1),
+                "nested sum has incorrect value");
+    }
+
+    context->caller_participation = false;
+
+    static struct nested_submit_data submit_data;
+    submit_data.context = context;
+
+    station_concurrent_processing_execute(context,
+            1, 1, pfunc_nested_submit, &submit_data, NULL, NULL, false);
+
+    // Busy-wait until submitted jobs are done
+    while (atomic_load(&submit_data.num_done) < submit_data.num_submitted);
+
+    stress_test_check(submit_data.num_submitted != 0,
+            "jobs couldn't be submitted from concurrent processing function");
 }
 
-// Concurrent processing function
-static STATION_PFUNC(pfunc_dec) // implicit arguments: data, task_idx, thread_idx
+// Stress-test of parallel algorithms
+static void stress_test_algorithms(struct plugin_resources *resources)
 {
-    (void) thread_idx;
+    station_concurrent_processing_context_t *context = resources->concurrent_processing_context;
 
-    struct plugin_resources *resources = data;
+    printf("Performing stress-test of parallel algorithms...\n");
 
-    // Decrement the counter safely
-    mtx_lock(&resources->counter_mutex);
-    resources->counter -= task_idx;
-    mtx_unlock(&resources->counter_mutex);
+    static struct algorithms_data data;
+    static uint32_t keys[ALGORITHMS_NUM_ELEMENTS], payloads[ALGORITHMS_NUM_ELEMENTS],
+           original[ALGORITHMS_NUM_ELEMENTS], selected[ALGORITHMS_NUM_ELEMENTS];
+
+    data.keys = keys;
+    data.payloads = payloads;
+    data.original = original;
+    data.selected = selected;
+
+    uint32_t key = 1;
+
+    for (unsigned i = 0; i < ALGORITHMS_NUM_ITERATIONS; i++)
+    {
+        stress_test_iteration(context, i);
+
+        // Pseudo-random keys, with few distinct values in odd iterations
+        for (size_t j = 0; j < ALGORITHMS_NUM_ELEMENTS; j++)
+        {
+            key ^= key << 13;
+            key ^= key >> 17;
+            key ^= key << 5;
+
+            original[j] = (i % 2) ? key & 0x0F0F : key;
+        }
+
+        // Copy and fill memory
+        station_concurrent_processing_memcpy(context, keys, original, sizeof(keys), false);
+        station_concurrent_processing_memset(context, payloads, 0xFF, sizeof(payloads), false);
+
+        stress_test_check((memcmp(keys, original, sizeof(keys)) == 0) && (payloads[0] == UINT32_MAX) &&
+                (payloads[ALGORITHMS_NUM_ELEMENTS - 1] == UINT32_MAX),
+                "memory is copied or filled incorrectly");
+
+        // Exclusive scan of ones in place gives indices
+        for (size_t j = 0; j < ALGORITHMS_NUM_ELEMENTS; j++)
+            payloads[j] = 1;
+
+        station_concurrent_processing_scan(context,
+                payloads, payloads, ALGORITHMS_NUM_ELEMENTS, sizeof(*payloads),
+                pfunc_add_combine, NULL, NULL, false, false);
+
+        for (size_t j = 0; j < ALGORITHMS_NUM_ELEMENTS; j++)
+            stress_test_check(payloads[j] == j, "scan is computed incorrectly");
+
+        // Histogram and compaction of unsorted keys
+        station_concurrent_processing_histogram(context,
+                ALGORITHMS_NUM_ELEMENTS, pfunc_key_bin, keys,
+                ALGORITHMS_NUM_BINS, data.histogram, false);
+
+        size_t num_selected = 0;
+        station_concurrent_processing_compact(context,
+                keys, selected, ALGORITHMS_NUM_ELEMENTS, sizeof(*keys),
+                pfunc_key_is_even, keys, &num_selected, false);
+
+        size_t num_even = 0;
+
+        for (size_t j = 0; j < ALGORITHMS_NUM_ELEMENTS; j++)
+        {
+            data.histogram[keys[j] % ALGORITHMS_NUM_BINS]--;
+
+            if (keys[j] % 2 == 0)
+            {
+                stress_test_check((num_even < num_selected) && (selected[num_even] == keys[j]),
+                        "stream compaction is done incorrectly");
+
+                num_even++;
+            }
+        }
+
+        stress_test_check(num_even == num_selected, "stream compaction is done incorrectly");
+
+        for (size_t j = 0; j < ALGORITHMS_NUM_BINS; j++)
+            stress_test_check(data.histogram[j] == 0, "histogram is computed incorrectly");
+
+        // Sort keys together with their original indices
+        station_concurrent_processing_radix_sort(context,
+                keys, sizeof(*keys), payloads, sizeof(*payloads), ALGORITHMS_NUM_ELEMENTS, false);
+
+        for (size_t j = 0; j < ALGORITHMS_NUM_ELEMENTS; j++)
+            stress_test_check((original[payloads[j]] == keys[j]) && ((j == 0) || ((keys[j - 1] < keys[j]) ||
+                            ((keys[j - 1] == keys[j]) && (payloads[j - 1] <= payloads[j])))),
+                    "keys are sorted incorrectly");
+    }
 }
 
-// Concurrent processing function
-static STATION_PFUNC(pfunc_queue) // implicit arguments: data, task_idx, thread_idx
+// Stress-test of tiled execution
+static void stress_test_tiled(struct plugin_resources *resources)
 {
-    (void) thread_idx;
+    station_concurrent_processing_context_t *context = resources->concurrent_processing_context;
 
-    struct plugin_resources *resources = data;
+    printf("Performing stress-test of tiled execution...\n");
 
-    while (!station_queue_push(resources->queue, &task_idx)); // wait until push
-    task_idx = 0;
-    while (!station_queue_pop(resources->queue, &task_idx)); // wait until pop
+    for (unsigned i = 0; i < NUM_ITERATIONS; i++)
+    {
+        stress_test_iteration(context, i);
 
-    // Increment the counter safely
-    mtx_lock(&resources->counter_mutex);
-    resources->counter += task_idx;
-    mtx_unlock(&resources->counter_mutex);
+        // Alternate tile orders, and 2D and 3D domains
+        static unsigned char marks[TILED_WIDTH * TILED_HEIGHT * TILED_DEPTH];
+        memset(marks, 0, sizeof(marks));
+
+        station_task_idx_t depth = (i % 6 < 3) ? TILED_DEPTH : 1;
+
+        station_concurrent_processing_domain_t domain = {
+            .origin = {.x = TILED_ORIGIN_X, .y = TILED_ORIGIN_Y, .z = TILED_ORIGIN_Z},
+            .extent = {.width = TILED_WIDTH, .height = TILED_HEIGHT, .depth = depth},
+            .tile = {.width = TILED_TILE_WIDTH, .height = TILED_TILE_HEIGHT, .depth = TILED_TILE_DEPTH},
+            .order = i % 3,
+        };
+
+        station_concurrent_processing_execute_tiled(context,
+                &domain, i % 4, pfunc_tile_mark, marks, NULL, NULL, false); // blocking call
+
+        // Every element of the domain must be visited exactly once
+        for (size_t j = 0; j < sizeof(marks); j++)
+            stress_test_check(marks[j] == (j < (size_t)TILED_WIDTH * TILED_HEIGHT * depth),
+                    "element of domain is visited %u times", (unsigned)marks[j]);
+    }
 }
 
-#ifdef STATION_IS_SDL_SUPPORTED
-// Concurrent processing function
-static STATION_PFUNC(pfunc_draw) // implicit arguments: data, task_idx, thread_idx
+// Stress-test of task graph
+static void stress_test_graph(struct plugin_resources *resources)
 {
-    (void) thread_idx;
+    station_concurrent_processing_context_t *context = resources->concurrent_processing_context;
+    atomic_bool flag = false;
+
+    printf("Performing stress-test of task graph...\n");
+
+    // simulate -> (double, increment) -> compose
+    static struct graph_data graph_data;
+
+    const size_t simulate_deps[] = {0};
+    const size_t compose_deps[] = {1, 2};
+
+    const station_concurrent_processing_graph_node_t nodes[] = {
+        {.pfunc_range = pfunc_graph_simulate, .pfunc_data = &graph_data,
+            .num_tasks = GRAPH_NUM_TASKS, .batch_size = BATCH_SIZE},
+        {.pfunc_range = pfunc_graph_double, .pfunc_data = &graph_data,
+            .num_tasks = GRAPH_NUM_TASKS, .batch_size = BATCH_SIZE,
+            .num_dependencies = 1, .dependencies = simulate_deps},
+        {.pfunc_range = pfunc_graph_increment, .pfunc_data = &graph_data,
+            .num_tasks = GRAPH_NUM_TASKS, .batch_size = BATCH_SIZE,
+            .num_dependencies = 1, .dependencies = simulate_deps},
+        {.pfunc_range = pfunc_graph_compose, .pfunc_data = &graph_data,
+            .num_tasks = GRAPH_NUM_TASKS, .batch_size = BATCH_SIZE,
+            .num_dependencies = 2, .dependencies = compose_deps},
+    };
+
+    struct station_concurrent_processing_graph *graph =
+        station_concurrent_processing_create_graph(nodes, sizeof(nodes) / sizeof(*nodes));
+    stress_test_check(graph != NULL, "couldn't create task graph");
+
+    for (unsigned i = 0; i < NUM_ITERATIONS; i++)
+    {
+        stress_test_iteration(context, i);
 
-    struct plugin_resources *resources = data;
+        graph_data.iteration = i;
+
+        // Alternate blocking and non-blocking calls
+        station_pfunc_callback_t callback = stress_test_callback(i);
+        station_concurrent_processing_run_graph(context, graph, callback, &flag, false);
 
-    // Compute texture coordinates of the current pixel
-    station_task_idx_t y = resources->sdl_window.texture.lock.rectangle.y +
-        task_idx / resources->sdl_window.texture.lock.rectangle.width;
-    station_task_idx_t x = resources->sdl_window.texture.lock.rectangle.x +
-        task_idx % resources->sdl_window.texture.lock.rectangle.width;
+        stress_test_wait(callback, &flag);
 
-    // Generate a simple animation
-    uint32_t pixel = ((x+y) + resources->frame) & 0xFF;
-    pixel = 0xFF000000 | (pixel << 16) | (pixel << 8) | pixel;
+        for (station_task_idx_t j = 0; j < GRAPH_NUM_TASKS; j++)
+            stress_test_check(graph_data.composed[j] == 3 * (j + i) + 1,
+                    "task graph result has incorrect value");
+    }
 
-    // Update the texture
-    resources->sdl_window.texture.lock.pixels[task_idx] = pixel;
+    station_concurrent_processing_destroy_graph(graph);
 }
-#endif
 
+// Stress-test of multi-phase executes
+static void stress_test_phases(struct plugin_resources *resources)
+{
+    station_concurrent_processing_context_t *context = resources->concurrent_processing_context;
+    atomic_bool flag = false;
+
+    printf("Performing stress-test of multi-phase executes...\n");
+
+    static struct phases_data phases_data;
+
+    // Empty phase must be skipped
+    const station_concurrent_processing_phase_t phases[] = {
+        {.pfunc_range = pfunc_phase_fill, .pfunc_data = &phases_data,
+            .num_tasks = PHASES_NUM_TASKS},
+        {.pfunc = pfunc_phase_double, .pfunc_data = &phases_data,
+            .num_tasks = PHASES_NUM_TASKS, .batch_size = 1},
+        {.pfunc_range = pfunc_phase_fill, .pfunc_data = &phases_data},
+        {.pfunc_range = pfunc_phase_sum, .pfunc_data = &phases_data,
+            .num_tasks = PHASES_NUM_TASKS, .batch_size = BATCH_SIZE},
+    };
+
+    for (unsigned i = 0; i < NUM_ITERATIONS; i++)
+    {
+        stress_test_iteration(context, i);
+
+        phases_data.iteration = i;
+
+        // Alternate blocking and non-blocking calls
+        station_pfunc_callback_t callback = stress_test_callback(i);
+        station_concurrent_processing_execute_phases(context,
+                phases, sizeof(phases) / sizeof(*phases), callback, &flag, false);
+
+        stress_test_wait(callback, &flag);
+
+        for (station_task_idx_t j = 0; j < PHASES_NUM_TASKS; j++)
+            stress_test_check(phases_data.summed[j] == 3 * (j + i),
+                    "multi-phase execute result has incorrect value");
+    }
+}
+
+// Stress-test of barriers in persistent executes
+static void stress_test_barriers(struct plugin_resources *resources)
+{
+    station_concurrent_processing_context_t *context = resources->concurrent_processing_context;
+    atomic_bool flag = false;
+
+    printf("Performing stress-test of barriers in persistent executes...\n");
+
+    static struct barrier_data barrier_data;
+    static station_task_idx_t expected[2][BARRIER_NUM_ELEMENTS];
+
+    barrier_data.context = context;
+    barrier_data.num_sweeps = BARRIER_NUM_SWEEPS;
+
+    // Compute expected result sequentially
+    for (station_task_idx_t j = 0; j < BARRIER_NUM_ELEMENTS; j++)
+        expected[0][j] = j;
+
+    for (unsigned sweep = 0; sweep < BARRIER_NUM_SWEEPS; sweep++)
+    {
+        const station_task_idx_t *src = expected[sweep % 2];
+        station_task_idx_t *dst = expected[(sweep + 1) % 2];
+
+        for (station_task_idx_t j = 0; j < BARRIER_NUM_ELEMENTS; j++)
+            dst[j] = ((j > 0) ? src[j - 1] : 0) + 2 * src[j] +
+                ((j < BARRIER_NUM_ELEMENTS - 1) ? src[j + 1] : 0);
+    }
+
+    for (unsigned i = 0; i < BARRIER_NUM_ITERATIONS; i++)
+    {
+        stress_test_iteration(context, i);
+
+        for (station_task_idx_t j = 0; j < BARRIER_NUM_ELEMENTS; j++)
+            barrier_data.elements[0][j] = j;
+
+        // Alternate blocking and non-blocking calls
+        station_pfunc_callback_t callback = stress_test_callback(i);
+        station_concurrent_processing_execute_persistent(context,
+                pfunc_persistent_smooth, &barrier_data, callback, &flag, false);
+
+        stress_test_wait(callback, &flag);
+
+        for (station_task_idx_t j = 0; j < BARRIER_NUM_ELEMENTS; j++)
+            stress_test_check(barrier_data.elements[BARRIER_NUM_SWEEPS % 2][j] ==
+                    expected[BARRIER_NUM_SWEEPS % 2][j], "persistent execute result has incorrect value");
+    }
+
+    // Persistent jobs of contexts sharing threads run simultaneously, each with own barriers
+    station_concurrent_processing_context_t shared_context;
+
+    stress_test_check(station_concurrent_processing_initialize_shared_context(&shared_context, context,
+                (context->num_threads > 1) ? context->num_threads / 2 : 1) == 0,
+            "couldn't create context with shared threads");
+
+    static struct barrier_data shared_barrier_data;
+    shared_barrier_data.context = &shared_context;
+    shared_barrier_data.num_sweeps = BARRIER_NUM_SWEEPS;
+
+    for (unsigned i = 0; i < BARRIER_NUM_ITERATIONS; i++)
+    {
+        for (station_task_idx_t j = 0; j < BARRIER_NUM_ELEMENTS; j++)
+            barrier_data.elements[0][j] = shared_barrier_data.elements[0][j] = j;
+
+        // Threads beyond the share skip the first job and proceed to the second one
+        atomic_bool shared_flag = false;
+
+        station_concurrent_processing_execute_persistent(&shared_context,
+                pfunc_persistent_smooth, &shared_barrier_data, pfunc_cb_flag, &shared_flag, false);
+        station_concurrent_processing_execute_persistent(context,
+                pfunc_persistent_smooth, &barrier_data, pfunc_cb_flag, &flag, false);
+
+        stress_test_wait(pfunc_cb_flag, &shared_flag);
+        stress_test_wait(pfunc_cb_flag, &flag);
+
+        for (station_task_idx_t j = 0; j < BARRIER_NUM_ELEMENTS; j++)
+            stress_test_check((barrier_data.elements[BARRIER_NUM_SWEEPS % 2][j] ==
+                        expected[BARRIER_NUM_SWEEPS % 2][j]) &&
+                    (shared_barrier_data.elements[BARRIER_NUM_SWEEPS % 2][j] ==
+                     expected[BARRIER_NUM_SWEEPS % 2][j]),
+                    "persistent execute of context with shared threads has incorrect value");
+    }
+
+    station_concurrent_processing_destroy_context(&shared_context);
+}
+
+// Stress-test of pipeline
+static void stress_test_pipeline(struct plugin_resources *resources)
+{
+    station_concurrent_processing_context_t *context = resources->concurrent_processing_context;
+    atomic_bool flag = false;
+
+    printf("Performing stress-test of pipeline...\n");
+
+    static struct pipeline_data pipeline_data = {.num_items = PIPELINE_NUM_ITEMS};
+
+    struct station_concurrent_processing_pipeline *pipeline = create_pipeline(&pipeline_data);
+    stress_test_check(pipeline != NULL, "couldn't create pipeline");
+
+    // Every third item is dropped, others are transformed to 2*i+1
+    station_task_idx_t expected_num_received = 0;
+    uint64_t expected_sum = 0;
+
+    for (station_task_idx_t j = 0; j < PIPELINE_NUM_ITEMS; j++)
+    {
+        if (j % 3 != 0)
+        {
+            expected_num_received++;
+            expected_sum += (uint64_t)j * 2 + 1;
+        }
+    }
+
+    for (unsigned i = 0; i < PIPELINE_NUM_ITERATIONS; i++)
+    {
+        stress_test_iteration(context, i);
+
+        pipeline_data.next_item = 0;
+        pipeline_data.num_received = 0;
+        pipeline_data.sum = 0;
+
+        // Alternate blocking and non-blocking calls
+        station_pfunc_callback_t callback = stress_test_callback(i);
+        station_concurrent_processing_run_pipeline(context, pipeline, callback, &flag, false);
+
+        stress_test_wait(callback, &flag);
+
+        stress_test_check((pipeline_data.num_received == expected_num_received) &&
+                (pipeline_data.sum == expected_sum), "pipeline result has incorrect value");
+    }
+
+    station_concurrent_processing_destroy_pipeline(pipeline);
+}
+
+// Stress-test of lock-free queue
+static void stress_test_queue(struct plugin_resources *resources)
+{
+    station_concurrent_processing_context_t *context = resources->concurrent_processing_context;
+
+    printf("Performing stress-test of lock-free queue...\n");
+
+    for (unsigned i = 0; i < NUM_ITERATIONS; i++)
+    {
+        stress_test_iteration(context, i);
+
+        // Increment the counter to check if all task indices were processed
+        station_concurrent_processing_execute(context,
+                NUM_TASKS, BATCH_SIZE, pfunc_queue, resources,
+                NULL, NULL, false); // blocking call
+
+        // Sum of [0; N-1] is N*(N-1)/2
+        stress_test_check(resources->counter * 2 == (NUM_TASKS * (NUM_TASKS - 1)),
+                "counter has incorrect value");
+
+        resources->counter = 0;
+    }
+}
 
 // State function for the finite state machine
 static STATION_SFUNC(sfunc_pre) // implicit arguments: state, fsm_data
@@ -122,84 +1848,226 @@ static STATION_SFUNC(sfunc_pre) // implicit arguments: state, fsm_data
 
     if (resources->concurrent_processing_context != NULL)
     {
-        atomic_bool flag = false;
-        bool result;
+        if (resources->concurrent_processing_context->thread_cpus != NULL)
+        {
+            // Display placement of threads on CPUs
+            printf("Threads are pinned to CPUs (NUMA nodes):");
+
+            for (station_threads_number_t i = 0; i < resources->concurrent_processing_context->num_threads; i++)
+                printf(" %i(%i)", (int)resources->concurrent_processing_context->thread_cpus[i],
+                        (int)resources->concurrent_processing_context->thread_nodes[i]);
+
+            printf("\n");
+        }
+
+        stress_test_execute(resources);
+        stress_test_submit(resources);
+        stress_test_notification(resources);
+        stress_test_shared_threads(resources);
+        stress_test_num_threads(resources);
+        stress_test_arenas(resources);
+        stress_test_cancellation(resources);
+        stress_test_range64(resources);
+        stress_test_reduction(resources);
+        stress_test_static_partitioning(resources);
+        stress_test_nested(resources);
+        stress_test_algorithms(resources);
+        stress_test_tiled(resources);
+        stress_test_graph(resources);
+        stress_test_phases(resources);
+        stress_test_barriers(resources);
+        stress_test_pipeline(resources);
+
+        if (resources->queue != NULL)
+            stress_test_queue(resources);
 
-        // Stress test of concurrent processing
-        printf("Performing stress-test of concurrent processing...\n");
+        resources->concurrent_processing_context->schedule =
+            STATION_CONCURRENT_PROCESSING_SCHEDULE_DYNAMIC;
+        resources->concurrent_processing_context->caller_participation = false;
 
-        for (unsigned i = 0; i < NUM_ITERATIONS; i++)
+        printf("Stress-test is complete!\n");
+
+        if (resources->bench_array != NULL)
         {
-            // Increment the counter to check if all task indices were processed
-            do
+            // Compare scheduling overhead of different modes
+            printf("Benchmarking scheduling modes (%u threads, %u tasks, batch size %u)...\n",
+                    (unsigned)resources->concurrent_processing_context->num_threads,
+                    (unsigned)BENCH_NUM_TASKS, (unsigned)BENCH_BATCH_SIZE);
+
+            resources->concurrent_processing_context->schedule =
+                STATION_CONCURRENT_PROCESSING_SCHEDULE_DYNAMIC;
+            printf("  dynamic:       %.3f ms\n", benchmark_execute(
+                        resources->concurrent_processing_context,
+                        BENCH_NUM_TASKS, BENCH_BATCH_SIZE, pfunc_bench, resources->bench_array));
+
+            resources->concurrent_processing_context->schedule =
+                STATION_CONCURRENT_PROCESSING_SCHEDULE_WORK_STEALING;
+            printf("  work-stealing: %.3f ms\n", benchmark_execute(
+                        resources->concurrent_processing_context,
+                        BENCH_NUM_TASKS, BENCH_BATCH_SIZE, pfunc_bench, resources->bench_array));
+
+            resources->concurrent_processing_context->schedule =
+                STATION_CONCURRENT_PROCESSING_SCHEDULE_STATIC;
+            printf("  static:        %.3f ms\n", benchmark_execute(
+                        resources->concurrent_processing_context,
+                        BENCH_NUM_TASKS, BENCH_BATCH_SIZE, pfunc_bench, resources->bench_array));
+
+            resources->concurrent_processing_context->schedule =
+                STATION_CONCURRENT_PROCESSING_SCHEDULE_DYNAMIC;
+
+            printf("  range pfunc:   %.3f ms\n", benchmark_execute_range(
+                        resources->concurrent_processing_context,
+                        BENCH_NUM_TASKS, BENCH_BATCH_SIZE, pfunc_bench_range, resources->bench_array));
+
+            printf("  range64 pfunc: %.3f ms\n", benchmark_execute_range64(
+                        resources->concurrent_processing_context,
+                        BENCH_NUM_TASKS, BENCH_BATCH_SIZE, pfunc_bench_range64, resources->bench_array));
+
+            resources->concurrent_processing_context->caller_participation = true;
+            printf("  participating: %.3f ms\n", benchmark_execute_range(
+                        resources->concurrent_processing_context,
+                        BENCH_NUM_TASKS, BENCH_BATCH_SIZE, pfunc_bench_range, resources->bench_array));
+
+            resources->concurrent_processing_context->caller_participation = false;
+
+            // Compare load balance of scheduling modes with automatic batch size
+            printf("Benchmarking scheduling modes on skewed workload (%u threads, %u tasks)...\n",
+                    (unsigned)resources->concurrent_processing_context->num_threads,
+                    (unsigned)BENCH_SKEWED_NUM_TASKS);
+
+            const struct {
+                station_concurrent_processing_schedule_t schedule;
+                station_tasks_number_t batch_size;
+                const char *name;
+            } skewed_modes[] = {
+                {STATION_CONCURRENT_PROCESSING_SCHEDULE_STATIC, 0, "static:       "},
+                {STATION_CONCURRENT_PROCESSING_SCHEDULE_DYNAMIC, 0, "dynamic:      "},
+                {STATION_CONCURRENT_PROCESSING_SCHEDULE_DYNAMIC, BENCH_BATCH_SIZE, "dynamic (16): "},
+                {STATION_CONCURRENT_PROCESSING_SCHEDULE_WORK_STEALING, 0, "work-stealing:"},
+                {STATION_CONCURRENT_PROCESSING_SCHEDULE_GUIDED, 0, "guided:       "},
+                {STATION_CONCURRENT_PROCESSING_SCHEDULE_ADAPTIVE, 0, "adaptive:     "},
+            };
+
+            for (size_t i = 0; i < sizeof(skewed_modes) / sizeof(*skewed_modes); i++)
             {
-                result = station_concurrent_processing_execute(resources->concurrent_processing_context,
-                        NUM_TASKS, BATCH_SIZE, pfunc_inc, resources,
-                        pfunc_cb_flag, &flag, false); // non-blocking call
-                        /* NULL, &flag, false); // blocking call */
-            }
-            while (!result);
+                resources->concurrent_processing_context->schedule = skewed_modes[i].schedule;
+                station_concurrent_processing_reset_stats(resources->concurrent_processing_context);
 
-            // Busy-wait until done
-            while (!flag);
-            flag = false;
+                printf("  %s %.3f ms", skewed_modes[i].name, benchmark_execute(
+                            resources->concurrent_processing_context,
+                            BENCH_SKEWED_NUM_TASKS, skewed_modes[i].batch_size,
+                            pfunc_bench_skewed, resources->bench_array));
 
-            // Sum of [0; N-1] is N*(N-1)/2
-            if (resources->counter * 2 != (NUM_TASKS * (NUM_TASKS - 1)))
-            {
-                printf("counter has incorrect value\n");
-                exit(1);
-            }
+                // Load imbalance is known if instrumentation is enabled
+                station_concurrent_processing_stats_t stats;
+                if (station_concurrent_processing_get_stats(resources->concurrent_processing_context, &stats))
+                    printf(" (load imbalance %.3f, tail %.3f ms)", stats.mean_imbalance,
+                            stats.num_jobs > 0 ? stats.tail_ns * 1e-6 / stats.num_jobs : 0.0);
 
-            // Decrement the counter back to zero to become twice as sure
-            do
-            {
-                result = station_concurrent_processing_execute(resources->concurrent_processing_context,
-                        NUM_TASKS, BATCH_SIZE, pfunc_dec, resources,
-                        pfunc_cb_flag, &flag, false); // non-blocking call
-                        /* NULL, &flag, false); // blocking call */
+                printf("\n");
             }
-            while (!result);
 
-            // Busy-wait until done
-            while (!flag);
-            flag = false;
+            resources->concurrent_processing_context->schedule =
+                STATION_CONCURRENT_PROCESSING_SCHEDULE_DYNAMIC;
 
-            // Counter must be equal to zero again
-            if (resources->counter != 0)
-            {
-                printf("counter is not 0\n");
-                exit(1);
-            }
+            // Compare how often threads get the same data in repeated executes
+            printf("Benchmarking cache reuse of repeated executes (%u threads, %u tasks of %u bytes)...\n",
+                    (unsigned)resources->concurrent_processing_context->num_threads,
+                    (unsigned)BENCH_STICKY_NUM_TASKS,
+                    (unsigned)(sizeof(float) * BENCH_STICKY_BLOCK_SIZE));
+
+            benchmark_sticky_modes(resources->concurrent_processing_context);
+
+            // Compare separate executes of phases with a single multi-phase execute
+            printf("Benchmarking multi-phase executes (%u threads, 3 phases of %u tasks)...\n",
+                    (unsigned)resources->concurrent_processing_context->num_threads,
+                    (unsigned)PHASES_NUM_TASKS);
+
+            benchmark_phases(resources->concurrent_processing_context);
+
+            // Compare summation with a mutex-protected counter and reduction
+            printf("Benchmarking reduction (%u threads, %u tasks, batch size %u)...\n",
+                    (unsigned)resources->concurrent_processing_context->num_threads,
+                    (unsigned)BENCH_REDUCE_NUM_TASKS, (unsigned)BENCH_BATCH_SIZE);
+
+            printf("  mutex:         %.3f ms\n", benchmark_execute(
+                        resources->concurrent_processing_context,
+                        BENCH_REDUCE_NUM_TASKS, BENCH_BATCH_SIZE, pfunc_inc, resources));
+            resources->counter = 0;
+
+            printf("  reduction:     %.3f ms\n", benchmark_reduce(
+                        resources->concurrent_processing_context,
+                        BENCH_REDUCE_NUM_TASKS, BENCH_BATCH_SIZE));
+
+            // Compare parallel algorithms with sequential ones
+            printf("Benchmarking parallel algorithms (%u threads, %u elements)...\n",
+                    (unsigned)resources->concurrent_processing_context->num_threads,
+                    (unsigned)BENCH_ALGORITHMS_NUM_ELEMENTS);
+
+            benchmark_algorithms(resources->concurrent_processing_context);
+
+            // Compare pipeline with sequential processing of items
+            printf("Benchmarking pipeline (%u threads, %u items)...\n",
+                    (unsigned)resources->concurrent_processing_context->num_threads,
+                    (unsigned)BENCH_PIPELINE_NUM_ITEMS);
+
+            benchmark_pipeline(resources->concurrent_processing_context);
         }
 
-        if (resources->queue != NULL)
+        if ((resources->bench_array != NULL) &&
+                (resources->concurrent_processing_context->num_threads > 0))
+        {
+            // Compare latency and CPU usage of waiting modes,
+            // busy-waiting is measured only if every thread has its own CPU
+            station_threads_number_t num_threads = resources->concurrent_processing_context->num_threads;
+            long num_cpus = sysconf(_SC_NPROCESSORS_ONLN);
+
+            printf("Benchmarking waiting modes (%u threads, %u ns between executes)...\n",
+                    (unsigned)num_threads, (unsigned)BENCH_WAIT_GAP_NS);
+
+            if (num_threads < num_cpus)
+                benchmark_waiting(num_threads, true, 0,
+                        resources->bench_array, "busy-wait         ");
+            benchmark_waiting(num_threads, false, 0,
+                    resources->bench_array, "condition variable");
+            benchmark_waiting(num_threads, false, BENCH_WAIT_SPIN_COUNT,
+                    resources->bench_array, "hybrid (fixed)    ");
+            benchmark_waiting(num_threads, false, STATION_CONCURRENT_PROCESSING_SPIN_ADAPTIVE,
+                    resources->bench_array, "hybrid (adaptive) ");
+        }
+
+        if (resources->bench_array != NULL)
         {
-            printf("Performing stress-test of lock-free queue...\n");
+            // Compare barriers with executes at different numbers of threads,
+            // busy-waiting is measured only if every thread has its own CPU
+            const station_threads_number_t nums_threads[] = {8, 32, 128};
+            long num_cpus = sysconf(_SC_NPROCESSORS_ONLN);
 
-            for (unsigned i = 0; i < NUM_ITERATIONS; i++)
+            printf("Benchmarking barriers (%u sweeps)...\n", (unsigned)BENCH_BARRIER_NUM_SWEEPS);
+
+            for (size_t i = 0; i < sizeof(nums_threads) / sizeof(*nums_threads); i++)
             {
-                // Increment the counter to check if all task indices were processed
-                do
-                {
-                    result = station_concurrent_processing_execute(resources->concurrent_processing_context,
-                            NUM_TASKS, BATCH_SIZE, pfunc_queue, resources,
-                            NULL, &flag, false); // blocking call
-                }
-                while (!result);
+                if (nums_threads[i] < num_cpus)
+                    benchmark_barrier(nums_threads[i], true, 0,
+                            resources->bench_array, "busy-wait         ");
+                benchmark_barrier(nums_threads[i], false, 0,
+                        resources->bench_array, "condition variable");
+                benchmark_barrier(nums_threads[i], false, STATION_CONCURRENT_PROCESSING_SPIN_ADAPTIVE,
+                        resources->bench_array, "hybrid (adaptive) ");
+            }
 
-                // Sum of [0; N-1] is N*(N-1)/2
-                if (resources->counter * 2 != (NUM_TASKS * (NUM_TASKS - 1)))
-                {
-                    printf("counter has incorrect value\n");
-                    exit(1);
-                }
+            // Contexts with many threads wake threads and complete jobs through trees
+            printf("Benchmarking dispatch latency (%u ns between executes)...\n", (unsigned)BENCH_WAIT_GAP_NS);
 
-                resources->counter = 0;
+            for (size_t i = 0; i < sizeof(nums_threads) / sizeof(*nums_threads); i++)
+            {
+                char name[32];
+                snprintf(name, sizeof(name), "%3u threads (%s)", (unsigned)nums_threads[i],
+                        (nums_threads[i] >= STATION_CONCURRENT_PROCESSING_TREE_MIN_THREADS) ? "tree" : "flat");
+
+                benchmark_waiting(nums_threads[i], false, 0, resources->bench_array, name);
             }
         }
-
-        printf("Stress-test is complete!\n");
     }
 
     state->sfunc = sfunc_loop;
@@ -312,14 +2180,33 @@ static STATION_SFUNC(sfunc_loop_sdl) // implicit arguments: state, fsm_data
                 exit(EXIT_FAILURE);
             }
 
-            // step 2: update texture pixels by calling pfunc_draw() from multiple threads
+            // step 2: update texture pixels by calling pfunc_draw() for tiles of pixels from multiple threads
             if (resources->concurrent_processing_context != NULL)
-                station_concurrent_processing_execute(resources->concurrent_processing_context,
-                        TEXTURE_WIDTH*TEXTURE_HEIGHT, BATCH_SIZE, pfunc_draw, resources,
+            {
+                station_concurrent_processing_domain_t domain;
+                station_sdl_window_texture_domain(&resources->sdl_window,
+                        TEXTURE_TILE_WIDTH, TEXTURE_TILE_HEIGHT,
+                        STATION_CONCURRENT_PROCESSING_TILE_ORDER_HILBERT, &domain);
+
+                station_concurrent_processing_execute_tiled(resources->concurrent_processing_context,
+                        &domain, 1, pfunc_draw, resources,
                         NULL, NULL, resources->concurrent_processing_context->busy_wait); // blocking call
+            }
             else
-                for (station_task_idx_t task_idx = 0; task_idx < TEXTURE_WIDTH*TEXTURE_HEIGHT; task_idx++)
-                    pfunc_draw(resources, task_idx, 0);
+            {
+                // The whole locked rectangle as a single tile
+                station_concurrent_processing_tile_t tile = {
+                    .x = {.begin = resources->sdl_window.texture.lock.rectangle.x,
+                        .end = resources->sdl_window.texture.lock.rectangle.x +
+                            resources->sdl_window.texture.lock.rectangle.width},
+                    .y = {.begin = resources->sdl_window.texture.lock.rectangle.y,
+                        .end = resources->sdl_window.texture.lock.rectangle.y +
+                            resources->sdl_window.texture.lock.rectangle.height},
+                    .z = {.begin = 0, .end = 1},
+                };
+
+                pfunc_draw(resources, &tile, 0);
+            }
 
             // step 3: if have font and text, draw floating text
             if ((resources->font != NULL) && (resources->text != NULL))
@@ -401,6 +2288,7 @@ static STATION_PLUGIN_HELP_FUNC(plugin_help) // implicit arguments: argc, argv
     printf("\nProvide a font as the first --file,\n");
     printf("  give a string as a first plugin argument,\n");
     printf("  and voila -- observe a floating text!\n");
+    printf("\nGive '--bench' as a plugin argument to run benchmarks after the stress-test.\n");
 }
 
 // Plugin configuration function
@@ -411,8 +2299,17 @@ static STATION_PLUGIN_CONF_FUNC(plugin_conf) // implicit arguments: args, argc,
         printf("  \"%s\",\n", argv[i]);
     printf(")\n");
 
-    if (argc >= 2)
-        args->cmdline = argv[1]; // first argument will be draw as a floating text
+    static struct plugin_cmdline cmdline;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--bench") == 0)
+            cmdline.benchmark = true;
+        else if (cmdline.text == NULL)
+            cmdline.text = argv[i]; // first other argument will be draw as a floating text
+    }
+
+    args->cmdline = &cmdline;
 
     // Catch the following signals
     args->signal_handler = signal_handler;
@@ -503,7 +2400,9 @@ static STATION_PLUGIN_INIT_FUNC(plugin_init) // implicit arguments: inputs, outp
     else
         resources->font = NULL;
 
-    resources->text = inputs->cmdline;
+    const struct plugin_cmdline *cmdline = inputs->cmdline;
+
+    resources->text = cmdline->text;
 
     // Initialize a counter for concurrent processing test
     resources->counter = 0;
@@ -513,6 +2412,14 @@ static STATION_PLUGIN_INIT_FUNC(plugin_init) // implicit arguments: inputs, outp
     resources->queue = station_create_queue(sizeof(station_task_idx_t),
             QUEUE_ALIGNMENT_LOG2, QUEUE_CAPACITY_LOG2);
 
+    // Allocate array for benchmarks if they are requested, placing its pages near threads that process them
+    if (cmdline->benchmark)
+        resources->bench_array = station_concurrent_processing_allocate_first_touch(
+                resources->concurrent_processing_context,
+                BENCH_NUM_TASKS, sizeof(*resources->bench_array));
+    else
+        resources->bench_array = NULL;
+
     // Other variables
     resources->alarm_set = false;
     resources->prev_frame = 0;
@@ -530,6 +2437,7 @@ static STATION_PLUGIN_FINAL_FUNC(plugin_final) // implicit arguments: plugin_res
     {
         mtx_destroy(&resources->counter_mutex);
         station_destroy_queue(resources->queue);
+        free(resources->bench_array);
 
         station_unload_font_psf2(resources->font);
         station_buffer_clear(&resources->font_buffer);
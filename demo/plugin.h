@@ -11,6 +11,7 @@
 
 #include <stdbool.h>
 #include <threads.h>
+#include <stdatomic.h>
 
 #ifdef STATION_IS_SDL_SUPPORTED
 #  include <SDL.h>
@@ -22,6 +23,86 @@
 #define BATCH_SIZE 16 // number of tasks each thread does at once
 #define NUM_ITERATIONS (1024)
 
+// Parameters for benchmarking of concurrent execution of pfunc_bench()
+#define BENCH_NUM_TASKS (1 << 20)
+#define BENCH_BATCH_SIZE 16
+#define BENCH_NUM_ITERATIONS 64
+
+// Parameters for benchmarking of scheduling modes on skewed workload
+#define BENCH_SKEWED_NUM_TASKS (1 << 14)
+#define BENCH_SKEWED_COST_DIVISOR 16 // task cost grows by one step every that many tasks
+
+// Parameters for benchmarking of cache reuse across repeated executes
+#define BENCH_STICKY_NUM_TASKS 1024
+#define BENCH_STICKY_BLOCK_SIZE 256 // number of floats updated by a task
+#define BENCH_STICKY_NUM_FRAMES 256
+
+// Parameters for benchmarking of reduction against mutex-protected counter
+#define BENCH_REDUCE_NUM_TASKS (1 << 16)
+
+// Parameters for stress-testing of nested executes
+#define NESTED_NUM_TASKS 4096
+#define NESTED_LEAF_SIZE 64 // ranges not larger than this are summed by reduction
+#define NESTED_NUM_ITERATIONS 64
+#define NESTED_NUM_SUBMITS 48 // more than STATION_CONCURRENT_PROCESSING_MAX_JOBS
+
+// Parameters for stress-testing and benchmarking of parallel algorithms
+#define ALGORITHMS_NUM_ELEMENTS 100003
+#define ALGORITHMS_NUM_ITERATIONS 16
+#define ALGORITHMS_NUM_BINS 256
+#define BENCH_ALGORITHMS_NUM_ELEMENTS (1 << 22)
+#define BENCH_ALGORITHMS_NUM_ITERATIONS 8
+
+// Parameters for stress-testing of tiled execution
+#define TILED_ORIGIN_X 3
+#define TILED_ORIGIN_Y 5
+#define TILED_ORIGIN_Z 7
+#define TILED_WIDTH 37
+#define TILED_HEIGHT 23
+#define TILED_DEPTH 5
+#define TILED_TILE_WIDTH 4
+#define TILED_TILE_HEIGHT 3
+#define TILED_TILE_DEPTH 2
+
+// Parameters for stress-testing of task graph
+#define GRAPH_NUM_TASKS 1024
+
+// Parameters for stress-testing and benchmarking of multi-phase executes
+#define PHASES_NUM_TASKS 1024
+#define BENCH_PHASES_NUM_FRAMES 256
+
+// Parameters for stress-testing and benchmarking of barriers in persistent executes
+#define BARRIER_NUM_ELEMENTS 1000
+#define BARRIER_NUM_SWEEPS 64
+#define BARRIER_NUM_ITERATIONS 64
+#define BENCH_BARRIER_NUM_SWEEPS 256
+
+// Parameters for stress-testing and benchmarking of pipeline
+#define PIPELINE_NUM_ITEMS 10007
+#define PIPELINE_NUM_ITERATIONS 64
+#define PIPELINE_NUM_TRANSFORM_THREADS 2
+#define PIPELINE_QUEUE_CAPACITY_LOG2 4
+#define BENCH_PIPELINE_NUM_ITEMS (1 << 16)
+#define BENCH_PIPELINE_NUM_ITERATIONS 8
+#define BENCH_PIPELINE_TRANSFORM_COST 256 // number of hashing rounds per item in transform stage
+
+// Parameters for stress-testing of 64-bit task index space
+#define RANGE64_NUM_TASKS ((station_tasks_number64_t)5 << 30) // more than 32-bit range
+#define RANGE64_BATCH_SIZE (1 << 26)
+
+// Parameters for stress-testing of scratch arenas
+#define ARENA_NUM_INTS 16 // number of integers allocated by a task
+#define ARENA_SIZE (NUM_TASKS * ARENA_NUM_INTS * sizeof(int)) // enough for all tasks in one thread
+
+// Parameters for stress-testing of cancellation
+#define SEARCH_TARGET (NUM_TASKS / 3) // task which cancels the job
+#define TIME_BUDGET_NS 1000 // time budget of executes in nanoseconds
+
+// Parameters for benchmarking of waiting modes
+#define BENCH_WAIT_NUM_ITERATIONS 256
+#define BENCH_WAIT_GAP_NS 100000 // pause between executes in nanoseconds
+#define BENCH_WAIT_SPIN_COUNT 10000 // spin count of hybrid waiting mode
+
 #define QUEUE_ALIGNMENT_LOG2 4 // log2 of lock-free queue element alignment
 #define QUEUE_CAPACITY_LOG2 2 // log2 of lock-free queue capacity
 
@@ -30,12 +111,124 @@
 #define TEXTURE_WIDTH 256
 #define TEXTURE_HEIGHT 144
 #define WINDOW_SCALE 4 // window pixels per texture pixel
+#define TEXTURE_TILE_WIDTH 16
+#define TEXTURE_TILE_HEIGHT 16
 
 
 struct station_signal_set;
 struct station_state;
 
 
+// Data for stress-testing of 64-bit task index space
+struct range64_data {
+    mtx_t *mutex;
+
+    station_tasks_number64_t num_tasks; // number of processed tasks
+    station_task_idx64_t sum; // sum of processed task indices modulo 2^64
+};
+
+// Data updated by repeated executes, with threads which processed tasks in the last one
+struct sticky_data {
+    float *blocks;
+    station_thread_idx_t *owners;
+};
+
+// Range of tasks summed by nested executes
+struct nested_data {
+    station_concurrent_processing_context_t *context;
+    station_task_idx_t begin, end;
+    long sums[2]; // sums of halves of the range
+};
+
+// Data of jobs submitted from a concurrent processing function
+struct nested_submit_data {
+    station_concurrent_processing_context_t *context;
+    unsigned num_submitted; // number of successfully submitted jobs
+    atomic_uint num_done; // number of processed jobs
+};
+
+// Data processed by parallel algorithms
+struct algorithms_data {
+    uint32_t *keys;
+    uint32_t *payloads;
+    uint32_t *original; // keys before sorting
+    uint32_t *selected; // result of stream compaction
+    size_t histogram[ALGORITHMS_NUM_BINS];
+};
+
+// Data processed by task graph
+struct graph_data {
+    unsigned iteration;
+
+    station_task_idx_t input[GRAPH_NUM_TASKS];
+    station_task_idx_t doubled[GRAPH_NUM_TASKS];
+    station_task_idx_t incremented[GRAPH_NUM_TASKS];
+    station_task_idx_t composed[GRAPH_NUM_TASKS];
+};
+
+// Data processed by multi-phase execute: fill -> reverse and double -> reverse and add
+struct phases_data {
+    unsigned iteration;
+
+    station_task_idx_t filled[PHASES_NUM_TASKS];
+    station_task_idx_t doubled[PHASES_NUM_TASKS];
+    station_task_idx_t summed[PHASES_NUM_TASKS];
+};
+
+// Data smoothed by sweeps of persistent execute separated by barriers
+struct barrier_data {
+    station_concurrent_processing_context_t *context;
+    unsigned num_sweeps;
+
+    station_task_idx_t elements[2][BARRIER_NUM_ELEMENTS]; // source and destination alternate every sweep
+};
+
+// Data processed by pipeline
+struct pipeline_data {
+    station_task_idx_t num_items; // number of items produced by the source stage
+    station_task_idx_t next_item;
+    unsigned transform_cost;
+
+    station_task_idx_t num_received; // number of items consumed by the sink stage
+    uint64_t sum; // sum of items consumed by the sink stage
+};
+
+// Arguments of a benchmarked execute
+struct benchmark_execute_data {
+    station_tasks_number_t num_tasks;
+    station_tasks_number_t batch_size;
+
+    station_pfunc_t pfunc; // one of the pfuncs is set
+    station_pfunc_range_t pfunc_range;
+    station_pfunc_range64_t pfunc_range64;
+    void *pfunc_data;
+};
+
+// Arguments of a benchmarked parallel algorithm
+struct benchmark_algorithm_data {
+    unsigned algorithm;
+    struct algorithms_data *data;
+    size_t num_elements;
+};
+
+// Arguments of a benchmarked multi-phase execute
+struct benchmark_phases_data {
+    const station_concurrent_processing_phase_t *phases;
+    size_t num_phases;
+};
+
+// Arguments of a benchmarked pipeline run
+struct benchmark_pipeline_data {
+    struct station_concurrent_processing_pipeline *pipeline;
+    struct pipeline_data *data;
+};
+
+// Parsed plugin arguments
+struct plugin_cmdline {
+    const char *text; // floating text
+    bool benchmark; // whether benchmarks are run after the stress-test
+};
+
 // Plugin's own resources
 struct plugin_resources {
     struct station_std_signal_set *std_signals; // standard signals flags
@@ -62,6 +255,9 @@ struct plugin_resources {
     // test lock-free queue
     struct station_queue *queue;
 
+    // array for benchmarks
+    station_task_idx_t *bench_array;
+
     // for FPS computation
     bool alarm_set;
     unsigned prev_frame, frame;
@@ -78,9 +274,38 @@ static STATION_PFUNC(pfunc_inc);
 static STATION_PFUNC(pfunc_dec);
 
 static STATION_PFUNC(pfunc_queue);
+static STATION_PFUNC(pfunc_max_thread_idx);
+static STATION_PFUNC(pfunc_sticky);
+
+static STATION_PFUNC_ACCUMULATE(pfunc_sum_accumulate);
+static STATION_PFUNC_COMBINE(pfunc_sum_combine);
+
+static STATION_PFUNC(pfunc_nested_split);
+static STATION_PFUNC_ACCUMULATE(pfunc_nested_accumulate);
+static STATION_PFUNC(pfunc_nested_submit);
+static STATION_PFUNC(pfunc_nested_count);
+
+static STATION_PFUNC_COMBINE(pfunc_add_combine);
+static STATION_PFUNC_BIN(pfunc_key_bin);
+static STATION_PFUNC_PREDICATE(pfunc_key_is_even);
+
+static STATION_PFUNC_TILE(pfunc_tile_mark);
+
+static STATION_PFUNC_RANGE(pfunc_graph_simulate);
+static STATION_PFUNC_RANGE(pfunc_graph_double);
+static STATION_PFUNC_RANGE(pfunc_graph_increment);
+static STATION_PFUNC_RANGE(pfunc_graph_compose);
+
+static STATION_PFUNC_STAGE(pfunc_stage_source);
+static STATION_PFUNC_STAGE(pfunc_stage_transform);
+static STATION_PFUNC_STAGE(pfunc_stage_sink);
+
+static STATION_PFUNC(pfunc_bench);
+static STATION_PFUNC(pfunc_bench_skewed);
+static STATION_PFUNC_RANGE(pfunc_bench_range);
 
 #ifdef STATION_IS_SDL_SUPPORTED
-static STATION_PFUNC(pfunc_draw);
+static STATION_PFUNC_TILE(pfunc_draw);
 #endif
 
 // State functions for the finite state machine
@@ -32,11 +32,148 @@
 #define STATION_PFUNC(name) \
     void name(void *data, station_task_idx_t task_idx, station_thread_idx_t thread_idx)
 
+/**
+ * @brief Declarator of a concurrent processing function for ranges of tasks.
+ */
+#define STATION_PFUNC_RANGE(name) \
+    void name(void *data, station_task_idx_t task_idx_begin, \
+            station_task_idx_t task_idx_end, station_thread_idx_t thread_idx)
+
+/**
+ * @brief Declarator of a concurrent processing function for ranges of tasks in 64-bit task index space.
+ */
+#define STATION_PFUNC_RANGE64(name) \
+    void name(void *data, station_task_idx64_t task_idx_begin, \
+            station_task_idx64_t task_idx_end, station_thread_idx_t thread_idx)
+
+/**
+ * @brief Declarator of a concurrent processing function for tiles of an iteration domain.
+ */
+#define STATION_PFUNC_TILE(name) \
+    void name(void *data, const station_concurrent_processing_tile_t *tile, \
+            station_thread_idx_t thread_idx)
+
 /**
  * @brief Declarator of a concurrent processing callback function.
  */
 #define STATION_PFUNC_CALLBACK(name) \
     void name(void *data, station_thread_idx_t thread_idx)
 
+/**
+ * @brief Declarator of a concurrent reduction accumulate function.
+ */
+#define STATION_PFUNC_ACCUMULATE(name) \
+    void name(void *data, void *partial, \
+            station_task_idx_t task_idx, station_thread_idx_t thread_idx)
+
+/**
+ * @brief Declarator of a concurrent reduction combine function.
+ */
+#define STATION_PFUNC_COMBINE(name) \
+    void name(void *data, void *partial, const void *other_partial)
+
+/**
+ * @brief Declarator of a histogram bin function.
+ */
+#define STATION_PFUNC_BIN(name) \
+    size_t name(void *data, size_t element_idx)
+
+/**
+ * @brief Declarator of a stream compaction predicate function.
+ */
+#define STATION_PFUNC_PREDICATE(name) \
+    bool name(void *data, size_t element_idx)
+
+/**
+ * @brief Declarator of a pipeline stage function.
+ */
+#define STATION_PFUNC_STAGE(name) \
+    bool name(void *data, const void *input, void *output, \
+            station_thread_idx_t thread_idx)
+
+/**
+ * @brief Declarator of a persistent concurrent processing function.
+ */
+#define STATION_PFUNC_PERSISTENT(name) \
+    void name(void *data, station_thread_idx_t thread_idx, \
+            station_threads_number_t num_threads)
+
+/**
+ * @brief Scheduling mode: threads acquire batches from a single shared counter.
+ */
+#define STATION_CONCURRENT_PROCESSING_SCHEDULE_DYNAMIC 0
+/**
+ * @brief Scheduling mode: threads process own contiguous ranges of tasks,
+ * and steal halves of other threads' remaining ranges when own ones run out.
+ */
+#define STATION_CONCURRENT_PROCESSING_SCHEDULE_WORK_STEALING 1
+/**
+ * @brief Scheduling mode: every thread processes the same contiguous range of tasks
+ * in all executes with the same number of tasks and participating threads.
+ */
+#define STATION_CONCURRENT_PROCESSING_SCHEDULE_STATIC 2
+/**
+ * @brief Scheduling mode: threads acquire chunks from a single shared counter,
+ * chunks shrink proportionally to the number of remaining tasks.
+ */
+#define STATION_CONCURRENT_PROCESSING_SCHEDULE_GUIDED 3
+/**
+ * @brief Scheduling mode: dynamic scheduling with batch size chosen
+ * from measured time of a task in previous executes of the same function.
+ */
+#define STATION_CONCURRENT_PROCESSING_SCHEDULE_ADAPTIVE 4
+
+/**
+ * @brief Thread placement policy: fill hardware threads of a core, then cores of a package,
+ * then packages one by one.
+ */
+#define STATION_CONCURRENT_PROCESSING_PLACEMENT_COMPACT 0
+/**
+ * @brief Thread placement policy: distribute threads between packages, then between cores,
+ * using other hardware threads of a core only when all cores are occupied.
+ */
+#define STATION_CONCURRENT_PROCESSING_PLACEMENT_SCATTER 1
+/**
+ * @brief Thread placement policy: one thread per physical core, skipping SMT siblings.
+ */
+#define STATION_CONCURRENT_PROCESSING_PLACEMENT_PHYSICAL 2
+
+/**
+ * @brief Tile order: tiles are enumerated row by row, layer by layer.
+ */
+#define STATION_CONCURRENT_PROCESSING_TILE_ORDER_ROW_MAJOR 0
+/**
+ * @brief Tile order: tiles are enumerated along Morton (Z-order) curve.
+ */
+#define STATION_CONCURRENT_PROCESSING_TILE_ORDER_MORTON 1
+/**
+ * @brief Tile order: tiles are enumerated along Hilbert curve.
+ */
+#define STATION_CONCURRENT_PROCESSING_TILE_ORDER_HILBERT 2
+
+/**
+ * @brief Spin count value enabling adaptive spin budget.
+ *
+ * Spin budget of a waiting thread grows when waiting ends while spinning,
+ * and shrinks when the thread has to block.
+ */
+#define STATION_CONCURRENT_PROCESSING_SPIN_ADAPTIVE 0xFFFFFFFF
+
+/**
+ * @brief Maximum number of submitted jobs in flight per concurrent processing context.
+ */
+#define STATION_CONCURRENT_PROCESSING_MAX_JOBS 32
+
+/**
+ * @brief Minimum number of threads of a context for tree-structured wake-up and completion of jobs.
+ *
+ * Threads of such contexts are woken through leaders of groups of neighbouring threads,
+ * and arrive at the end of a job through a combining tree of counters.
+ * The value can be overridden at compile time.
+ */
+#ifndef STATION_CONCURRENT_PROCESSING_TREE_MIN_THREADS
+#  define STATION_CONCURRENT_PROCESSING_TREE_MIN_THREADS 16
+#endif
+
 #endif // _STATION_CONCURRENT_DEF_H_
 
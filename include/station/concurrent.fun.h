@@ -35,9 +35,15 @@ struct station_queue;
  *
  * busy_wait parameter controls waiting behavior of slave threads.
  *
+ * Scheduling mode of the context is set to STATION_CONCURRENT_PROCESSING_SCHEDULE_DYNAMIC,
+ * caller participation is disabled.
+ *
+ * Equivalent to station_concurrent_processing_initialize_context_with_options()
+ * with options containing only busy_wait.
+ *
  * @return 0 if succeed, -1 if arguments are incorrect,
- * 1 if malloc() returned NULL, 2 if thrd_create() returned thrd_nomem,
- * 3 if thrd_create() returned thrd_error.
+ * 1 if malloc() returned NULL, 2 if thrd_create() or cnd_init() returned thrd_nomem,
+ * 3 if thrd_create(), mtx_init() or cnd_init() returned thrd_error.
  */
 int
 station_concurrent_processing_initialize_context(
@@ -46,20 +52,239 @@ station_concurrent_processing_initialize_context(
         bool busy_wait ///< [in] Whether busy-waiting is enabled.
 );
 
+/**
+ * @brief Initialize concurrent processing context with options and create threads.
+ *
+ * options->busy_wait controls waiting behavior of slave threads.
+ *
+ * If busy-waiting is disabled, options->spin_count is the number of times
+ * a waiting thread checks for a new job (or job completion) before
+ * blocking on a condition variable. Zero value disables spinning,
+ * STATION_CONCURRENT_PROCESSING_SPIN_ADAPTIVE enables adaptive spin budget.
+ * This also applies to blocking executes and waits without busy-waiting.
+ *
+ * If options->thread_cpus is not NULL, it contains num_threads CPU indices,
+ * and every thread is pinned to its CPU (negative index means not pinned).
+ * The map is copied and available as context->thread_cpus.
+ * NUMA nodes of the CPUs are available as context->thread_nodes.
+ *
+ * NULL options are equivalent to zero-initialized options.
+ *
+ * Scheduling mode of the context is set to STATION_CONCURRENT_PROCESSING_SCHEDULE_DYNAMIC,
+ * caller participation is disabled.
+ *
+ * @return 0 if succeed, -1 if arguments are incorrect,
+ * 1 if malloc() returned NULL, 2 if thrd_create() or cnd_init() returned thrd_nomem,
+ * 3 if thrd_create(), mtx_init() or cnd_init() returned thrd_error,
+ * 4 if thread affinity couldn't be set or isn't supported.
+ */
+int
+station_concurrent_processing_initialize_context_with_options(
+        station_concurrent_processing_context_t *context, ///< [out] Context to initialize.
+        station_threads_number_t num_threads, ///< [in] Number of concurrent processing threads to create.
+        const station_concurrent_processing_context_options_t *options ///< [in] Initialization options, or NULL.
+);
+
+/**
+ * @brief Initialize concurrent processing context using threads of another context.
+ *
+ * Contexts sharing threads are views onto a single pool of threads:
+ * jobs of all of them are placed into the same queue and processed in the order
+ * of submission, so threads idle in one context serve jobs of others
+ * instead of sleeping, and the system is not oversubscribed.
+ *
+ * Jobs of the new context are processed by threads with indices less than share
+ * (or less than the number of active threads of the pool, if that is smaller),
+ * which is available as context->num_threads. Share is larger than zero
+ * and is limited by context->max_num_threads, which is the number of threads of the pool.
+ * Calling thread never participates in jobs of a context with shared threads.
+ *
+ * Waiting behavior, thread placement, scratch arenas and instrumentation counters
+ * belong to the threads and are the same for all contexts sharing them.
+ * Job handles are valid in all such contexts.
+ *
+ * Threads are joined when the last context using them is destroyed,
+ * the contexts can be destroyed in any order.
+ *
+ * @return 0 if succeed, -1 if arguments are incorrect,
+ * -2 if concurrent processing is not supported.
+ */
+int
+station_concurrent_processing_initialize_shared_context(
+        station_concurrent_processing_context_t *context, ///< [out] Context to initialize.
+        const station_concurrent_processing_context_t *pool, ///< [in] Context which threads are shared.
+        station_threads_number_t share ///< [in] Maximum number of threads processing jobs of the context.
+);
+
 /**
  * @brief Destroy concurrent processing context and join threads.
+ *
+ * All submitted jobs are completed before threads terminate.
+ * If threads are shared with other contexts, they keep running until
+ * the last of the contexts is destroyed.
  */
 void
 station_concurrent_processing_destroy_context(
         station_concurrent_processing_context_t *context ///< [in] Context to destroy.
 );
 
+/**
+ * @brief Compute placement of threads on CPUs according to a policy.
+ *
+ * Only CPUs available to the process are used. CPU topology is read from sysfs.
+ * If there are more threads than suitable CPUs, placement wraps around.
+ *
+ * @return True if succeed, false if policy is incorrect,
+ * CPU topology couldn't be obtained or thread affinity isn't supported.
+ */
+bool
+station_concurrent_processing_place_threads(
+        station_concurrent_processing_placement_t policy, ///< [in] Thread placement policy.
+        station_threads_number_t num_threads, ///< [in] Number of threads.
+        station_cpu_idx_t *thread_cpus ///< [out] CPUs to pin threads to.
+);
+
+/**
+ * @brief Allocate zero-initialized memory for tasks, touching it first from threads of the context.
+ *
+ * Memory is divided between threads in the same way as static schedule does
+ * without caller participation, so that with first-touch page placement policy
+ * pages are allocated on NUMA nodes of threads that process the corresponding tasks.
+ * It is beneficial when threads are pinned to CPUs.
+ *
+ * Memory is aligned to page size and must be freed with free().
+ *
+ * @return Allocated memory, or NULL in case of error.
+ */
+void*
+station_concurrent_processing_allocate_first_touch(
+        station_concurrent_processing_context_t *context, ///< [in] Concurrent processing context or NULL.
+
+        station_tasks_number_t num_tasks, ///< [in] Number of tasks.
+        size_t task_size ///< [in] Size of memory per task in bytes.
+);
+
+/**
+ * @brief Compute range of tasks processed by a thread in static mode.
+ *
+ * The range depends on the number of tasks and participating threads only, so
+ * the same thread gets the same range in every execute, which lets it reuse
+ * data left in its caches by the previous one. Number of participating threads
+ * is context->num_threads, plus one for the calling thread if it participates.
+ *
+ * @return True if thread index is less than number of threads, otherwise false.
+ */
+bool
+station_concurrent_processing_static_range(
+        station_tasks_number_t num_tasks, ///< [in] Number of tasks.
+        station_threads_number_t num_threads, ///< [in] Number of participating threads.
+        station_thread_idx_t thread_idx, ///< [in] Index of a thread.
+
+        station_task_idx_t *begin, ///< [out] First task of the range.
+        station_task_idx_t *end ///< [out] Task after the last one of the range.
+);
+
+/**
+ * @brief Change number of active threads of a concurrent processing context.
+ *
+ * Threads with indices from num_threads to context->max_num_threads-1 don't process
+ * subsequent jobs and sleep on a condition variable until they are activated again,
+ * so the number can be changed cheaply without joining or creating threads.
+ *
+ * The function waits until jobs in flight are completed.
+ * It must not be called concurrently with submission of jobs to the same context
+ * (or to contexts sharing its threads), or from concurrent processing functions and callbacks.
+ *
+ * For a context with shared threads, only its share is changed,
+ * which must be larger than zero; other contexts are not affected.
+ *
+ * @return True if the number is changed, false if it is larger than context->max_num_threads.
+ */
+bool
+station_concurrent_processing_set_num_threads(
+        station_concurrent_processing_context_t *context, ///< [in,out] Concurrent processing context.
+        station_threads_number_t num_threads ///< [in] Number of active threads.
+);
+
+/**
+ * @brief Create per-thread scratch arenas of a concurrent processing context.
+ *
+ * Every thread gets its own arena, and one more arena (under index context->num_threads)
+ * belongs to the calling thread participating in blocking executes.
+ * Arena size is rounded up to page size (or huge page size), and pages are
+ * placed in memory when they are touched by threads for the first time.
+ *
+ * If huge pages are requested but unavailable, regular pages are used
+ * with transparent huge pages advised.
+ *
+ * Previous arenas of the context are destroyed. Zero arena size destroys arenas without creating new ones.
+ * This function must not be called while jobs are in flight.
+ *
+ * @return True if arenas are created, otherwise false.
+ */
+bool
+station_concurrent_processing_create_arenas(
+        station_concurrent_processing_context_t *context, ///< [in,out] Concurrent processing context.
+
+        size_t arena_size, ///< [in] Size of an arena in bytes.
+        bool huge_pages    ///< [in] Whether arenas are backed by huge pages.
+);
+
+/**
+ * @brief Allocate memory from scratch arena of a thread.
+ *
+ * This is a bump allocation, memory is never freed individually.
+ * Instead, arena of a thread is reset when the thread starts processing of a job,
+ * so memory is valid until the end of the current execute.
+ *
+ * This function must be called only by the thread owning the arena,
+ * i.e. with thread_idx given to the concurrent processing function.
+ *
+ * @return Allocated memory, or NULL if the arena is exhausted or inputs are incorrect.
+ */
+void*
+station_concurrent_processing_arena_allocate(
+        station_concurrent_processing_context_t *context, ///< [in] Concurrent processing context.
+        station_thread_idx_t thread_idx, ///< [in] Index of the thread owning the arena.
+
+        size_t size,     ///< [in] Size of memory in bytes.
+        size_t alignment ///< [in] Alignment of memory (power of 2), or 0 for fundamental alignment.
+);
+
+/**
+ * @brief Get the largest amount of memory ever used in scratch arena of a thread.
+ *
+ * The value is useful to choose size of arenas. It should be read
+ * when the thread is not processing a job.
+ *
+ * @return High watermark of arena in bytes, or 0 if there are no arenas.
+ */
+size_t
+station_concurrent_processing_arena_high_watermark(
+        const station_concurrent_processing_context_t *context, ///< [in] Concurrent processing context.
+        station_thread_idx_t thread_idx ///< [in] Index of the thread owning the arena.
+);
+
 /**
  * @brief Execute a concurrent processing function.
  *
- * If value of batch_size is zero, it is replaced with ((num_tasks - 1) / context->num_threads) + 1.
+ * If value of batch_size is zero, in dynamic, work-stealing and static modes it is replaced
+ * with ((num_tasks - 1) / context->num_threads) + 1.
  * With this batch size pfunc is called no more than once per thread.
  *
+ * Tasks are distributed between threads according to context->schedule.
+ * In dynamic mode, threads acquire batches from a single shared counter.
+ * In work-stealing mode, every thread starts with its own contiguous range of tasks
+ * and acquires batches from it, and then steals halves of remaining ranges of other threads.
+ * In static mode, thread i processes tasks [num_tasks * i / T; num_tasks * (i+1) / T),
+ * where T is the number of participating threads, the same ones in every execute
+ * (see station_concurrent_processing_static_range()).
+ * In guided mode, threads acquire chunks of (remaining tasks / 2T) tasks from a shared counter,
+ * but not less than batch_size tasks (1 if batch_size is zero).
+ * In adaptive mode, batch size is chosen so that a batch takes about 20 microseconds
+ * according to time of a task measured in previous executes of the same pfunc,
+ * but no larger than needed for 4 batches per thread and no smaller than batch_size.
+ *
  * If callback function pointer is NULL, the call is blocking
  * does not return until all tasks are done.
  *
@@ -67,9 +292,31 @@ station_concurrent_processing_destroy_context(
  * and returns immediately. When all tasks are done, the callback function
  * is called from one of the threads (which one is unspecified).
  *
+ * If threads are busy with previously submitted jobs, the function is processed
+ * after them. See station_concurrent_processing_submit() for details.
+ *
+ * If context->caller_participation is set and the call is blocking, the calling thread
+ * processes tasks together with threads of the context under index context->num_threads,
+ * and then waits only for the remaining tasks to be done. In this case
+ * automatic batch size is computed for (context->num_threads + 1) threads.
+ *
+ * A blocking call can be made from a concurrent processing function or a callback
+ * of a job processed by the same threads (nested execute). Such a call cannot wait for
+ * the threads, which are busy with the current job, so the calling thread processes
+ * batches of the nested job itself (in dynamic mode), while threads which run out of tasks
+ * of the current job, or wait for their own nested jobs, help it. Nested calls fail
+ * if index of the calling thread is larger than context->num_threads. Nested jobs are
+ * not affected by cancellation and time budget, nested reductions are processed by the calling thread.
+ * Non-blocking nested calls are submitted as usual, and fail if the queue of jobs is full.
+ *
+ * If context->time_budget_ns is not zero, threads stop acquiring batches when that much time
+ * has passed since submission. Batches can also be abandoned by station_concurrent_processing_cancel().
+ * In both cases batches being processed are completed, and the rest of tasks are skipped.
+ * Number of processed tasks can be obtained with station_concurrent_processing_num_processed_tasks().
+ *
  * busy_wait parameter controls waiting behavior of a calling thread if callback is NULL.
  *
- * @return True if threads weren't busy and inputs are correct, otherwise false.
+ * @return True if inputs are correct, otherwise false.
  */
 bool
 station_concurrent_processing_execute(
@@ -87,6 +334,685 @@ station_concurrent_processing_execute(
         bool busy_wait ///< [in] Whether busy-waiting is enabled.
 );
 
+/**
+ * @brief Execute a concurrent processing function for ranges of tasks.
+ *
+ * This function is the same as station_concurrent_processing_execute(),
+ * except that pfunc_range is called once per batch instead of once per task,
+ * and is given the whole range of task indices of the batch.
+ *
+ * @return True if inputs are correct, otherwise false.
+ */
+bool
+station_concurrent_processing_execute_range(
+        station_concurrent_processing_context_t *context, ///< [in] Concurrent processing context.
+
+        station_tasks_number_t num_tasks,  ///< [in] Number of tasks to be processed.
+        station_tasks_number_t batch_size, ///< [in] Number of tasks done by a thread per once.
+
+        station_pfunc_range_t pfunc_range, ///< [in] Concurrent processing function for ranges of tasks.
+        void *pfunc_data,                  ///< [in] Processed data.
+
+        station_pfunc_callback_t callback, ///< [in] Callback function or NULL.
+        void *callback_data,               ///< [in] Callback function data.
+
+        bool busy_wait ///< [in] Whether busy-waiting is enabled.
+);
+
+/**
+ * @brief Execute a concurrent processing function for ranges of tasks in 64-bit task index space.
+ *
+ * This function is the same as station_concurrent_processing_execute_range(),
+ * except that number of tasks may exceed 32-bit range.
+ *
+ * If number of tasks is larger than the largest value of station_tasks_number_t,
+ * tasks are distributed between threads in blocks of ceil(num_tasks / that value) tasks,
+ * so batch size is rounded up to a multiple of block size.
+ * Otherwise, the behavior is exactly the same as of station_concurrent_processing_execute_range().
+ *
+ * @return True if inputs are correct, otherwise false.
+ */
+bool
+station_concurrent_processing_execute_range64(
+        station_concurrent_processing_context_t *context, ///< [in] Concurrent processing context.
+
+        station_tasks_number64_t num_tasks,  ///< [in] Number of tasks to be processed.
+        station_tasks_number64_t batch_size, ///< [in] Number of tasks done by a thread per once.
+
+        station_pfunc_range64_t pfunc_range64, ///< [in] Concurrent processing function for ranges of tasks.
+        void *pfunc_data,                      ///< [in] Processed data.
+
+        station_pfunc_callback_t callback, ///< [in] Callback function or NULL.
+        void *callback_data,               ///< [in] Callback function data.
+
+        bool busy_wait ///< [in] Whether busy-waiting is enabled.
+);
+
+/**
+ * @brief Execute a concurrent processing function for tiles of a 2D or 3D iteration domain.
+ *
+ * The domain is divided into tiles of the specified size (tiles at the far edges
+ * may be smaller), and every tile is a task. pfunc_tile receives coordinates of a tile
+ * directly, so no division is needed to recover them.
+ *
+ * Tiles are enumerated in domain->order, and batches of consecutive tiles are distributed
+ * between threads as in station_concurrent_processing_execute(). Morton and Hilbert orders
+ * keep tiles of a batch close to each other in every dimension. For 3D domains
+ * these orders require the number of tiles along every axis not to exceed (1 << 21).
+ *
+ * Domain is copied, so it doesn't have to remain valid after the call returns.
+ *
+ * @return True if inputs are correct and memory is allocated, otherwise false.
+ */
+bool
+station_concurrent_processing_execute_tiled(
+        station_concurrent_processing_context_t *context, ///< [in] Concurrent processing context.
+
+        const station_concurrent_processing_domain_t *domain, ///< [in] Iteration domain.
+        station_tasks_number_t batch_size, ///< [in] Number of tiles done by a thread per once.
+
+        station_pfunc_tile_t pfunc_tile, ///< [in] Concurrent processing function for tiles.
+        void *pfunc_data,                ///< [in] Processed data.
+
+        station_pfunc_callback_t callback, ///< [in] Callback function or NULL.
+        void *callback_data,               ///< [in] Callback function data.
+
+        bool busy_wait ///< [in] Whether busy-waiting is enabled.
+);
+
+/**
+ * @brief Execute a sequence of concurrent processing functions as a single job.
+ *
+ * Phases are processed in order with a barrier between them: tasks of a phase
+ * are not started until all tasks of the previous phase are done. Threads pass
+ * the barriers inside the job, so threads are woken and the job is completed once
+ * for the whole sequence instead of once per phase. The barrier counts processed tasks
+ * rather than threads, so threads which start the job late don't delay other threads.
+ *
+ * Threads acquire batches of the current phase from a shared counter. If value of batch_size
+ * of a phase is zero, it is replaced with ((num_tasks - 1) / context->num_threads) + 1.
+ * Threads without available tasks wait for the next phase. Phases without tasks are skipped.
+ *
+ * Phases are copied, so the array needn't outlive a non-blocking call.
+ * Cancellation only prevents the job from starting.
+ *
+ * @return True if inputs are correct, otherwise false.
+ */
+bool
+station_concurrent_processing_execute_phases(
+        station_concurrent_processing_context_t *context, ///< [in] Concurrent processing context.
+
+        const station_concurrent_processing_phase_t *phases, ///< [in] Phases.
+        size_t num_phases, ///< [in] Number of phases.
+
+        station_pfunc_callback_t callback, ///< [in] Callback function or NULL.
+        void *callback_data,               ///< [in] Callback function data.
+
+        bool busy_wait ///< [in] Whether busy-waiting is enabled.
+);
+
+/**
+ * @brief Execute a persistent concurrent processing function on all threads at once.
+ *
+ * Every thread processing the job calls the function once, with indices
+ * of threads from 0 to num_threads-1. The calling thread participates in blocking
+ * calls as the last thread if context->caller_participation is set.
+ * If the context has no threads, the function is called once by the calling thread.
+ *
+ * Threads stay inside the function until it returns and synchronize
+ * with station_concurrent_processing_barrier(), which makes iterative algorithms
+ * possible without returning to the calling thread after every sweep.
+ * Persistent jobs ignore cancellation and time budget, as every thread must reach every barrier.
+ *
+ * Blocking calls from concurrent processing functions of the same threads fail,
+ * as threads processing the outer job cannot join.
+ *
+ * @return True if inputs are correct, otherwise false.
+ */
+bool
+station_concurrent_processing_execute_persistent(
+        station_concurrent_processing_context_t *context, ///< [in] Concurrent processing context.
+
+        station_pfunc_persistent_t pfunc_persistent, ///< [in] Persistent concurrent processing function.
+        void *pfunc_data,                            ///< [in] Processed data.
+
+        station_pfunc_callback_t callback, ///< [in] Callback function or NULL.
+        void *callback_data,               ///< [in] Callback function data.
+
+        bool busy_wait ///< [in] Whether busy-waiting is enabled.
+);
+
+/**
+ * @brief Wait until all threads processing a persistent job reach the barrier.
+ *
+ * This function is called from a persistent concurrent processing function
+ * by every thread processing the job the same number of times.
+ * Memory writes done before the barrier are visible to all threads after it.
+ *
+ * Threads arrive at a combining tree of counters grouping neighbouring thread indices,
+ * so that arrivals don't contend on a single cache line, and the last thread releases all of them.
+ * Waiting threads spin if context->busy_wait is set, otherwise they spin
+ * for the spin count of the context and then block on a condition variable.
+ *
+ * @return True if called from a persistent concurrent processing function of the context, otherwise false.
+ */
+bool
+station_concurrent_processing_barrier(
+        station_concurrent_processing_context_t *context, ///< [in] Concurrent processing context.
+        station_thread_idx_t thread_idx ///< [in] Index of the calling thread.
+);
+
+/**
+ * @brief Execute a concurrent reduction.
+ *
+ * Every participating thread has own partial result, which is initialized with
+ * a copy of identity and is placed in separate cache lines. accumulate is called
+ * for every task with partial result of the calling thread. When a thread runs out
+ * of tasks, partial results are combined in pairs in a tree-like manner by
+ * the threads finishing last, and the final result is copied to result.
+ *
+ * Scheduling, batch size, caller participation and waiting behavior are the same
+ * as of station_concurrent_processing_execute(). If callback function pointer
+ * is not NULL, the call is non-blocking, and result is written before the callback
+ * is called, so the memory pointed to by result must remain valid until then.
+ *
+ * If number of tasks is zero, identity is copied to result,
+ * and callback is called from the calling thread.
+ *
+ * @return True if inputs are correct and memory is allocated, otherwise false.
+ */
+bool
+station_concurrent_processing_reduce(
+        station_concurrent_processing_context_t *context, ///< [in] Concurrent processing context.
+
+        station_tasks_number_t num_tasks,  ///< [in] Number of tasks to be processed.
+        station_tasks_number_t batch_size, ///< [in] Number of tasks done by a thread per once.
+
+        station_pfunc_accumulate_t accumulate, ///< [in] Accumulate function.
+        station_pfunc_combine_t combine,       ///< [in] Combine function.
+        void *pfunc_data,                      ///< [in] Processed data.
+
+        size_t element_size,  ///< [in] Size of a result in bytes.
+        const void *identity, ///< [in] Identity element, or NULL for all zero bytes.
+        void *result,         ///< [out] Result of the reduction.
+
+        station_pfunc_callback_t callback, ///< [in] Callback function or NULL.
+        void *callback_data,               ///< [in] Callback function data.
+
+        bool busy_wait ///< [in] Whether busy-waiting is enabled.
+);
+
+/**
+ * @brief Copy memory using threads of a concurrent processing context.
+ *
+ * Memory is divided into chunks consisting of whole cache lines,
+ * which are copied by threads concurrently. Memory areas must not overlap.
+ *
+ * Parallel algorithms (this function, station_concurrent_processing_memset(),
+ * station_concurrent_processing_scan(), station_concurrent_processing_radix_sort(),
+ * station_concurrent_processing_histogram(), station_concurrent_processing_compact())
+ * are blocking, ignore scheduling mode of the context and cannot be cancelled.
+ * Caller participation and waiting behavior are the same as of station_concurrent_processing_execute().
+ *
+ * @return True if inputs are correct, otherwise false.
+ */
+bool
+station_concurrent_processing_memcpy(
+        station_concurrent_processing_context_t *context, ///< [in] Concurrent processing context.
+
+        void *dest,      ///< [out] Destination memory.
+        const void *src, ///< [in] Source memory.
+        size_t size,     ///< [in] Size of memory in bytes.
+
+        bool busy_wait ///< [in] Whether busy-waiting is enabled.
+);
+
+/**
+ * @brief Fill memory using threads of a concurrent processing context.
+ *
+ * @see station_concurrent_processing_memcpy()
+ *
+ * @return True if inputs are correct, otherwise false.
+ */
+bool
+station_concurrent_processing_memset(
+        station_concurrent_processing_context_t *context, ///< [in] Concurrent processing context.
+
+        void *dest,  ///< [out] Destination memory.
+        int value,   ///< [in] Value of bytes.
+        size_t size, ///< [in] Size of memory in bytes.
+
+        bool busy_wait ///< [in] Whether busy-waiting is enabled.
+);
+
+/**
+ * @brief Compute prefix combinations (scan) of an array using threads of a concurrent processing context.
+ *
+ * Inclusive scan writes combination of elements [0; i] to output element i,
+ * exclusive scan writes combination of elements [0; i) (identity for i = 0).
+ * combine(data, partial, other_partial) must store combination of partial followed by
+ * other_partial into partial, and must be associative (but not necessarily commutative).
+ *
+ * Input and output arrays must be the same or must not overlap.
+ *
+ * @return True if inputs are correct and memory is allocated, otherwise false.
+ */
+bool
+station_concurrent_processing_scan(
+        station_concurrent_processing_context_t *context, ///< [in] Concurrent processing context.
+
+        const void *input,   ///< [in] Input array.
+        void *output,        ///< [out] Output array.
+        size_t num_elements, ///< [in] Number of elements.
+        size_t element_size, ///< [in] Size of an element in bytes.
+
+        station_pfunc_combine_t combine, ///< [in] Combine function.
+        void *combine_data,   ///< [in] Combine function data.
+        const void *identity, ///< [in] Identity element, or NULL for all zero bytes.
+        bool inclusive,       ///< [in] Whether scan is inclusive.
+
+        bool busy_wait ///< [in] Whether busy-waiting is enabled.
+);
+
+/**
+ * @brief Sort an array of unsigned integer keys using threads of a concurrent processing context.
+ *
+ * Keys are sorted in ascending order by LSD radix sort, which is stable.
+ * Payloads (if not NULL) are moved together with their keys.
+ * Passes over key digits which are the same for all keys are skipped.
+ * Temporary memory of the same size as keys and payloads is allocated.
+ *
+ * @return True if inputs are correct and memory is allocated, otherwise false.
+ */
+bool
+station_concurrent_processing_radix_sort(
+        station_concurrent_processing_context_t *context, ///< [in] Concurrent processing context.
+
+        void *keys,          ///< [in,out] Array of keys.
+        size_t key_size,     ///< [in] Size of a key in bytes: 4 (uint32_t) or 8 (uint64_t).
+        void *payloads,      ///< [in,out] Array of payloads, or NULL.
+        size_t payload_size, ///< [in] Size of a payload in bytes.
+        size_t num_elements, ///< [in] Number of keys.
+
+        bool busy_wait ///< [in] Whether busy-waiting is enabled.
+);
+
+/**
+ * @brief Compute histogram of elements using threads of a concurrent processing context.
+ *
+ * Every thread counts elements in its own partial histogram,
+ * then partial histograms are summed up concurrently.
+ *
+ * @return True if inputs are correct and memory is allocated, otherwise false.
+ */
+bool
+station_concurrent_processing_histogram(
+        station_concurrent_processing_context_t *context, ///< [in] Concurrent processing context.
+
+        size_t num_elements,     ///< [in] Number of elements.
+        station_pfunc_bin_t bin, ///< [in] Bin function.
+        void *bin_data,          ///< [in] Bin function data.
+
+        size_t num_bins,   ///< [in] Number of bins.
+        size_t *histogram, ///< [out] Numbers of elements in bins.
+
+        bool busy_wait ///< [in] Whether busy-waiting is enabled.
+);
+
+/**
+ * @brief Copy selected elements of an array (stream compaction) using threads of a concurrent processing context.
+ *
+ * Selected elements are copied to the beginning of the output array in their original order.
+ * Predicate is called twice for every element, so it must return the same result.
+ * Input and output arrays must not overlap.
+ *
+ * @return True if inputs are correct and memory is allocated, otherwise false.
+ */
+bool
+station_concurrent_processing_compact(
+        station_concurrent_processing_context_t *context, ///< [in] Concurrent processing context.
+
+        const void *input,   ///< [in] Input array.
+        void *output,        ///< [out] Output array.
+        size_t num_elements, ///< [in] Number of elements.
+        size_t element_size, ///< [in] Size of an element in bytes.
+
+        station_pfunc_predicate_t predicate, ///< [in] Predicate function.
+        void *predicate_data, ///< [in] Predicate function data.
+
+        size_t *num_selected, ///< [out] Number of selected elements, or NULL.
+
+        bool busy_wait ///< [in] Whether busy-waiting is enabled.
+);
+
+/**
+ * @brief Create a reusable task graph.
+ *
+ * Nodes and their dependencies are copied, and everything needed to run the graph
+ * is allocated and precomputed once, so that running it doesn't allocate memory.
+ * Dependencies must not form cycles. Number of tasks of every node must be positive.
+ *
+ * @return Task graph, or NULL if inputs are incorrect or memory couldn't be allocated.
+ */
+struct station_concurrent_processing_graph*
+station_concurrent_processing_create_graph(
+        const station_concurrent_processing_graph_node_t *nodes, ///< [in] Nodes of the graph.
+        size_t num_nodes ///< [in] Number of nodes.
+);
+
+/**
+ * @brief Destroy a task graph.
+ *
+ * The graph must not be running.
+ */
+void
+station_concurrent_processing_destroy_graph(
+        struct station_concurrent_processing_graph *graph ///< [in] Graph to destroy.
+);
+
+/**
+ * @brief Run all nodes of a task graph.
+ *
+ * The graph is executed as a single job of the context. A node becomes ready
+ * as soon as all nodes it depends on are done, and threads take batches of tasks
+ * from the earliest ready nodes, so independent nodes are processed at the same time.
+ * Threads without available tasks wait for new ready nodes.
+ *
+ * If value of batch_size of a node is zero, it is replaced
+ * with ((num_tasks - 1) / context->num_threads) + 1.
+ *
+ * Blocking and non-blocking behavior, caller participation and busy_wait parameter
+ * are the same as of station_concurrent_processing_execute().
+ * A graph must not be run again until the previous run is complete.
+ *
+ * @return True if inputs are correct, otherwise false.
+ */
+bool
+station_concurrent_processing_run_graph(
+        station_concurrent_processing_context_t *context, ///< [in] Concurrent processing context.
+        struct station_concurrent_processing_graph *graph, ///< [in] Task graph.
+
+        station_pfunc_callback_t callback, ///< [in] Callback function or NULL.
+        void *callback_data,               ///< [in] Callback function data.
+
+        bool busy_wait ///< [in] Whether busy-waiting is enabled.
+);
+
+/**
+ * @brief Create a reusable pipeline.
+ *
+ * Stages are copied, and queues between stages and memory for items
+ * are allocated once, so that running the pipeline doesn't allocate memory.
+ *
+ * @return Pipeline, or NULL if inputs are incorrect or memory couldn't be allocated.
+ */
+struct station_concurrent_processing_pipeline*
+station_concurrent_processing_create_pipeline(
+        const station_concurrent_processing_pipeline_stage_t *stages, ///< [in] Stages of the pipeline.
+        size_t num_stages ///< [in] Number of stages.
+);
+
+/**
+ * @brief Destroy a pipeline.
+ *
+ * The pipeline must not be running.
+ */
+void
+station_concurrent_processing_destroy_pipeline(
+        struct station_concurrent_processing_pipeline *pipeline ///< [in] Pipeline to destroy.
+);
+
+/**
+ * @brief Run a pipeline until its first stage runs out of items.
+ *
+ * The pipeline is executed as a single job of the context. Every stage is bound
+ * to its own number of threads, which process items of the stage as soon as they appear
+ * in the input queue, so that all stages work at the same time.
+ * A stage with full output queue waits for the next stage (backpressure).
+ * If the context has fewer threads (including the caller, if it participates)
+ * than the stages need, a thread alternates between several stages.
+ * The job is complete when all items are processed by the last stage.
+ *
+ * Blocking and non-blocking behavior, caller participation and busy_wait parameter
+ * are the same as of station_concurrent_processing_execute().
+ * Pipeline runs cannot be cancelled or limited by the time budget.
+ * A pipeline must not be run again until the previous run is complete.
+ *
+ * Without concurrent processing support, every item is passed through all stages in turn.
+ *
+ * @return True if inputs are correct, otherwise false.
+ */
+bool
+station_concurrent_processing_run_pipeline(
+        station_concurrent_processing_context_t *context, ///< [in] Concurrent processing context.
+        struct station_concurrent_processing_pipeline *pipeline, ///< [in] Pipeline.
+
+        station_pfunc_callback_t callback, ///< [in] Callback function or NULL.
+        void *callback_data,               ///< [in] Callback function data.
+
+        bool busy_wait ///< [in] Whether busy-waiting is enabled.
+);
+
+/**
+ * @brief Get statistics of a pipeline stage during the last run.
+ *
+ * @return True if statistics are available, false if inputs are incorrect
+ * or concurrent processing is not supported.
+ */
+bool
+station_concurrent_processing_get_pipeline_stats(
+        const struct station_concurrent_processing_pipeline *pipeline, ///< [in] Pipeline.
+        size_t stage_idx, ///< [in] Index of a stage.
+        station_concurrent_processing_pipeline_stats_t *stats ///< [out] Statistics of the stage.
+);
+
+/**
+ * @brief Submit a concurrent processing function without waiting for it.
+ *
+ * The call is non-blocking: the job is appended to the queue of jobs of the context,
+ * which are processed by threads in the order of submission.
+ * Up to STATION_CONCURRENT_PROCESSING_MAX_JOBS jobs can be in flight at once. If the queue is full,
+ * the call waits for the oldest job to complete (busy-waiting if context->busy_wait is set).
+ *
+ * Batch size and scheduling mode are treated as in station_concurrent_processing_execute().
+ * If callback function pointer is not NULL, it is called from one of the threads
+ * when all tasks are done, before the job is considered completed.
+ * If context->notification_fd is not negative, it is signaled after the job is completed
+ * (see station_concurrent_processing_create_notification()).
+ *
+ * Jobs can be submitted from any thread. A concurrent processing function or a callback
+ * of a job processed by the same threads cannot wait for the queue, as its own job
+ * may be the oldest one, so the call fails instead if the queue is full.
+ * A context without threads processes the job in the calling thread before returning.
+ *
+ * @return Job handle, or 0 if inputs are incorrect or the queue is full in a nested call.
+ */
+station_concurrent_processing_job_t
+station_concurrent_processing_submit(
+        station_concurrent_processing_context_t *context, ///< [in] Concurrent processing context.
+
+        station_tasks_number_t num_tasks,  ///< [in] Number of tasks to be processed.
+        station_tasks_number_t batch_size, ///< [in] Number of tasks done by a thread per once.
+
+        station_pfunc_t pfunc, ///< [in] Concurrent processing function.
+        void *pfunc_data,      ///< [in] Processed data.
+
+        station_pfunc_callback_t callback, ///< [in] Callback function or NULL.
+        void *callback_data                ///< [in] Callback function data.
+);
+
+/**
+ * @brief Submit a concurrent processing function for ranges of tasks without waiting for it.
+ *
+ * This function is the same as station_concurrent_processing_submit(),
+ * except that pfunc_range is called once per batch instead of once per task.
+ *
+ * @return Job handle, or 0 if inputs are incorrect or the queue is full in a nested call.
+ */
+station_concurrent_processing_job_t
+station_concurrent_processing_submit_range(
+        station_concurrent_processing_context_t *context, ///< [in] Concurrent processing context.
+
+        station_tasks_number_t num_tasks,  ///< [in] Number of tasks to be processed.
+        station_tasks_number_t batch_size, ///< [in] Number of tasks done by a thread per once.
+
+        station_pfunc_range_t pfunc_range, ///< [in] Concurrent processing function for ranges of tasks.
+        void *pfunc_data,                  ///< [in] Processed data.
+
+        station_pfunc_callback_t callback, ///< [in] Callback function or NULL.
+        void *callback_data                ///< [in] Callback function data.
+);
+
+/**
+ * @brief Wait until a submitted job is completed.
+ *
+ * Since jobs are completed in the order of submission,
+ * all jobs submitted before it are completed too.
+ *
+ * This function must not be called from concurrent processing functions
+ * or callbacks of the same context.
+ *
+ * @return True if the job handle is valid, otherwise false.
+ */
+bool
+station_concurrent_processing_wait(
+        station_concurrent_processing_context_t *context, ///< [in] Concurrent processing context.
+        station_concurrent_processing_job_t job, ///< [in] Job handle.
+
+        bool busy_wait ///< [in] Whether busy-waiting is enabled.
+);
+
+/**
+ * @brief Check whether a submitted job is completed.
+ *
+ * @return True if the job is completed, otherwise false.
+ */
+bool
+station_concurrent_processing_poll(
+        station_concurrent_processing_context_t *context, ///< [in] Concurrent processing context.
+        station_concurrent_processing_job_t job ///< [in] Job handle.
+);
+
+/**
+ * @brief Cancel a submitted job.
+ *
+ * Threads stop acquiring batches of the job, and the job completes as soon as
+ * batches being processed are done. The callback function is still called.
+ * Cancellation of a completed job has no effect.
+ *
+ * If the job handle is 0, all jobs which are not completed yet are cancelled.
+ * This is the way to cancel a blocking execute, e.g. from its concurrent processing function.
+ *
+ * Jobs of a context without threads are processed before they can be cancelled.
+ * A running task graph is finished, cancellation only prevents it from starting.
+ * Reductions combine partial results of processed tasks only.
+ *
+ * @return True if the job handle is valid, otherwise false.
+ */
+bool
+station_concurrent_processing_cancel(
+        station_concurrent_processing_context_t *context, ///< [in] Concurrent processing context.
+        station_concurrent_processing_job_t job ///< [in] Job handle, or 0 for all jobs.
+);
+
+/**
+ * @brief Get number of tasks processed by a completed job.
+ *
+ * The number is less than number of tasks if the job was cancelled
+ * or ran out of time budget.
+ *
+ * Results are kept for the last STATION_CONCURRENT_PROCESSING_MAX_JOBS submitted jobs only.
+ *
+ * @return True if the job is completed and its result is still kept, otherwise false.
+ */
+bool
+station_concurrent_processing_num_processed_tasks(
+        station_concurrent_processing_context_t *context, ///< [in] Concurrent processing context.
+        station_concurrent_processing_job_t job, ///< [in] Job handle.
+
+        station_tasks_number_t *num_processed_tasks ///< [out] Number of processed tasks.
+);
+
+/**
+ * @brief Create a notification file descriptor for completion of jobs.
+ *
+ * The descriptor is a non-blocking eventfd. When it is assigned to context->notification_fd,
+ * every job submitted afterwards without waiting for it (including non-blocking executes)
+ * increments its counter on completion, in the order of submission.
+ * The descriptor becomes readable, so it can be waited on by poll(), select() or epoll
+ * together with other event sources, without running user code in threads.
+ *
+ * Any file descriptor accepting 8-byte writes (e.g. write end of a pipe) can be used instead.
+ *
+ * @return File descriptor, or negative value if notifications are not supported.
+ */
+int
+station_concurrent_processing_create_notification(void);
+
+/**
+ * @brief Destroy a notification file descriptor.
+ *
+ * The descriptor must not be used by jobs which are not completed yet.
+ */
+void
+station_concurrent_processing_destroy_notification(
+        int fd ///< [in] Notification file descriptor.
+);
+
+/**
+ * @brief Read and reset number of job completions signaled to a notification file descriptor.
+ *
+ * The call is non-blocking.
+ *
+ * @return Number of jobs completed since the previous read, or 0 if there are none.
+ */
+uint64_t
+station_concurrent_processing_read_notification(
+        int fd ///< [in] Notification file descriptor.
+);
+
+/**
+ * @brief Get instrumentation counters of a concurrent processing context.
+ *
+ * Counters are collected only if instrumentation was enabled at configuration time,
+ * otherwise they cost nothing. Counters are read without synchronization,
+ * so values are consistent only when no jobs are being processed.
+ *
+ * @return True if counters are available, otherwise false.
+ */
+bool
+station_concurrent_processing_get_stats(
+        const station_concurrent_processing_context_t *context, ///< [in] Concurrent processing context.
+
+        station_concurrent_processing_stats_t *stats ///< [out] Counters of the context.
+);
+
+/**
+ * @brief Get instrumentation counters of a concurrent processing thread.
+ *
+ * Calling thread taking part in blocking executes is counted under
+ * thread index context->num_threads (thread index 0 for a context without threads).
+ *
+ * @return True if counters are available, otherwise false.
+ */
+bool
+station_concurrent_processing_get_thread_stats(
+        const station_concurrent_processing_context_t *context, ///< [in] Concurrent processing context.
+        station_thread_idx_t thread_idx, ///< [in] Thread index.
+
+        station_concurrent_processing_thread_stats_t *stats ///< [out] Counters of the thread.
+);
+
+/**
+ * @brief Reset instrumentation counters of a concurrent processing context and its threads.
+ *
+ * This function should be called when no jobs are being processed.
+ */
+void
+station_concurrent_processing_reset_stats(
+        station_concurrent_processing_context_t *context ///< [in] Concurrent processing context.
+);
+
 /**
  * @brief Create lock-free queue.
  *
@@ -31,6 +31,8 @@
 #include <stdbool.h>
 
 struct station_concurrent_processing_threads_state;
+struct station_concurrent_processing_graph;
+struct station_concurrent_processing_pipeline;
 
 /**
  * @brief Index of a concurrent task.
@@ -41,6 +43,15 @@ typedef uint32_t station_task_idx_t;
  */
 typedef station_task_idx_t station_tasks_number_t;
 
+/**
+ * @brief Index of a concurrent task in 64-bit task index space.
+ */
+typedef uint64_t station_task_idx64_t;
+/**
+ * @brief Number of concurrent tasks in 64-bit task index space.
+ */
+typedef station_task_idx64_t station_tasks_number64_t;
+
 /**
  * @brief Index of a thread.
  */
@@ -50,6 +61,53 @@ typedef uint16_t station_thread_idx_t;
  */
 typedef station_thread_idx_t station_threads_number_t;
 
+/**
+ * @brief Index of a CPU.
+ */
+typedef int32_t station_cpu_idx_t;
+
+/**
+ * @brief Index of a NUMA node.
+ */
+typedef int32_t station_numa_node_idx_t;
+
+/**
+ * @brief Scheduling mode of concurrent processing.
+ *
+ * @see STATION_CONCURRENT_PROCESSING_SCHEDULE_DYNAMIC
+ * @see STATION_CONCURRENT_PROCESSING_SCHEDULE_WORK_STEALING
+ * @see STATION_CONCURRENT_PROCESSING_SCHEDULE_STATIC
+ * @see STATION_CONCURRENT_PROCESSING_SCHEDULE_GUIDED
+ * @see STATION_CONCURRENT_PROCESSING_SCHEDULE_ADAPTIVE
+ */
+typedef uint8_t station_concurrent_processing_schedule_t;
+
+/**
+ * @brief Policy of thread placement on CPUs.
+ *
+ * @see STATION_CONCURRENT_PROCESSING_PLACEMENT_COMPACT
+ * @see STATION_CONCURRENT_PROCESSING_PLACEMENT_SCATTER
+ * @see STATION_CONCURRENT_PROCESSING_PLACEMENT_PHYSICAL
+ */
+typedef uint8_t station_concurrent_processing_placement_t;
+
+/**
+ * @brief Order in which tiles of an iteration domain are enumerated.
+ *
+ * @see STATION_CONCURRENT_PROCESSING_TILE_ORDER_ROW_MAJOR
+ * @see STATION_CONCURRENT_PROCESSING_TILE_ORDER_MORTON
+ * @see STATION_CONCURRENT_PROCESSING_TILE_ORDER_HILBERT
+ */
+typedef uint8_t station_concurrent_processing_tile_order_t;
+
+/**
+ * @brief Handle of a submitted concurrent processing job.
+ *
+ * Zero value is an invalid handle.
+ * Jobs of a context are completed in the order of submission.
+ */
+typedef uint64_t station_concurrent_processing_job_t;
+
 /**
  * @brief Concurrent processing function.
  */
@@ -59,6 +117,30 @@ typedef void (*station_pfunc_t)(
         station_thread_idx_t thread_idx ///< [in] Index of the calling thread.
 );
 
+/**
+ * @brief Concurrent processing function for ranges of tasks.
+ *
+ * This function processes all tasks with indices in [task_idx_begin; task_idx_end).
+ */
+typedef void (*station_pfunc_range_t)(
+        void *data, ///< [in,out] Processed data.
+        station_task_idx_t task_idx_begin, ///< [in] Index of the first task of the range.
+        station_task_idx_t task_idx_end,   ///< [in] Index of the task after the last one of the range.
+        station_thread_idx_t thread_idx ///< [in] Index of the calling thread.
+);
+
+/**
+ * @brief Concurrent processing function for ranges of tasks in 64-bit task index space.
+ *
+ * This function processes all tasks with indices in [task_idx_begin; task_idx_end).
+ */
+typedef void (*station_pfunc_range64_t)(
+        void *data, ///< [in,out] Processed data.
+        station_task_idx64_t task_idx_begin, ///< [in] Index of the first task of the range.
+        station_task_idx64_t task_idx_end,   ///< [in] Index of the task after the last one of the range.
+        station_thread_idx_t thread_idx ///< [in] Index of the calling thread.
+);
+
 /**
  * @brief Concurrent processing callback.
  *
@@ -69,13 +151,253 @@ typedef void (*station_pfunc_callback_t)(
         station_thread_idx_t thread_idx ///< [in] Index of the calling thread.
 );
 
+/**
+ * @brief Concurrent reduction accumulate function.
+ *
+ * This function accumulates result of a task into partial result of the calling thread.
+ */
+typedef void (*station_pfunc_accumulate_t)(
+        void *data, ///< [in] Processed data.
+        void *partial, ///< [in,out] Partial result of the calling thread.
+        station_task_idx_t task_idx,    ///< [in] Index of the current task.
+        station_thread_idx_t thread_idx ///< [in] Index of the calling thread.
+);
+
+/**
+ * @brief Concurrent reduction combine function.
+ *
+ * This function combines other partial result into a partial result.
+ * The operation must be associative and commutative.
+ */
+typedef void (*station_pfunc_combine_t)(
+        void *data, ///< [in] Processed data.
+        void *partial, ///< [in,out] Partial result to combine into.
+        const void *other_partial ///< [in] Other partial result.
+);
+
+/**
+ * @brief Histogram bin function.
+ *
+ * This function computes index of a bin an element belongs to.
+ * Elements with bin index not less than the number of bins are not counted.
+ */
+typedef size_t (*station_pfunc_bin_t)(
+        void *data, ///< [in] Processed data.
+        size_t element_idx ///< [in] Index of an element.
+);
+
+/**
+ * @brief Stream compaction predicate function.
+ *
+ * This function checks whether an element is selected.
+ */
+typedef bool (*station_pfunc_predicate_t)(
+        void *data, ///< [in] Processed data.
+        size_t element_idx ///< [in] Index of an element.
+);
+
+/**
+ * @brief Pipeline stage function.
+ *
+ * This function processes an item taken from the previous stage
+ * and writes an item for the next stage.
+ * Input of the first stage is NULL, the first stage produces items
+ * and returns false when there are no more items.
+ * Output of the last stage is NULL.
+ * Other stages return false to drop the item.
+ */
+typedef bool (*station_pfunc_stage_t)(
+        void *data, ///< [in,out] Processed data.
+        const void *input, ///< [in] Input item, or NULL for the first stage.
+        void *output, ///< [out] Output item, or NULL for the last stage.
+        station_thread_idx_t thread_idx ///< [in] Index of the calling thread.
+);
+
+/**
+ * @brief Persistent concurrent processing function.
+ *
+ * This function is called once by every thread processing a persistent job.
+ * The threads run it at the same time, so they may synchronize with each other
+ * using station_concurrent_processing_barrier().
+ */
+typedef void (*station_pfunc_persistent_t)(
+        void *data, ///< [in,out] Processed data.
+        station_thread_idx_t thread_idx, ///< [in] Index of the calling thread.
+        station_threads_number_t num_threads ///< [in] Number of threads processing the job.
+);
+
+/**
+ * @brief Tile of an iteration domain.
+ *
+ * Tile contains elements with coordinates in [begin; end) along every axis.
+ */
+typedef struct station_concurrent_processing_tile {
+    struct {
+        station_task_idx_t begin; ///< Coordinate of the first element of the tile.
+        station_task_idx_t end;   ///< Coordinate of the element after the last one of the tile.
+    } x, ///< Range of X coordinates.
+      y, ///< Range of Y coordinates.
+      z; ///< Range of Z coordinates.
+} station_concurrent_processing_tile_t;
+
+/**
+ * @brief 2D or 3D iteration domain divided into tiles.
+ *
+ * Zero depth of extent or tile is treated as 1.
+ */
+typedef struct station_concurrent_processing_domain {
+    struct {
+        station_task_idx_t x; ///< X coordinate of the first element.
+        station_task_idx_t y; ///< Y coordinate of the first element.
+        station_task_idx_t z; ///< Z coordinate of the first element.
+    } origin; ///< Coordinates of the first element of the domain.
+
+    struct {
+        station_task_idx_t width;  ///< Number of elements along X axis.
+        station_task_idx_t height; ///< Number of elements along Y axis.
+        station_task_idx_t depth;  ///< Number of elements along Z axis.
+    } extent, ///< Size of the domain.
+      tile;   ///< Size of a tile.
+
+    station_concurrent_processing_tile_order_t order; ///< Order of tiles.
+} station_concurrent_processing_domain_t;
+
+/**
+ * @brief Concurrent processing function for tiles of an iteration domain.
+ */
+typedef void (*station_pfunc_tile_t)(
+        void *data, ///< [in,out] Processed data.
+        const station_concurrent_processing_tile_t *tile, ///< [in] Current tile.
+        station_thread_idx_t thread_idx ///< [in] Index of the calling thread.
+);
+
+/**
+ * @brief Phase of a multi-phase execute.
+ *
+ * Exactly one of pfunc and pfunc_range must be not NULL.
+ */
+typedef struct station_concurrent_processing_phase {
+    station_pfunc_t pfunc;             ///< Concurrent processing function, or NULL.
+    station_pfunc_range_t pfunc_range; ///< Concurrent processing function for ranges of tasks, or NULL.
+    void *pfunc_data;                  ///< Processed data.
+
+    station_tasks_number_t num_tasks;  ///< Number of tasks to be processed.
+    station_tasks_number_t batch_size; ///< Number of tasks done by a thread per once.
+} station_concurrent_processing_phase_t;
+
+/**
+ * @brief Node of a task graph.
+ *
+ * Exactly one of pfunc and pfunc_range must be not NULL.
+ */
+typedef struct station_concurrent_processing_graph_node {
+    station_pfunc_t pfunc;             ///< Concurrent processing function, or NULL.
+    station_pfunc_range_t pfunc_range; ///< Concurrent processing function for ranges of tasks, or NULL.
+    void *pfunc_data;                  ///< Processed data.
+
+    station_tasks_number_t num_tasks;  ///< Number of tasks to be processed.
+    station_tasks_number_t batch_size; ///< Number of tasks done by a thread per once.
+
+    size_t num_dependencies;    ///< Number of nodes this node depends on.
+    const size_t *dependencies; ///< Indices of nodes this node depends on.
+} station_concurrent_processing_graph_node_t;
+
+/**
+ * @brief Stage of a pipeline.
+ *
+ * Items output by a stage are passed to the next stage
+ * through a bounded lock-free queue of (1 << output_capacity_log2) items.
+ * Output parameters of the last stage are ignored.
+ */
+typedef struct station_concurrent_processing_pipeline_stage {
+    station_pfunc_stage_t pfunc; ///< Stage function.
+    void *pfunc_data;            ///< Processed data.
+
+    station_threads_number_t num_threads; ///< Number of threads bound to the stage (positive).
+
+    size_t output_size;            ///< Size of an output item in bytes.
+    uint8_t output_alignment_log2; ///< Log2 of output item alignment in bytes.
+    uint8_t output_capacity_log2;  ///< Log2 of capacity of the output queue.
+} station_concurrent_processing_pipeline_stage_t;
+
+/**
+ * @brief Statistics of a pipeline stage during the last run.
+ *
+ * Occupancy of the output queue is sampled every time an item is pushed to it.
+ * A stage with starved threads is limited by the previous stage,
+ * a stage with blocked threads is limited by the next stage.
+ */
+typedef struct station_concurrent_processing_pipeline_stats {
+    uint64_t num_items; ///< Number of processed items.
+    uint64_t busy_ns;   ///< Total time spent in the stage function by all threads.
+
+    uint64_t num_starved; ///< Number of times the input queue was found empty.
+    uint64_t num_blocked; ///< Number of times the output queue was found full.
+
+    double throughput; ///< Processed items per second.
+
+    double mean_occupancy; ///< Average number of items in the output queue.
+    uint64_t max_occupancy; ///< Largest number of items in the output queue.
+} station_concurrent_processing_pipeline_stats_t;
+
+/**
+ * @brief Instrumentation counters of a concurrent processing thread.
+ *
+ * Times are in nanoseconds and accumulated over all jobs.
+ */
+typedef struct station_concurrent_processing_thread_stats {
+    uint64_t num_jobs;    ///< Number of jobs the thread took part in.
+    uint64_t num_tasks;   ///< Number of processed tasks.
+    uint64_t num_batches; ///< Number of processed batches.
+
+    uint64_t busy_ns; ///< Time spent processing tasks.
+    uint64_t idle_ns; ///< Time spent spinning or sleeping while waiting for jobs.
+    uint64_t wake_latency_ns; ///< Time from publication of jobs until the thread started them.
+} station_concurrent_processing_thread_stats_t;
+
+/**
+ * @brief Instrumentation counters of a concurrent processing context.
+ *
+ * Load imbalance of a job is the ratio of the largest busy time of a thread
+ * to the average busy time of threads (1 means perfect balance).
+ */
+typedef struct station_concurrent_processing_stats {
+    uint64_t num_jobs; ///< Number of completed jobs.
+    uint64_t tail_ns;  ///< Total time from the first thread finishing a job until the last one.
+
+    double last_imbalance; ///< Load imbalance of the last completed job.
+    double mean_imbalance; ///< Average load imbalance of completed jobs.
+} station_concurrent_processing_stats_t;
+
+/**
+ * @brief Options of concurrent processing context initialization.
+ *
+ * Zero-initialized options mean no busy-waiting, no spinning and no pinning.
+ */
+typedef struct station_concurrent_processing_context_options {
+    bool busy_wait; ///< Whether busy-waiting is enabled.
+    uint32_t spin_count; ///< Number of spins before blocking, if busy-waiting is disabled.
+    const station_cpu_idx_t *thread_cpus; ///< CPUs to pin threads to, or NULL.
+} station_concurrent_processing_context_options_t;
+
 /**
  * @brief Concurrent processing context.
  */
 typedef struct station_concurrent_processing_context {
     struct station_concurrent_processing_threads_state *state; ///< State of concurrent processing threads.
-    station_threads_number_t num_threads; ///< Number of concurrent processing threads.
+    station_threads_number_t num_threads; ///< Number of active concurrent processing threads (share of them if shared).
+    station_threads_number_t max_num_threads; ///< Number of created threads, upper bound of num_threads.
     bool busy_wait; ///< Whether busy-waiting is enabled.
+    uint32_t spin_count; ///< Number of spins before blocking, if busy-waiting is disabled.
+    const station_cpu_idx_t *thread_cpus; ///< CPUs threads are pinned to (negative if not pinned), or NULL.
+    const station_numa_node_idx_t *thread_nodes; ///< NUMA nodes of pinned threads (negative if unknown), or NULL.
+
+    station_concurrent_processing_schedule_t schedule; ///< Scheduling mode used by subsequent executes.
+    bool caller_participation; ///< Whether calling thread processes tasks of blocking executes.
+    uint64_t time_budget_ns; ///< Time after which subsequent executes stop acquiring batches (0 if unlimited).
+    int notification_fd; ///< File descriptor signaled on completion of subsequent non-blocking jobs (negative if none).
+    size_t arena_size; ///< Size of per-thread scratch arenas (0 if there are none).
+    bool shared; ///< Whether threads are borrowed from another context.
 } station_concurrent_processing_context_t;
 
 /**
@@ -29,6 +29,8 @@
 #include <stdint.h>
 #include <stdbool.h>
 
+#include <station/concurrent.typ.h>
+
 struct station_sdl_window_context;
 struct station_sdl_window_properties;
 
@@ -93,6 +95,26 @@ station_sdl_window_unlock_texture_and_render(
         struct station_sdl_window_context *context ///< [in,out] Context.
 );
 
+/**
+ * @brief Describe locked rectangle of window texture as a 2D iteration domain.
+ *
+ * Origin and extent of the domain are set to the locked rectangle,
+ * so coordinates of tiles are texture coordinates, and pixel (x, y) of a tile is
+ * lock.pixels[(y - lock.rectangle.y) * lock.pitch + (x - lock.rectangle.x)].
+ *
+ * @return True if texture is locked, false if it is not or SDL is not supported.
+ */
+bool
+station_sdl_window_texture_domain(
+        const struct station_sdl_window_context *context, ///< [in] Context.
+
+        uint32_t tile_width,  ///< [in] Tile width in pixels.
+        uint32_t tile_height, ///< [in] Tile height in pixels.
+        station_concurrent_processing_tile_order_t tile_order, ///< [in] Order of tiles.
+
+        station_concurrent_processing_domain_t *domain ///< [out] Iteration domain.
+);
+
 /**
  * @brief Draw glyph on window texture.
  *
@@ -72,6 +72,7 @@
 #include <station/shared_memory.fun.h>
 
 #include <station/concurrent.fun.h>
+#include <station/concurrent.def.h>
 
 #include <station/opencl.typ.h>
 #include <station/sdl.typ.h>
@@ -309,7 +310,7 @@ static struct argp_option args_options[] = {
     {.name = "library", .key = ARGKEY_LIBRARY, .arg = "PATH", .doc = "Open shared library"},
 #endif
 #ifdef STATION_IS_CONCURRENT_PROCESSING_SUPPORTED
-    {.name = "threads", .key = ARGKEY_THREADS, .arg = "[±]THREADS", .doc = " Create concurrent processing context\n(+: wait on condition variable, -: busy-wait)"},
+    {.name = "threads", .key = ARGKEY_THREADS, .arg = "[±]THREADS", .doc = " Create concurrent processing context\n(+/-: condvar/busy-wait, :[SPIN]: hybrid, @CPUS)"},
 #endif
 #ifdef STATION_IS_OPENCL_SUPPORTED
     {.name = "cl-context", .key = ARGKEY_CL_CONTEXT, .arg = "PID[:DMASK]", .doc = "Create OpenCL context\n(PID: platform index, DMASK: device mask)"},
@@ -393,6 +394,9 @@ struct application_args
     unsigned threads_given;
     unsigned threads_cur;
     long *threads_arg;
+    uint32_t *threads_spin_arg;
+    char **threads_cpus_arg;
+    bool *threads_shared_arg;
 
     unsigned cl_context_given;
     unsigned cl_context_cur;
@@ -518,6 +522,7 @@ static void exit_unload_plugin(void);
 static void exit_stop_signal_management_thread(void);
 #endif
 
+static void print_concurrent_processing_stats(size_t context_idx);
 static void exit_destroy_concurrent_processing_contexts(void);
 
 #ifdef STATION_IS_SDL_SUPPORTED
@@ -554,6 +559,9 @@ static void exit_end_plugin_exec_fn_output(void);
 static error_t args_parse_1(int key, char *arg, struct argp_state *state);
 static error_t args_parse_2(int key, char *arg, struct argp_state *state);
 
+static bool parse_thread_cpus(const char *cpus,
+        station_threads_number_t num_threads, station_cpu_idx_t *thread_cpus);
+
 /*****************************************************************************/
 
 #ifdef STATION_IS_OPENCL_SUPPORTED
@@ -1331,8 +1339,19 @@ static void initialize(int argc, char *argv[])
                 PRINT_("  [" COLOR_NUMBER "%lu" COLOR_RESET "]: ", (unsigned long)i);
 
                 int threads = application.args.threads_arg[i];
+                uint32_t spin_count = application.args.threads_spin_arg[i];
 
-                if (threads > 0)
+                if (application.args.threads_shared_arg[i])
+                    PRINT_(COLOR_NUMBER "%i" COLOR_RESET " thread%s shared with context ["
+                            COLOR_NUMBER "0" COLOR_RESET "]\n", threads, threads > 1 ? "s" : "");
+                else if ((threads > 0) && (spin_count == STATION_CONCURRENT_PROCESSING_SPIN_ADAPTIVE))
+                    PRINT_(COLOR_NUMBER "%i" COLOR_RESET " thread%s (adaptive spinning, then waiting on condition variable)\n",
+                            threads, threads > 1 ? "s" : "");
+                else if ((threads > 0) && (spin_count > 0))
+                    PRINT_(COLOR_NUMBER "%i" COLOR_RESET " thread%s (spinning " COLOR_NUMBER "%lu" COLOR_RESET
+                            " times, then waiting on condition variable)\n",
+                            threads, threads > 1 ? "s" : "", (unsigned long)spin_count);
+                else if (threads > 0)
                     PRINT_(COLOR_NUMBER "%i" COLOR_RESET " thread%s (waiting on condition variable)\n",
                             threads, threads > 1 ? "s" : "");
                 else if (threads < 0)
@@ -1340,6 +1359,10 @@ static void initialize(int argc, char *argv[])
                             -threads, -threads > 1 ? "s" : "");
                 else
                     PRINT("no threads\n");
+
+                if ((threads != 0) && (application.args.threads_cpus_arg[i] != NULL))
+                    PRINT_("       pinned to CPUs: " COLOR_STRING "%s" COLOR_RESET "\n",
+                            application.args.threads_cpus_arg[i]);
             }
         }
 
@@ -1775,6 +1798,28 @@ static void initialize(int argc, char *argv[])
 
         for (size_t i = 0; i < application.concurrent_processing.contexts.num_contexts; i++)
         {
+            if (application.args.threads_shared_arg[i])
+            {
+                // Use threads of the first context
+                int code = -1;
+
+                if (i > 0)
+                    code = station_concurrent_processing_initialize_shared_context(
+                            &application.concurrent_processing.contexts.contexts[i],
+                            &application.concurrent_processing.contexts.contexts[0],
+                            application.args.threads_arg[i]);
+
+                if (code != 0)
+                {
+                    ERROR_("couldn't create concurrent processing context ["
+                            COLOR_NUMBER "%lu" COLOR_RESET "] sharing threads, got error "
+                            COLOR_ERROR "%i" COLOR_RESET, (unsigned long)i, code);
+                    exit(STATION_APP_ERROR_THREADS);
+                }
+
+                continue;
+            }
+
             station_threads_number_t num_threads;
             bool busy_wait;
 
@@ -1789,9 +1834,54 @@ static void initialize(int argc, char *argv[])
                 busy_wait = true;
             }
 
-            int code = station_concurrent_processing_initialize_context(
-                    &application.concurrent_processing.contexts.contexts[i],
-                    num_threads, busy_wait);
+            // Compute placement of threads on CPUs
+            const char *cpus = application.args.threads_cpus_arg[i];
+            station_cpu_idx_t *thread_cpus = NULL;
+
+            if ((cpus != NULL) && (num_threads > 0))
+            {
+                thread_cpus = malloc(sizeof(*thread_cpus) * num_threads);
+                if (thread_cpus == NULL)
+                {
+                    ERROR("couldn't allocate array of thread CPUs");
+                    perror("malloc()");
+                    exit(STATION_APP_ERROR_MALLOC);
+                }
+
+                bool placed;
+
+                if (strcmp(cpus, "compact") == 0)
+                    placed = station_concurrent_processing_place_threads(
+                            STATION_CONCURRENT_PROCESSING_PLACEMENT_COMPACT, num_threads, thread_cpus);
+                else if (strcmp(cpus, "scatter") == 0)
+                    placed = station_concurrent_processing_place_threads(
+                            STATION_CONCURRENT_PROCESSING_PLACEMENT_SCATTER, num_threads, thread_cpus);
+                else if (strcmp(cpus, "physical") == 0)
+                    placed = station_concurrent_processing_place_threads(
+                            STATION_CONCURRENT_PROCESSING_PLACEMENT_PHYSICAL, num_threads, thread_cpus);
+                else
+                    placed = parse_thread_cpus(cpus, num_threads, thread_cpus);
+
+                if (!placed)
+                {
+                    free(thread_cpus);
+
+                    ERROR_("couldn't compute placement of threads on CPUs for concurrent processing context ["
+                            COLOR_NUMBER "%lu" COLOR_RESET "]", (unsigned long)i);
+                    exit(STATION_APP_ERROR_THREADS);
+                }
+            }
+
+            station_concurrent_processing_context_options_t options = {
+                .busy_wait = busy_wait,
+                .spin_count = application.args.threads_spin_arg[i],
+                .thread_cpus = thread_cpus,
+            };
+
+            int code = station_concurrent_processing_initialize_context_with_options(
+                    &application.concurrent_processing.contexts.contexts[i], num_threads, &options);
+
+            free(thread_cpus);
 
             if (code != 0)
             {
@@ -1880,6 +1970,9 @@ static void exit_release_args(void)
     free(application.args.shm_ptrs_arg);
     free(application.args.library_arg);
     free(application.args.threads_arg);
+    free(application.args.threads_spin_arg);
+    free(application.args.threads_cpus_arg);
+    free(application.args.threads_shared_arg);
     free(application.args.cl_context_arg);
     free(application.args.SIGRTMIN_arg);
     free(application.args.SIGRTMAX_arg);
@@ -1903,13 +1996,58 @@ static void exit_stop_signal_management_thread(void)
 }
 #endif
 
+static void print_concurrent_processing_stats(size_t context_idx)
+{
+    station_concurrent_processing_context_t *context =
+        &application.concurrent_processing.contexts.contexts[context_idx];
+
+    station_concurrent_processing_stats_t stats;
+    if (!station_concurrent_processing_get_stats(context, &stats))
+        return;
+
+    PRINT_("Concurrent processing context [" COLOR_NUMBER "%lu" COLOR_RESET "]: "
+            COLOR_NUMBER "%llu" COLOR_RESET " jobs, tail time "
+            COLOR_NUMBER "%llu" COLOR_RESET " ns, load imbalance "
+            COLOR_NUMBER "%.3f" COLOR_RESET " (mean), "
+            COLOR_NUMBER "%.3f" COLOR_RESET " (last)\n",
+            (unsigned long)context_idx, (unsigned long long)stats.num_jobs,
+            (unsigned long long)stats.tail_ns, stats.mean_imbalance, stats.last_imbalance);
+
+    for (station_threads_number_t i = 0; i <= context->max_num_threads; i++)
+    {
+        station_concurrent_processing_thread_stats_t thread_stats;
+        if (!station_concurrent_processing_get_thread_stats(context, i, &thread_stats) ||
+                (thread_stats.num_jobs == 0))
+            continue;
+
+        PRINT_("  thread [" COLOR_NUMBER "%lu" COLOR_RESET "]: "
+                COLOR_NUMBER "%llu" COLOR_RESET " jobs, "
+                COLOR_NUMBER "%llu" COLOR_RESET " tasks, "
+                COLOR_NUMBER "%llu" COLOR_RESET " batches, busy "
+                COLOR_NUMBER "%llu" COLOR_RESET " ns, idle "
+                COLOR_NUMBER "%llu" COLOR_RESET " ns, wake-up latency "
+                COLOR_NUMBER "%llu" COLOR_RESET " ns (mean)\n",
+                (unsigned long)i, (unsigned long long)thread_stats.num_jobs,
+                (unsigned long long)thread_stats.num_tasks,
+                (unsigned long long)thread_stats.num_batches,
+                (unsigned long long)thread_stats.busy_ns,
+                (unsigned long long)thread_stats.idle_ns,
+                (unsigned long long)(thread_stats.wake_latency_ns / thread_stats.num_jobs));
+    }
+}
+
 static void exit_destroy_concurrent_processing_contexts(void)
 {
     EXIT_ASSERT_MAIN_THREAD();
 
     if (application.concurrent_processing.contexts.contexts != NULL)
         for (size_t i = 0; i < application.concurrent_processing.contexts.num_contexts; i++)
+        {
+            if (application.verbose)
+                print_concurrent_processing_stats(i);
+
             station_concurrent_processing_destroy_context(&application.concurrent_processing.contexts.contexts[i]);
+        }
 
     free(application.concurrent_processing.contexts.contexts);
 }
@@ -2378,6 +2516,30 @@ static error_t args_parse_2(int key, char *arg, struct argp_state *state)
                     perror("malloc()");
                     return ENOMEM;
                 }
+
+                args->threads_spin_arg = malloc(sizeof(*args->threads_spin_arg) * args->threads_given);
+                if (args->threads_spin_arg == NULL)
+                {
+                    ERROR("couldn't allocate array of concurrent processing context arguments");
+                    perror("malloc()");
+                    return ENOMEM;
+                }
+
+                args->threads_cpus_arg = malloc(sizeof(*args->threads_cpus_arg) * args->threads_given);
+                if (args->threads_cpus_arg == NULL)
+                {
+                    ERROR("couldn't allocate array of concurrent processing context arguments");
+                    perror("malloc()");
+                    return ENOMEM;
+                }
+
+                args->threads_shared_arg = malloc(sizeof(*args->threads_shared_arg) * args->threads_given);
+                if (args->threads_shared_arg == NULL)
+                {
+                    ERROR("couldn't allocate array of concurrent processing context arguments");
+                    perror("malloc()");
+                    return ENOMEM;
+                }
             }
 
             if (args->cl_context_given > 0)
@@ -2431,13 +2593,94 @@ static error_t args_parse_2(int key, char *arg, struct argp_state *state)
             break;
 
         case ARGKEY_THREADS:
-            errno = 0;
-            args->threads_arg[args->threads_cur++] = strtol(arg, (char**)NULL, 10);
-            if (errno != 0)
+            if (arg[0] == '=')
             {
-                ERROR_("couldn't parse number of threads from '%s'", arg);
-                perror("strtol()");
-                return EINVAL;
+                // Share of threads of the first context
+                char *share_end;
+
+                errno = 0;
+                unsigned long share = strtoul(arg + 1, &share_end, 10);
+                if ((errno != 0) || (share_end == arg + 1) || (*share_end != '\0') ||
+                        (share == 0) || (share > (station_threads_number_t)-1))
+                {
+                    ERROR_("couldn't parse share of threads from '%s'", arg);
+                    return EINVAL;
+                }
+
+                args->threads_arg[args->threads_cur] = share;
+                args->threads_spin_arg[args->threads_cur] = 0;
+                args->threads_cpus_arg[args->threads_cur] = NULL;
+                args->threads_shared_arg[args->threads_cur] = true;
+
+                args->threads_cur++;
+            }
+            else
+            {
+                // Separate CPU list or placement policy
+                char *cpus = strchr(arg, '@');
+
+                if (cpus != NULL)
+                {
+                    *cpus++ = '\0';
+
+                    if ((strcmp(cpus, "compact") != 0) && (strcmp(cpus, "scatter") != 0) &&
+                            (strcmp(cpus, "physical") != 0) && !parse_thread_cpus(cpus, 0, NULL))
+                    {
+                        ERROR_("couldn't parse CPU list or placement policy from '%s'", cpus);
+                        return EINVAL;
+                    }
+                }
+
+                args->threads_cpus_arg[args->threads_cur] = cpus;
+                args->threads_shared_arg[args->threads_cur] = false;
+
+                char *threads_end;
+
+                errno = 0;
+                args->threads_arg[args->threads_cur] = strtol(arg, &threads_end, 10);
+                if (errno != 0)
+                {
+                    ERROR_("couldn't parse number of threads from '%s'", arg);
+                    perror("strtol()");
+                    return EINVAL;
+                }
+
+                args->threads_spin_arg[args->threads_cur] = 0;
+
+                if (*threads_end == ':')
+                {
+                    if (args->threads_arg[args->threads_cur] < 0)
+                    {
+                        ERROR_("spin count is not applicable to busy-waiting threads in '%s'", arg);
+                        return EINVAL;
+                    }
+
+                    if (threads_end[1] == '\0')
+                        args->threads_spin_arg[args->threads_cur] =
+                            STATION_CONCURRENT_PROCESSING_SPIN_ADAPTIVE;
+                    else
+                    {
+                        char *spin_end;
+
+                        errno = 0;
+                        unsigned long spin_count = strtoul(threads_end + 1, &spin_end, 10);
+                        if ((errno != 0) || (*spin_end != '\0') ||
+                                (spin_count >= STATION_CONCURRENT_PROCESSING_SPIN_ADAPTIVE))
+                        {
+                            ERROR_("couldn't parse spin count from '%s'", arg);
+                            return EINVAL;
+                        }
+
+                        args->threads_spin_arg[args->threads_cur] = spin_count;
+                    }
+                }
+                else if (*threads_end != '\0')
+                {
+                    ERROR_("couldn't parse number of threads from '%s'", arg);
+                    return EINVAL;
+                }
+
+                args->threads_cur++;
             }
             break;
 
@@ -2471,6 +2714,53 @@ static error_t args_parse_2(int key, char *arg, struct argp_state *state)
     return 0;
 }
 
+static bool parse_thread_cpus(const char *cpus,
+        station_threads_number_t num_threads, station_cpu_idx_t *thread_cpus)
+{
+    // CPU list is like "0,2,4-7", threads are assigned to listed CPUs cyclically
+    station_threads_number_t thread_idx = 0;
+
+    do
+    {
+        const char *str = cpus;
+
+        for (;;)
+        {
+            char *end;
+
+            errno = 0;
+            long first = strtol(str, &end, 10);
+            if ((errno != 0) || (end == str) || (first < 0) || (first > INT32_MAX))
+                return false;
+
+            long last = first;
+
+            if (*end == '-')
+            {
+                str = end + 1;
+
+                errno = 0;
+                last = strtol(str, &end, 10);
+                if ((errno != 0) || (end == str) || (last < first) || (last > INT32_MAX))
+                    return false;
+            }
+
+            for (long cpu = first; (cpu <= last) && (thread_idx < num_threads); cpu++)
+                thread_cpus[thread_idx++] = cpu;
+
+            if (*end == '\0')
+                break;
+            else if (*end != ',')
+                return false;
+
+            str = end + 1;
+        }
+    }
+    while (thread_idx < num_threads);
+
+    return true;
+}
+
 /*****************************************************************************/
 
 #ifdef STATION_IS_OPENCL_SUPPORTED
@@ -22,6 +22,10 @@
  * @brief Library implementation.
  */
 
+#if defined(STATION_IS_CONCURRENT_PROCESSING_SUPPORTED) && defined(__linux__)
+#  define _GNU_SOURCE // for sched_setaffinity()
+#endif
+
 #include <stdio.h>
 #include <stdlib.h>
 #include <stddef.h>
@@ -38,6 +42,18 @@
 #ifdef STATION_IS_CONCURRENT_PROCESSING_SUPPORTED
 #  include <threads.h>
 #  include <stdatomic.h>
+#  include <unistd.h> // for sysconf()
+#  include <time.h> // for clock_gettime(), timespec_get()
+#  include <sys/mman.h> // for mmap()
+#  include <errno.h>
+#  ifdef __linux__
+#    include <sched.h>
+#    include <dirent.h>
+#    include <sys/eventfd.h>
+#    define STATION_IS_THREAD_AFFINITY_SUPPORTED
+#    define STATION_IS_EVENTFD_SUPPORTED
+#    define STATION_IS_MONOTONIC_CLOCK_SUPPORTED
+#  endif
 #endif
 
 #ifdef STATION_IS_SIGNAL_MANAGEMENT_SUPPORTED
@@ -61,6 +77,7 @@
 
 #include <station/concurrent.fun.h>
 #include <station/concurrent.typ.h>
+#include <station/concurrent.def.h>
 
 #include <station/signal.fun.h>
 #include <station/signal.typ.h>
@@ -161,46 +178,255 @@ station_buffer_clear(
 
 #ifdef STATION_IS_CONCURRENT_PROCESSING_SUPPORTED
 
+#define CACHE_LINE_SIZE 64
+
+// Bounds of adaptive spin budget
+#define SPIN_BUDGET_MIN 64
+#define SPIN_BUDGET_MAX (1 << 20)
+#define SPIN_BUDGET_INITIAL 4096
+
+// Chunk of guided schedule is number of remaining tasks divided by (GUIDED_CHUNK_DIVISOR * threads)
+#define GUIDED_CHUNK_DIVISOR 2
+
+// Parameters of adaptive schedule
+#define ADAPTIVE_BATCH_NS 20000 // target duration of a batch in nanoseconds
+#define ADAPTIVE_BATCHES_PER_THREAD 4 // minimum number of batches per thread for load balancing
+#define ADAPTIVE_NUM_TASK_COSTS 16 // number of processing functions with remembered task costs
+
+// Number of active threads and index of the first job processed by them, packed into a single integer
+#define ACTIVE_THREADS(num_threads, first_job) (((uint_least64_t)(first_job) << 16) | (num_threads))
+#define ACTIVE_THREADS_NUMBER(active) ((station_threads_number_t)((active) & 0xFFFF))
+#define ACTIVE_THREADS_FIRST_JOB(active) ((active) >> 16)
+
+// Number of threads or nodes arriving at a node of combining trees of barriers and completion of jobs
+#define TREE_FAN_IN 4
+
+// Number of threads in a group woken by its leader (the first thread of the group)
+#define WAKE_GROUP_SIZE 8
+
+// Fixed-point scale of load imbalance ratios in instrumentation counters
+#define IMBALANCE_SCALE 1000000
+
+// Size of huge pages backing scratch arenas
+#define ARENA_HUGE_PAGE_SIZE (1 << 21)
+
 struct station_concurrent_processing_assignment {
-    station_pfunc_t pfunc;
-    void *pfunc_data;
+    station_pfunc_range_t pfunc_range;
+    void *pfunc_range_data;
+
+    struct {
+        station_pfunc_t pfunc;
+        station_pfunc_range64_t pfunc_range64;
+        void *pfunc_data;
+
+        station_tasks_number64_t num_tasks; // for pfunc_range64
+        station_tasks_number64_t block_size; // number of 64-bit tasks per task
+    } pfunc_adapter; // processing function called by station_concurrent_processing_pfunc_*_adapter()
 
     station_pfunc_callback_t callback;
     void *callback_data;
 
+    void (*finish)(void *data, station_thread_idx_t thread_idx,
+            station_threads_number_t num_threads); // called by every participating thread after its last task
+    void *finish_data;
+
+    void (*cost_key)(void); // processing function which task cost is measured in adaptive mode
+
+    uint_least64_t handle; // handle of the job
+    uint_least64_t deadline_ns; // time after which no batches are acquired, or 0
+    bool uncancellable; // whether cancellation and time budget are ignored
+
     station_tasks_number_t num_tasks;
     station_tasks_number_t batch_size;
 
-    bool use_pong_cnd;
+    station_threads_number_t num_threads; // number of participating threads
+    station_concurrent_processing_schedule_t schedule;
+    bool fixed_schedule; // whether schedule is not taken from context
+};
+
+static
+STATION_PFUNC_RANGE(station_concurrent_processing_pfunc_adapter)
+{
+    const struct station_concurrent_processing_assignment *assignment = data;
+
+    for (station_task_idx_t task_idx = task_idx_begin; task_idx < task_idx_end; task_idx++)
+        assignment->pfunc_adapter.pfunc(assignment->pfunc_adapter.pfunc_data, task_idx, thread_idx);
+}
+
+static
+STATION_PFUNC_RANGE(station_concurrent_processing_pfunc_range64_adapter)
+{
+    const struct station_concurrent_processing_assignment *assignment = data;
+
+    // Every task is a block of 64-bit tasks, the last block may be incomplete
+    station_task_idx64_t begin = task_idx_begin * assignment->pfunc_adapter.block_size;
+    station_task_idx64_t end = task_idx_end * assignment->pfunc_adapter.block_size;
+
+    if (end > assignment->pfunc_adapter.num_tasks)
+        end = assignment->pfunc_adapter.num_tasks;
+
+    assignment->pfunc_adapter.pfunc_range64(assignment->pfunc_adapter.pfunc_data, begin, end, thread_idx);
+}
+
+// Check if assignment data must point to the assignment itself
+static
+bool
+station_concurrent_processing_is_adapter(
+        station_pfunc_range_t pfunc_range)
+{
+    return (pfunc_range == station_concurrent_processing_pfunc_adapter) ||
+        (pfunc_range == station_concurrent_processing_pfunc_range64_adapter);
+}
+
+// Range of tasks [begin; end) packed into a single integer for atomic access
+#define TASK_RANGE(begin, end) (((uint_least64_t)(end) << 32) | (uint_least64_t)(begin))
+#define TASK_RANGE_BEGIN(range) ((station_task_idx_t)((range) & 0xFFFFFFFF))
+#define TASK_RANGE_END(range) ((station_task_idx_t)((range) >> 32))
+
+struct station_concurrent_processing_thread_range {
+    _Alignas(CACHE_LINE_SIZE) atomic_uint_least64_t range; // not yet processed tasks of a thread
+};
+
+struct station_concurrent_processing_job {
+    struct station_concurrent_processing_assignment assignment;
+    struct station_concurrent_processing_thread_range *ranges; // for work-stealing mode
+    struct station_concurrent_processing_tree_node *arrival_nodes; // for completion, or NULL if counter is used
+
+    atomic_uint_least64_t handle; // handle of the last job in the slot
+    atomic_uint_least64_t cancelled; // largest handle of a cancelled job in the slot
+    atomic_uint_least64_t completed; // handle of the last completed job in the slot
+    atomic_int notification_fd; // file descriptor signaled on completion, or negative
+    atomic_ushort num_workers; // number of threads processing the job, not counting the calling thread
+
+    _Alignas(CACHE_LINE_SIZE) atomic_uint_least64_t done_tasks; // wide enough not to wrap around
+    _Alignas(CACHE_LINE_SIZE) atomic_ushort thread_counter;
+    atomic_uint_least64_t busy_ns; // total time of processing tasks by all threads in adaptive mode
+    atomic_uint processed_tasks; // number of tasks processed by all threads
+
+#ifdef STATION_IS_CONCURRENT_PROCESSING_INSTRUMENTATION_ENABLED
+    uint_least64_t submit_ns; // time of publication of the job
+    atomic_uint_least64_t max_busy_ns; // largest time of processing tasks by a thread
+    atomic_uint_least64_t first_finish_ns; // time the first thread ran out of tasks
+#endif
+};
+
+struct station_concurrent_processing_arena {
+    _Alignas(CACHE_LINE_SIZE) unsigned char *memory;
+    size_t size;
+    size_t used; // reset at the start of every job
+    size_t high_watermark;
+};
+
+#ifdef STATION_IS_CONCURRENT_PROCESSING_INSTRUMENTATION_ENABLED
+struct station_concurrent_processing_thread_counters {
+    _Alignas(CACHE_LINE_SIZE) atomic_uint_least64_t num_jobs;
+    atomic_uint_least64_t num_tasks;
+    atomic_uint_least64_t num_batches;
+    atomic_uint_least64_t busy_ns;
+    atomic_uint_least64_t idle_ns;
+    atomic_uint_least64_t wake_latency_ns;
+};
+#endif
+
+struct station_concurrent_processing_tree_node {
+    _Alignas(CACHE_LINE_SIZE) atomic_uint counter; // number of arrivals in the current episode
+};
+
+struct station_concurrent_processing_wake_group {
+    _Alignas(CACHE_LINE_SIZE) cnd_t cnd; // for threads of the group except the leader
+    mtx_t mtx;
+
+    atomic_ushort num_sleeping; // number of threads waiting on cnd
+    atomic_uint_least64_t leader_job; // index of the job the leader waits for on ping_cnd plus one, or 0
+};
+
+// Signaled by threads making progress which other threads of a job may wait for
+struct station_concurrent_processing_event {
+    _Alignas(CACHE_LINE_SIZE) atomic_uint_least64_t epoch; // number of signals received by waiters
+    atomic_uint num_waiters;
+};
+
+struct station_concurrent_processing_event_waiter {
+    bool waiting; // whether the thread is announced as a waiter
+    uint_least64_t epoch; // epoch at the moment of announcement
+};
+
+struct station_concurrent_processing_task_cost {
+    void (*key)(void); // processing function
+    double task_ns; // estimated time of processing a task in nanoseconds
 };
 
 struct station_concurrent_processing_threads_state {
     struct {
         station_threads_number_t num_threads;
         thrd_t *threads;
+        station_cpu_idx_t *thread_cpus;
+        station_numa_node_idx_t *thread_nodes;
+
+        struct station_concurrent_processing_thread_range *ranges;
 
-        atomic_flag busy;
+#ifdef STATION_IS_CONCURRENT_PROCESSING_INSTRUMENTATION_ENABLED
+        struct station_concurrent_processing_thread_counters *thread_counters; // one more for calling thread
+#endif
+
+        struct station_concurrent_processing_arena *arenas; // one per thread and one for calling thread
+        void *arenas_memory;
+        size_t arenas_memory_size;
 
-        atomic_bool ping_flag;
-        atomic_bool pong_flag;
-        bool ping_sense;
-        bool pong_sense;
+        struct station_concurrent_processing_tree_node *arrival_nodes; // combining trees of jobs, or NULL
+
+        struct station_concurrent_processing_wake_group *wake_groups; // or NULL if leaders don't wake groups
+        station_threads_number_t num_wake_groups; // number of initialized groups
 
         bool use_ping_cnd;
+        uint32_t spin_count; // number of spins before blocking on condition variables
         cnd_t ping_cnd;
         mtx_t ping_mtx;
 
         cnd_t pong_cnd;
         mtx_t pong_mtx;
+
+        cnd_t park_cnd; // for threads beyond the active number
+        mtx_t park_mtx;
+
+        mtx_t submit_mtx;
+        mtx_t cost_mtx;
+        mtx_t nested_mtx;
     } persistent;
 
-    bool terminate;
+    // Jobs are processed by every thread in the order of submission,
+    // so they are also completed in that order
+    _Alignas(CACHE_LINE_SIZE) atomic_uint_least64_t num_submitted;
+    atomic_uint_least64_t active; // see ACTIVE_THREADS()
+    atomic_bool terminate;
+    atomic_ushort num_sleeping; // number of threads waiting on ping_cnd (group leaders with wake groups)
+
+    _Alignas(CACHE_LINE_SIZE) atomic_uint_least64_t num_completed;
+    atomic_uint num_waiting; // number of threads waiting on pong_cnd
+    atomic_uint_least32_t spin_budget; // adaptive spin budget of waiting threads
+
+    atomic_ushort num_started; // number of threads that set their affinity
+    atomic_bool affinity_failed;
+
+    atomic_uint num_references; // number of contexts using the threads
+
+    atomic_uint num_nested; // number of nested jobs accepting help
+    struct station_concurrent_processing_nested_job *nested_jobs; // protected by nested_mtx
+
+    // Protected by cost_mtx
+    struct station_concurrent_processing_task_cost task_costs[ADAPTIVE_NUM_TASK_COSTS];
+    unsigned next_task_cost; // slot to be replaced when a new function is measured
+
+    struct station_concurrent_processing_job jobs[STATION_CONCURRENT_PROCESSING_MAX_JOBS];
 
+#ifdef STATION_IS_CONCURRENT_PROCESSING_INSTRUMENTATION_ENABLED
     struct {
-        struct station_concurrent_processing_assignment assignment;
-        atomic_uint done_tasks;
-        atomic_ushort thread_counter;
-    } current;
+        _Alignas(CACHE_LINE_SIZE) atomic_uint_least64_t num_jobs;
+        atomic_uint_least64_t tail_ns;
+        atomic_uint_least64_t total_imbalance; // scaled by IMBALANCE_SCALE
+        atomic_uint_least64_t last_imbalance; // scaled by IMBALANCE_SCALE
+    } counters;
+#endif
 };
 
 struct station_concurrent_processing_thread_arg {
@@ -208,513 +434,5560 @@ struct station_concurrent_processing_thread_arg {
     station_thread_idx_t thread_idx;
 };
 
+// Job executed from a concurrent processing function, lives on the stack of its owner
+struct station_concurrent_processing_nested_job {
+    struct station_concurrent_processing_assignment assignment;
+    struct station_concurrent_processing_nested_job *prev, *next; // protected by nested_mtx
+
+    _Alignas(CACHE_LINE_SIZE) atomic_uint_least64_t done_tasks; // wide enough not to wrap around
+    atomic_uint num_helpers; // threads processing batches of the job besides its owner
+};
+
+// Threads and index of the calling thread while it processes a job, for detection of nested executes
+static _Thread_local struct station_concurrent_processing_threads_state *station_concurrent_processing_current_state;
+static _Thread_local station_thread_idx_t station_concurrent_processing_current_thread_idx;
+static _Thread_local station_threads_number_t station_concurrent_processing_current_num_threads;
+
+// Persistent job the calling thread is in, or NULL
+static _Thread_local struct station_concurrent_processing_persistent *station_concurrent_processing_current_persistent;
+// Number of threads processing the persistent job the calling thread is in
+static _Thread_local station_threads_number_t station_concurrent_processing_persistent_num_threads;
+
+// Number of nodes of combining tree for the given number of threads
 static
-int
-station_concurrent_processing_thread(
-        void *arg)
+size_t
+station_concurrent_processing_tree_num_nodes(
+        size_t num_threads)
 {
-    struct station_concurrent_processing_threads_state *threads_state;
-    station_thread_idx_t thread_idx;
+    size_t num_nodes = 0;
+
+    while (num_threads > 1)
     {
-        struct station_concurrent_processing_thread_arg *thread_arg = arg;
-        assert(thread_arg != NULL);
+        num_threads = (num_threads - 1) / TREE_FAN_IN + 1;
+        num_nodes += num_threads;
+    }
 
-        threads_state = thread_arg->threads_state;
-        thread_idx = thread_arg->thread_idx;
+    return num_nodes;
+}
 
-        free(thread_arg);
-    }
+// Arrive at nodes of combining tree level by level, until the thread is not the last at a node.
+// Returns true for the last thread arriving at the root, which happens after arrivals of all threads.
+// Counters are reset by the last threads, so the tree is ready for reuse when the root is reached.
+static
+bool
+station_concurrent_processing_tree_arrive(
+        struct station_concurrent_processing_tree_node *nodes,
+        size_t num_threads,
+        size_t thread_idx)
+{
+    size_t num_arrivals = num_threads; // number of threads or nodes arriving at the current level
+    size_t arrival_idx = thread_idx;
+    struct station_concurrent_processing_tree_node *level = nodes;
 
-    station_threads_number_t thread_counter_last = threads_state->persistent.num_threads - 1;
-    bool use_ping_cnd = threads_state->persistent.use_ping_cnd;
+    while (num_arrivals > 1)
+    {
+        size_t node_idx = arrival_idx / TREE_FAN_IN;
+        size_t num_nodes = (num_arrivals - 1) / TREE_FAN_IN + 1;
 
-    struct station_concurrent_processing_assignment assignment;
+        size_t node_arrivals = num_arrivals - node_idx * TREE_FAN_IN;
+        if (node_arrivals > TREE_FAN_IN)
+            node_arrivals = TREE_FAN_IN;
 
-    bool ping_sense = false, pong_sense = false;
+        if (atomic_fetch_add_explicit(&level[node_idx].counter, 1, memory_order_acq_rel) != node_arrivals - 1)
+            return false;
 
-    for (;;)
-    {
-        ping_sense = !ping_sense;
-        pong_sense = !pong_sense;
+        atomic_store_explicit(&level[node_idx].counter, 0, memory_order_relaxed);
 
-        if (use_ping_cnd)
-        {
+        level += num_nodes;
+        num_arrivals = num_nodes;
+        arrival_idx = node_idx;
+    }
+
+    return true;
+}
+
+static
+void
+station_concurrent_processing_lock(
+        mtx_t *mtx)
+{
 #ifndef NDEBUG
-            int res =
+    int res =
 #endif
-                mtx_lock(&threads_state->persistent.ping_mtx);
-            assert(res == thrd_success);
-        }
+        mtx_lock(mtx);
+    assert(res == thrd_success);
+}
 
-        // Wait until signal
-        while (atomic_load_explicit(&threads_state->persistent.ping_flag,
-                    memory_order_acquire) != ping_sense)
-        {
-            if (use_ping_cnd)
-            {
+static
+void
+station_concurrent_processing_unlock(
+        mtx_t *mtx)
+{
 #ifndef NDEBUG
-                int res =
+    int res =
 #endif
-                    cnd_wait(&threads_state->persistent.ping_cnd,
-                            &threads_state->persistent.ping_mtx);
-                assert(res == thrd_success);
-            }
-        }
+        mtx_unlock(mtx);
+    assert(res == thrd_success);
+}
+
+static
+void
+station_concurrent_processing_broadcast(
+        cnd_t *cnd,
+        mtx_t *mtx)
+{
+    station_concurrent_processing_lock(mtx);
+    cnd_broadcast(cnd);
+    station_concurrent_processing_unlock(mtx);
+}
+
+// Wake threads waiting for the submitted job. Leaders sleeping until it is submitted wake their groups
+// themselves, other groups are woken directly. With 'all' set, every group is woken.
+static
+void
+station_concurrent_processing_wake_threads(
+        struct station_concurrent_processing_threads_state *threads_state,
+        uint_least64_t job_idx,
+        bool all)
+{
+    if (!threads_state->persistent.use_ping_cnd)
+        return;
+
+    if (all || (atomic_load(&threads_state->num_sleeping) > 0))
+        station_concurrent_processing_broadcast(&threads_state->persistent.ping_cnd,
+                &threads_state->persistent.ping_mtx);
+
+    for (station_threads_number_t i = 0; i < threads_state->persistent.num_wake_groups; i++)
+    {
+        struct station_concurrent_processing_wake_group *group = &threads_state->persistent.wake_groups[i];
+
+        if (!all && (atomic_load(&group->num_sleeping) == 0))
+            continue;
+
+        // Leader waiting for a later job has passed this one, and may not wake its group
+        uint_least64_t leader_job = atomic_load(&group->leader_job);
+
+        if (all || (leader_job == 0) || (leader_job > job_idx + 1))
+            station_concurrent_processing_broadcast(&group->cnd, &group->mtx);
+    }
+}
+
+#ifdef STATION_IS_THREAD_AFFINITY_SUPPORTED
 
-        if (use_ping_cnd)
+static
+station_numa_node_idx_t
+station_concurrent_processing_cpu_numa_node(
+        station_cpu_idx_t cpu)
+{
+    char path[64];
+    snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%i", (int)cpu);
+
+    DIR *dir = opendir(path);
+    if (dir == NULL)
+        return -1;
+
+    // Directory of a CPU contains a link named after its NUMA node
+    station_numa_node_idx_t node = -1;
+    struct dirent *entry;
+
+    while ((entry = readdir(dir)) != NULL)
+    {
+        int value;
+        char end;
+
+        if ((sscanf(entry->d_name, "node%i%c", &value, &end) == 1) && (value >= 0))
         {
-#ifndef NDEBUG
-            int res =
-#endif
-                mtx_unlock(&threads_state->persistent.ping_mtx);
-            assert(res == thrd_success);
+            node = value;
+            break;
         }
+    }
+
+    closedir(dir);
+    return node;
+}
+
+#endif // STATION_IS_THREAD_AFFINITY_SUPPORTED
+
+// Result of processing tasks of a job by a thread
+struct station_concurrent_processing_progress {
+    station_tasks_number_t num_tasks;
+    station_tasks_number_t num_batches; // unused unless instrumentation is enabled
+};
+
+static
+uint_least64_t
+station_concurrent_processing_time_ns(void)
+{
+    // Durations and deadlines must not be affected by adjustments of the system time
+    struct timespec time;
+#ifdef STATION_IS_MONOTONIC_CLOCK_SUPPORTED
+    clock_gettime(CLOCK_MONOTONIC, &time);
+#else
+    timespec_get(&time, TIME_UTC);
+#endif
+
+    return time.tv_sec * (uint_least64_t)1000000000 + time.tv_nsec;
+}
+
+// Check whether threads must not acquire more batches of the job
+static
+bool
+station_concurrent_processing_is_stopped(
+        struct station_concurrent_processing_job *job,
+        const struct station_concurrent_processing_assignment *assignment)
+{
+    if (assignment->uncancellable)
+        return false;
+    else if (atomic_load_explicit(&job->cancelled, memory_order_relaxed) == assignment->handle)
+        return true;
+    else if (assignment->deadline_ns != 0)
+        return station_concurrent_processing_time_ns() >= assignment->deadline_ns;
+    else
+        return false;
+}
+
+static
+struct station_concurrent_processing_progress
+station_concurrent_processing_do_static(
+        struct station_concurrent_processing_job *job,
+        const struct station_concurrent_processing_assignment *assignment,
+        station_thread_idx_t thread_idx)
+{
+    struct station_concurrent_processing_progress progress = {0};
+
+    // Same contiguous range of tasks for the thread every time
+    station_task_idx_t begin, end;
+    if (!station_concurrent_processing_static_range(assignment->num_tasks, assignment->num_threads,
+                thread_idx, &begin, &end))
+        return progress;
+
+    while ((begin < end) && !station_concurrent_processing_is_stopped(job, assignment))
+    {
+        station_task_idx_t batch_end = (end - begin > assignment->batch_size) ?
+            begin + assignment->batch_size : end;
+
+        // Execute concurrent processing function
+        assignment->pfunc_range(assignment->pfunc_range_data, begin, batch_end, thread_idx);
+
+        progress.num_tasks += batch_end - begin;
+        progress.num_batches++;
+
+        begin = batch_end;
+    }
+
+    return progress;
+}
+
+static
+struct station_concurrent_processing_progress
+station_concurrent_processing_do_dynamic(
+        struct station_concurrent_processing_job *job,
+        const struct station_concurrent_processing_assignment *assignment,
+        station_thread_idx_t thread_idx)
+{
+    struct station_concurrent_processing_progress progress = {0};
+
+    while (!station_concurrent_processing_is_stopped(job, assignment))
+    {
+        // Acquire next batch (the counter keeps growing past the number of tasks)
+        uint_least64_t begin = atomic_fetch_add_explicit(
+                &job->done_tasks, assignment->batch_size, memory_order_relaxed);
 
-        if (threads_state->terminate)
+        if (begin >= assignment->num_tasks)
             break;
 
-        // Copy the assignment
-        assignment = threads_state->current.assignment;
+        station_task_idx_t end = (assignment->num_tasks - begin > assignment->batch_size) ?
+            begin + assignment->batch_size : assignment->num_tasks;
+
+        // Execute concurrent processing function
+        assignment->pfunc_range(assignment->pfunc_range_data, begin, end, thread_idx);
+
+        progress.num_tasks += end - begin;
+        progress.num_batches++;
+    }
+
+    return progress;
+}
+
+static
+struct station_concurrent_processing_progress
+station_concurrent_processing_do_guided(
+        struct station_concurrent_processing_job *job,
+        const struct station_concurrent_processing_assignment *assignment,
+        station_thread_idx_t thread_idx)
+{
+    uint_least64_t divisor = (uint_least64_t)assignment->num_threads * GUIDED_CHUNK_DIVISOR;
 
-        // Acquire first task
-        station_task_idx_t task_idx = atomic_fetch_add_explicit(
-                &threads_state->current.done_tasks, assignment.batch_size, memory_order_relaxed);
-        station_tasks_number_t remaining_tasks = assignment.batch_size;
+    struct station_concurrent_processing_progress progress = {0};
 
-        // Loop until no subtasks left
-        while (task_idx < assignment.num_tasks)
+    uint_least64_t begin = atomic_load_explicit(&job->done_tasks, memory_order_relaxed);
+
+    while ((begin < assignment->num_tasks) && !station_concurrent_processing_is_stopped(job, assignment))
+    {
+        // Chunks shrink as tasks run out, but not below batch size
+        station_tasks_number_t remaining = assignment->num_tasks - begin;
+        station_tasks_number_t size = remaining / divisor;
+
+        if (size < assignment->batch_size)
+            size = assignment->batch_size;
+        if (size > remaining)
+            size = remaining;
+
+        // Acquire next chunk
+        if (atomic_compare_exchange_weak_explicit(&job->done_tasks, &begin, begin + size,
+                    memory_order_relaxed, memory_order_relaxed))
         {
             // Execute concurrent processing function
-            assignment.pfunc(assignment.pfunc_data, task_idx, thread_idx);
-            remaining_tasks--;
+            assignment->pfunc_range(assignment->pfunc_range_data, begin, begin + size, thread_idx);
 
-            // Acquire next task
-            if (remaining_tasks > 0)
-                task_idx++;
-            else
+            progress.num_tasks += size;
+            progress.num_batches++;
+
+            begin = atomic_load_explicit(&job->done_tasks, memory_order_relaxed);
+        }
+    }
+
+    return progress;
+}
+
+static
+struct station_concurrent_processing_progress
+station_concurrent_processing_do_work_stealing(
+        struct station_concurrent_processing_job *job,
+        const struct station_concurrent_processing_assignment *assignment,
+        station_thread_idx_t thread_idx)
+{
+    station_threads_number_t num_threads = assignment->num_threads;
+
+    atomic_uint_least64_t *own_range = &job->ranges[thread_idx].range;
+
+    struct station_concurrent_processing_progress progress = {0};
+
+    while (!station_concurrent_processing_is_stopped(job, assignment))
+    {
+        // Acquire batches from the beginning of the own range
+        uint_least64_t range = atomic_load_explicit(own_range, memory_order_relaxed);
+
+        while (!station_concurrent_processing_is_stopped(job, assignment))
+        {
+            station_task_idx_t begin = TASK_RANGE_BEGIN(range);
+            station_task_idx_t end = TASK_RANGE_END(range);
+
+            if (begin >= end)
+                break;
+
+            station_task_idx_t batch_end = (end - begin > assignment->batch_size) ?
+                begin + assignment->batch_size : end;
+
+            if (atomic_compare_exchange_weak_explicit(own_range, &range, TASK_RANGE(batch_end, end),
+                        memory_order_relaxed, memory_order_relaxed))
             {
-                task_idx = atomic_fetch_add_explicit(
-                        &threads_state->current.done_tasks, assignment.batch_size, memory_order_relaxed);
-                remaining_tasks = assignment.batch_size;
+                // Execute concurrent processing function
+                assignment->pfunc_range(assignment->pfunc_range_data, begin, batch_end, thread_idx);
+
+                progress.num_tasks += batch_end - begin;
+                progress.num_batches++;
+
+                range = atomic_load_explicit(own_range, memory_order_relaxed);
             }
         }
 
-        // Check if the current thread is the last
-        if (atomic_fetch_add_explicit(&threads_state->current.thread_counter, 1,
-                    memory_order_acq_rel) == thread_counter_last)
+        // Steal the ending half of a remaining range of another thread
+        bool stolen = false;
+
+        for (station_threads_number_t i = 1; (i < num_threads) && !stolen; i++)
         {
-            // Wake master thread or execute callback function
-            atomic_store_explicit(&threads_state->persistent.pong_flag,
-                    pong_sense, memory_order_release);
+            station_thread_idx_t victim_idx = (thread_idx + i) % num_threads;
+            atomic_uint_least64_t *victim_range = &job->ranges[victim_idx].range;
+
+            range = atomic_load_explicit(victim_range, memory_order_relaxed);
 
-            if (assignment.callback != NULL)
-                assignment.callback(assignment.callback_data, thread_idx);
-            else if (assignment.use_pong_cnd)
+            for (;;)
             {
+                station_task_idx_t begin = TASK_RANGE_BEGIN(range);
+                station_task_idx_t end = TASK_RANGE_END(range);
+
+                if (begin >= end)
+                    break;
+
+                station_task_idx_t middle = begin + (end - begin) / 2;
+
+                if (atomic_compare_exchange_weak_explicit(victim_range, &range, TASK_RANGE(begin, middle),
+                            memory_order_relaxed, memory_order_relaxed))
                 {
-#ifndef NDEBUG
-                    int res =
-#endif
-                        mtx_lock(&threads_state->persistent.pong_mtx);
-                    assert(res == thrd_success);
-                }
-                cnd_broadcast(&threads_state->persistent.pong_cnd);
-                {
-#ifndef NDEBUG
-                    int res =
-#endif
-                        mtx_unlock(&threads_state->persistent.pong_mtx);
-                    assert(res == thrd_success);
+                    // Own range is empty, so nobody else modifies it
+                    atomic_store_explicit(own_range, TASK_RANGE(middle, end), memory_order_relaxed);
+
+                    stolen = true;
+                    break;
                 }
             }
-
-            // Threads are no longer busy
-            atomic_flag_clear_explicit(&threads_state->persistent.busy, memory_order_release);
         }
+
+        // All ranges are empty or being processed by their owners
+        if (!stolen)
+            break;
     }
 
-    return 0;
+    return progress;
 }
 
-#endif // STATION_IS_CONCURRENT_PROCESSING_SUPPORTED
-
-int
-station_concurrent_processing_initialize_context(
-        station_concurrent_processing_context_t *context,
-        station_threads_number_t num_threads,
-        bool busy_wait)
+static
+station_tasks_number_t
+station_concurrent_processing_adaptive_batch_size(
+        struct station_concurrent_processing_threads_state *threads_state,
+        const struct station_concurrent_processing_assignment *assignment)
 {
+    // Enough batches for load balancing
+    station_tasks_number_t batch_size = (assignment->num_tasks - 1) /
+        ((uint_least64_t)assignment->num_threads * ADAPTIVE_BATCHES_PER_THREAD) + 1;
+
+    double task_ns = 0;
+
+    station_concurrent_processing_lock(&threads_state->persistent.cost_mtx);
+
+    for (unsigned i = 0; i < ADAPTIVE_NUM_TASK_COSTS; i++)
+    {
+        if (threads_state->task_costs[i].key == assignment->cost_key)
+        {
+            task_ns = threads_state->task_costs[i].task_ns;
+            break;
+        }
+    }
+
+    station_concurrent_processing_unlock(&threads_state->persistent.cost_mtx);
+
+    // Batches just long enough to make scheduling overhead negligible
+    if ((task_ns > 0) && (ADAPTIVE_BATCH_NS / task_ns < batch_size))
+        batch_size = (ADAPTIVE_BATCH_NS / task_ns >= 1) ?
+            (station_tasks_number_t)(ADAPTIVE_BATCH_NS / task_ns) : 1;
+
+    // Specified batch size is the minimum
+    if (batch_size < assignment->batch_size)
+        batch_size = assignment->batch_size;
+
+    return batch_size;
+}
+
+static
+void
+station_concurrent_processing_update_task_cost(
+        struct station_concurrent_processing_threads_state *threads_state,
+        const struct station_concurrent_processing_assignment *assignment,
+        uint_least64_t busy_ns,
+        station_tasks_number_t num_processed_tasks)
+{
+    double task_ns = (double)busy_ns / num_processed_tasks;
+
+    station_concurrent_processing_lock(&threads_state->persistent.cost_mtx);
+
+    unsigned i;
+    for (i = 0; i < ADAPTIVE_NUM_TASK_COSTS; i++)
+        if (threads_state->task_costs[i].key == assignment->cost_key)
+            break;
+
+    if (i < ADAPTIVE_NUM_TASK_COSTS)
+    {
+        // Smooth out fluctuations of measured time
+        threads_state->task_costs[i].task_ns += (task_ns - threads_state->task_costs[i].task_ns) / 4;
+    }
+    else
+    {
+        // Replace the oldest function
+        i = threads_state->next_task_cost;
+        threads_state->next_task_cost = (i + 1) % ADAPTIVE_NUM_TASK_COSTS;
+
+        threads_state->task_costs[i].key = assignment->cost_key;
+        threads_state->task_costs[i].task_ns = task_ns;
+    }
+
+    station_concurrent_processing_unlock(&threads_state->persistent.cost_mtx);
+}
+
+static
+bool
+station_concurrent_processing_spin(
+        atomic_uint_least64_t *counter,
+        uint_least64_t value,
+        uint32_t *spin_budget,
+        bool adaptive)
+{
+    uint32_t budget = *spin_budget;
+
+    for (uint32_t i = 0; i < budget; i++)
+    {
+        if (atomic_load_explicit(counter, memory_order_acquire) >= value)
+        {
+            // Waiting is short, spin longer next time
+            if (adaptive && (budget < SPIN_BUDGET_MAX))
+                *spin_budget = budget * 2;
+
+            return true;
+        }
+    }
+
+    // Waiting is long, don't waste time spinning next time
+    if (adaptive && (budget > SPIN_BUDGET_MIN))
+        *spin_budget = budget / 2;
+
+    return false;
+}
+
+static
+void
+station_concurrent_processing_wait_for_jobs(
+        struct station_concurrent_processing_threads_state *threads_state,
+        uint_least64_t num_jobs,
+        bool busy_wait)
+{
+    if (atomic_load_explicit(&threads_state->num_completed, memory_order_acquire) >= num_jobs)
+        return;
+
+    if (busy_wait)
+    {
+        while (atomic_load_explicit(&threads_state->num_completed, memory_order_acquire) < num_jobs);
+    }
+    else
+    {
+        if (threads_state->persistent.spin_count > 0)
+        {
+            bool adaptive = (threads_state->persistent.spin_count ==
+                    STATION_CONCURRENT_PROCESSING_SPIN_ADAPTIVE);
+
+            uint32_t spin_budget = adaptive ? atomic_load_explicit(&threads_state->spin_budget,
+                    memory_order_relaxed) : threads_state->persistent.spin_count;
+
+            bool done = station_concurrent_processing_spin(&threads_state->num_completed,
+                    num_jobs, &spin_budget, adaptive);
+
+            if (adaptive)
+                atomic_store_explicit(&threads_state->spin_budget, spin_budget, memory_order_relaxed);
+
+            if (done)
+                return;
+        }
+
+        station_concurrent_processing_lock(&threads_state->persistent.pong_mtx);
+        atomic_fetch_add(&threads_state->num_waiting, 1);
+
+        while (atomic_load(&threads_state->num_completed) < num_jobs)
+        {
+#ifndef NDEBUG
+            int res =
+#endif
+                cnd_wait(&threads_state->persistent.pong_cnd,
+                        &threads_state->persistent.pong_mtx);
+            assert(res == thrd_success);
+        }
+
+        atomic_fetch_sub_explicit(&threads_state->num_waiting, 1, memory_order_relaxed);
+        station_concurrent_processing_unlock(&threads_state->persistent.pong_mtx);
+    }
+}
+
+// Wait until the counter reaches the value, in the same way as for completion of jobs
+static
+void
+station_concurrent_processing_wait_for_counter(
+        struct station_concurrent_processing_threads_state *threads_state,
+        atomic_uint_least64_t *counter,
+        uint_least64_t value,
+        bool busy_wait)
+{
+    if (busy_wait)
+    {
+        while (atomic_load_explicit(counter, memory_order_acquire) < value);
+        return;
+    }
+
+    if (threads_state->persistent.spin_count > 0)
+    {
+        bool adaptive = (threads_state->persistent.spin_count ==
+                STATION_CONCURRENT_PROCESSING_SPIN_ADAPTIVE);
+
+        uint32_t spin_budget = adaptive ? atomic_load_explicit(&threads_state->spin_budget,
+                memory_order_relaxed) : threads_state->persistent.spin_count;
+
+        bool done = station_concurrent_processing_spin(counter, value, &spin_budget, adaptive);
+
+        if (adaptive)
+            atomic_store_explicit(&threads_state->spin_budget, spin_budget, memory_order_relaxed);
+
+        if (done)
+            return;
+    }
+
+    // Threads waiting for counters share condition variable and counter of waiters with waiting for jobs
+    station_concurrent_processing_lock(&threads_state->persistent.pong_mtx);
+    atomic_fetch_add(&threads_state->num_waiting, 1);
+
+    while (atomic_load(counter) < value)
+    {
+#ifndef NDEBUG
+        int res =
+#endif
+            cnd_wait(&threads_state->persistent.pong_cnd,
+                    &threads_state->persistent.pong_mtx);
+        assert(res == thrd_success);
+    }
+
+    atomic_fetch_sub_explicit(&threads_state->num_waiting, 1, memory_order_relaxed);
+    station_concurrent_processing_unlock(&threads_state->persistent.pong_mtx);
+}
+
+// Wake threads waiting for counters and completion of jobs
+static
+void
+station_concurrent_processing_wake_waiting(
+        struct station_concurrent_processing_threads_state *threads_state)
+{
+    if (atomic_load(&threads_state->num_waiting) > 0)
+        station_concurrent_processing_broadcast(&threads_state->persistent.pong_cnd,
+                &threads_state->persistent.pong_mtx);
+}
+
+static
+void
+station_concurrent_processing_event_init(
+        struct station_concurrent_processing_event *event)
+{
+    atomic_init(&event->epoch, 0);
+    atomic_init(&event->num_waiters, 0);
+}
+
+// Called by a thread which found no work. The first call announces the thread as a waiter,
+// so that the caller checks for work once more, the next one waits for a signal
+static
+void
+station_concurrent_processing_event_idle(
+        struct station_concurrent_processing_threads_state *threads_state,
+        struct station_concurrent_processing_event *event,
+        struct station_concurrent_processing_event_waiter *waiter)
+{
+    // Busy-waiting threads check for work continuously, yielding to threads making progress
+    if (!threads_state->persistent.use_ping_cnd)
+    {
+        thrd_yield();
+        return;
+    }
+
+    if (!waiter->waiting)
+    {
+        atomic_fetch_add(&event->num_waiters, 1);
+        atomic_thread_fence(memory_order_seq_cst);
+
+        waiter->epoch = atomic_load_explicit(&event->epoch, memory_order_acquire);
+        waiter->waiting = true;
+        return;
+    }
+
+    station_concurrent_processing_wait_for_counter(threads_state, &event->epoch, waiter->epoch + 1, false);
+
+    atomic_fetch_sub_explicit(&event->num_waiters, 1, memory_order_relaxed);
+    waiter->waiting = false;
+}
+
+// Called by a thread which found work or finished
+static
+void
+station_concurrent_processing_event_busy(
+        struct station_concurrent_processing_event *event,
+        struct station_concurrent_processing_event_waiter *waiter)
+{
+    if (waiter->waiting)
+    {
+        atomic_fetch_sub_explicit(&event->num_waiters, 1, memory_order_relaxed);
+        waiter->waiting = false;
+    }
+}
+
+// Called after progress is made, which is seen by waiters checking for work after announcement
+static
+void
+station_concurrent_processing_event_signal(
+        struct station_concurrent_processing_threads_state *threads_state,
+        struct station_concurrent_processing_event *event)
+{
+    atomic_thread_fence(memory_order_seq_cst);
+
+    if (atomic_load_explicit(&event->num_waiters, memory_order_relaxed) == 0)
+        return;
+
+    atomic_fetch_add(&event->epoch, 1);
+    station_concurrent_processing_wake_waiting(threads_state);
+}
+
+#ifdef STATION_IS_CONCURRENT_PROCESSING_INSTRUMENTATION_ENABLED
+
+static
+void
+station_concurrent_processing_count_job(
+        struct station_concurrent_processing_threads_state *threads_state,
+        uint_least64_t tail_ns,
+        uint_least64_t imbalance)
+{
+    atomic_fetch_add_explicit(&threads_state->counters.num_jobs, 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&threads_state->counters.tail_ns, tail_ns, memory_order_relaxed);
+    atomic_fetch_add_explicit(&threads_state->counters.total_imbalance, imbalance, memory_order_relaxed);
+    atomic_store_explicit(&threads_state->counters.last_imbalance, imbalance, memory_order_relaxed);
+}
+
+#endif
+
+static
+void
+station_concurrent_processing_notify(
+        int fd)
+{
+    // Counter of eventfd is incremented, pipe receives the same number of bytes
+    uint64_t value = 1;
+    ssize_t res;
+
+    do
+        res = write(fd, &value, sizeof(value));
+    while ((res < 0) && (errno == EINTR));
+}
+
+static
+void
+station_concurrent_processing_complete(
+        struct station_concurrent_processing_threads_state *threads_state,
+        struct station_concurrent_processing_job *job,
+        uint_least64_t job_idx)
+{
+    atomic_store(&job->completed, job_idx + 1);
+
+    // Jobs processed by different threads (shared threads, or calling threads when
+    // there are no active ones) may complete out of order, but the counter advances
+    // only over contiguous completed jobs, after that their slots can be reused
+    uint_least64_t num_completed = atomic_load(&threads_state->num_completed);
+    bool advanced = false;
+
+    while (num_completed < atomic_load_explicit(&threads_state->num_submitted, memory_order_acquire))
+    {
+        struct station_concurrent_processing_job *next_job =
+            &threads_state->jobs[num_completed % STATION_CONCURRENT_PROCESSING_MAX_JOBS];
+
+        if (atomic_load(&next_job->completed) != num_completed + 1)
+            break;
+
+        // Read before the slot can be reused
+        int notification_fd = atomic_load_explicit(&next_job->notification_fd, memory_order_relaxed);
+
+        if (atomic_compare_exchange_weak(&threads_state->num_completed, &num_completed, num_completed + 1))
+        {
+            num_completed++;
+            advanced = true;
+
+            if (notification_fd >= 0)
+                station_concurrent_processing_notify(notification_fd);
+        }
+    }
+
+    // Wake waiting threads
+    if (advanced)
+        station_concurrent_processing_wake_waiting(threads_state);
+}
+
+static
+void
+station_concurrent_processing_arrive(
+        struct station_concurrent_processing_threads_state *threads_state,
+        struct station_concurrent_processing_job *job,
+        uint_least64_t job_idx,
+        station_thread_idx_t thread_idx)
+{
+    // Check if the current thread is the last
+    if (job->arrival_nodes != NULL)
+    {
+        if (!station_concurrent_processing_tree_arrive(job->arrival_nodes,
+                    job->assignment.num_threads, thread_idx))
+            return;
+    }
+    else if (atomic_fetch_add_explicit(&job->thread_counter, 1, memory_order_acq_rel) !=
+            job->assignment.num_threads - 1)
+        return;
+
+#ifdef STATION_IS_CONCURRENT_PROCESSING_INSTRUMENTATION_ENABLED
+    {
+        // Time from the first thread running out of tasks until the last one
+        uint_least64_t end_ns = station_concurrent_processing_time_ns();
+        uint_least64_t first_finish_ns = atomic_load_explicit(&job->first_finish_ns, memory_order_relaxed);
+
+        // Ratio of the largest busy time of a thread to the average one
+        uint_least64_t total_busy_ns = atomic_load_explicit(&job->busy_ns, memory_order_relaxed);
+        uint_least64_t imbalance = IMBALANCE_SCALE;
+
+        if (total_busy_ns > 0)
+            imbalance = (double)atomic_load_explicit(&job->max_busy_ns, memory_order_relaxed) *
+                job->assignment.num_threads / total_busy_ns * IMBALANCE_SCALE;
+
+        station_concurrent_processing_count_job(threads_state,
+                (end_ns > first_finish_ns) ? end_ns - first_finish_ns : 0, imbalance);
+    }
+#endif
+
+    // Remember task cost for subsequent executes
+    if (job->assignment.schedule == STATION_CONCURRENT_PROCESSING_SCHEDULE_ADAPTIVE)
+    {
+        station_tasks_number_t processed = atomic_load_explicit(&job->processed_tasks, memory_order_relaxed);
+
+        if (processed > 0)
+            station_concurrent_processing_update_task_cost(threads_state, &job->assignment,
+                    atomic_load_explicit(&job->busy_ns, memory_order_relaxed), processed);
+    }
+
+    // Execute callback function
+    if (job->assignment.callback != NULL)
+        job->assignment.callback(job->assignment.callback_data, thread_idx);
+
+    station_concurrent_processing_complete(threads_state, job, job_idx);
+}
+
+static
+void
+station_concurrent_processing_do_nested(
+        struct station_concurrent_processing_nested_job *nested_job,
+        station_thread_idx_t thread_idx)
+{
+    const struct station_concurrent_processing_assignment *assignment = &nested_job->assignment;
+
+    for (;;)
+    {
+        uint_least64_t begin = atomic_fetch_add_explicit(
+                &nested_job->done_tasks, assignment->batch_size, memory_order_relaxed);
+
+        if (begin >= assignment->num_tasks)
+            break;
+
+        station_task_idx_t end = (assignment->num_tasks - begin > assignment->batch_size) ?
+            begin + assignment->batch_size : assignment->num_tasks;
+
+        assignment->pfunc_range(assignment->pfunc_range_data, begin, end, thread_idx);
+    }
+}
+
+static
+bool
+station_concurrent_processing_help(
+        struct station_concurrent_processing_threads_state *threads_state,
+        station_thread_idx_t thread_idx)
+{
+    // Flat jobs never take the mutex
+    if (atomic_load_explicit(&threads_state->num_nested, memory_order_relaxed) == 0)
+        return false;
+
+    struct station_concurrent_processing_nested_job *nested_job;
+
+    station_concurrent_processing_lock(&threads_state->persistent.nested_mtx);
+
+    // Thread index must be valid for the context of the job
+    for (nested_job = threads_state->nested_jobs; nested_job != NULL; nested_job = nested_job->next)
+        if ((thread_idx < nested_job->assignment.num_threads) &&
+                (atomic_load_explicit(&nested_job->done_tasks, memory_order_relaxed) <
+                 nested_job->assignment.num_tasks))
+        {
+            atomic_fetch_add_explicit(&nested_job->num_helpers, 1, memory_order_relaxed);
+            break;
+        }
+
+    station_concurrent_processing_unlock(&threads_state->persistent.nested_mtx);
+
+    if (nested_job == NULL)
+        return false;
+
+    station_concurrent_processing_do_nested(nested_job, thread_idx);
+
+    // The owner may return as soon as the counter is zero
+    atomic_fetch_sub_explicit(&nested_job->num_helpers, 1, memory_order_release);
+    return true;
+}
+
+static
+void
+station_concurrent_processing_execute_nested(
+        struct station_concurrent_processing_threads_state *threads_state,
+        struct station_concurrent_processing_assignment assignment,
+        station_threads_number_t num_threads,
+        station_thread_idx_t thread_idx)
+{
+    struct station_concurrent_processing_nested_job nested_job = {.assignment = assignment};
+
+    nested_job.assignment.num_threads = num_threads;
+
+    if (nested_job.assignment.batch_size == 0)
+        nested_job.assignment.batch_size = (assignment.num_tasks - 1) / num_threads + 1;
+
+    if (station_concurrent_processing_is_adapter(assignment.pfunc_range))
+        nested_job.assignment.pfunc_range_data = &nested_job.assignment;
+
+    atomic_init(&nested_job.done_tasks, 0);
+    atomic_init(&nested_job.num_helpers, 0);
+
+    // Every participant of a job with finishing function must call it, so such jobs are not helped
+    bool helped = (assignment.finish == NULL);
+
+    if (helped)
+    {
+        station_concurrent_processing_lock(&threads_state->persistent.nested_mtx);
+
+        nested_job.next = threads_state->nested_jobs;
+        if (nested_job.next != NULL)
+            nested_job.next->prev = &nested_job;
+        threads_state->nested_jobs = &nested_job;
+
+        atomic_fetch_add_explicit(&threads_state->num_nested, 1, memory_order_relaxed);
+
+        station_concurrent_processing_unlock(&threads_state->persistent.nested_mtx);
+    }
+
+    station_concurrent_processing_do_nested(&nested_job, thread_idx);
+
+    if (helped)
+    {
+        // No helpers join after the job is unlinked
+        station_concurrent_processing_lock(&threads_state->persistent.nested_mtx);
+
+        if (nested_job.prev != NULL)
+            nested_job.prev->next = nested_job.next;
+        else
+            threads_state->nested_jobs = nested_job.next;
+
+        if (nested_job.next != NULL)
+            nested_job.next->prev = nested_job.prev;
+
+        atomic_fetch_sub_explicit(&threads_state->num_nested, 1, memory_order_relaxed);
+
+        station_concurrent_processing_unlock(&threads_state->persistent.nested_mtx);
+
+        // Help other nested jobs while helpers finish their batches,
+        // helped jobs are finite, so waiting always ends
+        while (atomic_load_explicit(&nested_job.num_helpers, memory_order_acquire) > 0)
+            if (!station_concurrent_processing_help(threads_state, thread_idx))
+                thrd_yield();
+    }
+    else
+    {
+        // Partial results of other thread indices are left as they were initialized
+        for (station_threads_number_t i = 0; i < num_threads; i++)
+            assignment.finish(assignment.finish_data, i, num_threads);
+    }
+}
+
+static
+void
+station_concurrent_processing_do_job(
+        struct station_concurrent_processing_threads_state *threads_state,
+        uint_least64_t job_idx,
+        station_thread_idx_t thread_idx)
+{
+    struct station_concurrent_processing_job *job =
+        &threads_state->jobs[job_idx % STATION_CONCURRENT_PROCESSING_MAX_JOBS];
+
+    // Scratch memory of the previous job is not needed anymore
+    if (threads_state->persistent.arenas != NULL)
+        threads_state->persistent.arenas[thread_idx].used = 0;
+
+#ifndef STATION_IS_CONCURRENT_PROCESSING_INSTRUMENTATION_ENABLED
+    bool timed = (job->assignment.schedule == STATION_CONCURRENT_PROCESSING_SCHEDULE_ADAPTIVE);
+#else
+    bool timed = true;
+#endif
+
+    uint_least64_t start_ns = 0;
+    if (timed)
+        start_ns = station_concurrent_processing_time_ns();
+
+    // Processing functions may execute nested jobs on the same threads
+    struct station_concurrent_processing_threads_state *prev_state = station_concurrent_processing_current_state;
+    station_thread_idx_t prev_thread_idx = station_concurrent_processing_current_thread_idx;
+    station_threads_number_t prev_num_threads = station_concurrent_processing_current_num_threads;
+
+    station_concurrent_processing_current_state = threads_state;
+    station_concurrent_processing_current_thread_idx = thread_idx;
+    station_concurrent_processing_current_num_threads = job->assignment.num_threads;
+
+    // Process tasks
+    struct station_concurrent_processing_progress progress;
+
+    switch (job->assignment.schedule)
+    {
+        case STATION_CONCURRENT_PROCESSING_SCHEDULE_STATIC:
+            progress = station_concurrent_processing_do_static(job, &job->assignment, thread_idx);
+            break;
+
+        case STATION_CONCURRENT_PROCESSING_SCHEDULE_WORK_STEALING:
+            progress = station_concurrent_processing_do_work_stealing(job, &job->assignment, thread_idx);
+            break;
+
+        case STATION_CONCURRENT_PROCESSING_SCHEDULE_GUIDED:
+            progress = station_concurrent_processing_do_guided(job, &job->assignment, thread_idx);
+            break;
+
+        default: // dynamic and adaptive modes
+            progress = station_concurrent_processing_do_dynamic(job, &job->assignment, thread_idx);
+    }
+
+    atomic_fetch_add_explicit(&job->processed_tasks, progress.num_tasks, memory_order_relaxed);
+
+    if (timed)
+    {
+        uint_least64_t end_ns = station_concurrent_processing_time_ns();
+        uint_least64_t busy_ns = end_ns - start_ns;
+
+        atomic_fetch_add_explicit(&job->busy_ns, busy_ns, memory_order_relaxed);
+
+#ifdef STATION_IS_CONCURRENT_PROCESSING_INSTRUMENTATION_ENABLED
+        struct station_concurrent_processing_thread_counters *counters =
+            &threads_state->persistent.thread_counters[thread_idx];
+
+        atomic_fetch_add_explicit(&counters->num_jobs, 1, memory_order_relaxed);
+        atomic_fetch_add_explicit(&counters->num_tasks, progress.num_tasks, memory_order_relaxed);
+        atomic_fetch_add_explicit(&counters->num_batches, progress.num_batches, memory_order_relaxed);
+        atomic_fetch_add_explicit(&counters->busy_ns, busy_ns, memory_order_relaxed);
+
+        // Time from publication of the job until the thread started it
+        if (start_ns > job->submit_ns)
+            atomic_fetch_add_explicit(&counters->wake_latency_ns, start_ns - job->submit_ns,
+                    memory_order_relaxed);
+
+        uint_least64_t value = atomic_load_explicit(&job->max_busy_ns, memory_order_relaxed);
+        while ((value < busy_ns) && !atomic_compare_exchange_weak_explicit(&job->max_busy_ns,
+                    &value, busy_ns, memory_order_relaxed, memory_order_relaxed));
+
+        value = atomic_load_explicit(&job->first_finish_ns, memory_order_relaxed);
+        while ((value > end_ns) && !atomic_compare_exchange_weak_explicit(&job->first_finish_ns,
+                    &value, end_ns, memory_order_relaxed, memory_order_relaxed));
+#endif
+    }
+
+    // Help threads which are still processing the job with their nested jobs
+    while (station_concurrent_processing_help(threads_state, thread_idx));
+
+    if (job->assignment.finish != NULL)
+        job->assignment.finish(job->assignment.finish_data, thread_idx, job->assignment.num_threads);
+
+    station_concurrent_processing_arrive(threads_state, job, job_idx, thread_idx);
+
+    station_concurrent_processing_current_state = prev_state;
+    station_concurrent_processing_current_thread_idx = prev_thread_idx;
+    station_concurrent_processing_current_num_threads = prev_num_threads;
+}
+
+static
+bool
+station_concurrent_processing_park(
+        struct station_concurrent_processing_threads_state *threads_state,
+        station_thread_idx_t thread_idx)
+{
+    station_concurrent_processing_lock(&threads_state->persistent.park_mtx);
+
+    while ((thread_idx >= ACTIVE_THREADS_NUMBER(atomic_load(&threads_state->active))) &&
+            !atomic_load(&threads_state->terminate))
+    {
+#ifndef NDEBUG
+        int res =
+#endif
+            cnd_wait(&threads_state->persistent.park_cnd, &threads_state->persistent.park_mtx);
+        assert(res == thrd_success);
+    }
+
+    bool is_active = (thread_idx < ACTIVE_THREADS_NUMBER(atomic_load(&threads_state->active)));
+
+    station_concurrent_processing_unlock(&threads_state->persistent.park_mtx);
+
+    // Inactive thread has no jobs to finish before termination
+    return is_active;
+}
+
+static
+int
+station_concurrent_processing_thread(
+        void *arg)
+{
+    struct station_concurrent_processing_threads_state *threads_state;
+    station_thread_idx_t thread_idx;
+    {
+        struct station_concurrent_processing_thread_arg *thread_arg = arg;
+        assert(thread_arg != NULL);
+
+        threads_state = thread_arg->threads_state;
+        thread_idx = thread_arg->thread_idx;
+
+        free(thread_arg);
+    }
+
+#ifdef STATION_IS_THREAD_AFFINITY_SUPPORTED
+    // Pin the thread to its CPU
+    if (threads_state->persistent.thread_cpus != NULL)
+    {
+        station_cpu_idx_t cpu = threads_state->persistent.thread_cpus[thread_idx];
+
+        if (cpu >= 0)
+        {
+            cpu_set_t cpu_set;
+            CPU_ZERO(&cpu_set);
+            CPU_SET(cpu, &cpu_set);
+
+            if (sched_setaffinity(0, sizeof(cpu_set), &cpu_set) != 0)
+                atomic_store_explicit(&threads_state->affinity_failed, true, memory_order_relaxed);
+        }
+    }
+#endif
+
+    atomic_fetch_add_explicit(&threads_state->num_started, 1, memory_order_release);
+
+    bool use_ping_cnd = threads_state->persistent.use_ping_cnd;
+
+    bool spin_adaptive = (threads_state->persistent.spin_count ==
+            STATION_CONCURRENT_PROCESSING_SPIN_ADAPTIVE);
+    uint32_t spin_budget = spin_adaptive ? SPIN_BUDGET_INITIAL : threads_state->persistent.spin_count;
+
+    uint_least64_t job_idx = 0; // index of the next job to process
+
+    for (;;)
+    {
+        uint_least64_t num_submitted = atomic_load_explicit(&threads_state->num_submitted, memory_order_acquire);
+
+        // Loaded after the counter, so it is not older than the configuration of the next job
+        uint_least64_t active = atomic_load_explicit(&threads_state->active, memory_order_acquire);
+
+        if (thread_idx >= ACTIVE_THREADS_NUMBER(active))
+        {
+            // Sleep until the thread is needed again
+            if (!station_concurrent_processing_park(threads_state, thread_idx))
+                break;
+
+            continue;
+        }
+        else if (job_idx < ACTIVE_THREADS_FIRST_JOB(active))
+        {
+            // Jobs submitted while the thread was inactive are done without it
+            job_idx = ACTIVE_THREADS_FIRST_JOB(active);
+            continue;
+        }
+
+        // Wait until a job is submitted
+        if (num_submitted == job_idx)
+        {
+#ifdef STATION_IS_CONCURRENT_PROCESSING_INSTRUMENTATION_ENABLED
+            uint_least64_t idle_start_ns = station_concurrent_processing_time_ns();
+#endif
+
+            if (use_ping_cnd && (spin_budget > 0) && station_concurrent_processing_spin(
+                        &threads_state->num_submitted, job_idx + 1, &spin_budget, spin_adaptive))
+            {
+                // Job is submitted while spinning
+            }
+            else if (use_ping_cnd)
+            {
+                // Leaders of groups and threads without groups wait on ping_cnd, others wait on group's one
+                struct station_concurrent_processing_wake_group *group =
+                    (threads_state->persistent.wake_groups != NULL) ?
+                    &threads_state->persistent.wake_groups[thread_idx / WAKE_GROUP_SIZE] : NULL;
+                bool is_leader = (thread_idx % WAKE_GROUP_SIZE == 0);
+
+                cnd_t *cnd = &threads_state->persistent.ping_cnd;
+                mtx_t *mtx = &threads_state->persistent.ping_mtx;
+                atomic_ushort *num_sleeping = &threads_state->num_sleeping;
+
+                if ((group != NULL) && !is_leader)
+                {
+                    cnd = &group->cnd;
+                    mtx = &group->mtx;
+                    num_sleeping = &group->num_sleeping;
+                }
+
+                station_concurrent_processing_lock(mtx);
+                atomic_fetch_add(num_sleeping, 1);
+
+                if ((group != NULL) && is_leader)
+                    atomic_store(&group->leader_job, job_idx + 1);
+
+                while ((atomic_load(&threads_state->num_submitted) == job_idx) &&
+                        (atomic_load(&threads_state->active) == active) &&
+                        !atomic_load(&threads_state->terminate))
+                {
+#ifndef NDEBUG
+                    int res =
+#endif
+                        cnd_wait(cnd, mtx);
+                    assert(res == thrd_success);
+                }
+
+                atomic_fetch_sub_explicit(num_sleeping, 1, memory_order_relaxed);
+                station_concurrent_processing_unlock(mtx);
+
+                // Wake the group, as the submitter relies on the leader doing it
+                if ((group != NULL) && is_leader)
+                {
+                    atomic_store(&group->leader_job, 0);
+
+                    if (atomic_load(&group->num_sleeping) > 0)
+                        station_concurrent_processing_broadcast(&group->cnd, &group->mtx);
+                }
+            }
+            else
+            {
+                while ((atomic_load_explicit(&threads_state->num_submitted,
+                                memory_order_acquire) == job_idx) &&
+                        (atomic_load_explicit(&threads_state->active, memory_order_relaxed) == active) &&
+                        !atomic_load_explicit(&threads_state->terminate, memory_order_acquire));
+            }
+
+#ifdef STATION_IS_CONCURRENT_PROCESSING_INSTRUMENTATION_ENABLED
+            atomic_fetch_add_explicit(&threads_state->persistent.thread_counters[thread_idx].idle_ns,
+                    station_concurrent_processing_time_ns() - idle_start_ns, memory_order_relaxed);
+#endif
+
+            // Terminate only when all submitted jobs are done
+            if ((atomic_load_explicit(&threads_state->num_submitted, memory_order_acquire) == job_idx) &&
+                    atomic_load_explicit(&threads_state->terminate, memory_order_acquire))
+                break;
+
+            continue;
+        }
+
+        // Jobs of contexts sharing the threads may be processed by a part of them
+        {
+            struct station_concurrent_processing_job *job =
+                &threads_state->jobs[job_idx % STATION_CONCURRENT_PROCESSING_MAX_JOBS];
+
+            // Reused slot means that the job is completed without the thread
+            if ((thread_idx >= atomic_load_explicit(&job->num_workers, memory_order_acquire)) ||
+                    (atomic_load(&job->handle) != job_idx + 1))
+            {
+                job_idx++;
+                continue;
+            }
+        }
+
+        // Process the job and proceed to the next one
+        station_concurrent_processing_do_job(threads_state, job_idx, thread_idx);
+        job_idx++;
+    }
+
+    return 0;
+}
+
+static
+void
+station_concurrent_processing_stop_threads(
+        struct station_concurrent_processing_threads_state *threads_state,
+        station_threads_number_t num_threads)
+{
+    // Wake threads
+    atomic_store(&threads_state->terminate, true);
+
+    station_concurrent_processing_wake_threads(threads_state, 0, true);
+
+    station_concurrent_processing_broadcast(&threads_state->persistent.park_cnd,
+            &threads_state->persistent.park_mtx);
+
+    for (station_threads_number_t i = 0; i < num_threads; i++)
+        thrd_join(threads_state->persistent.threads[i], (int*)NULL);
+}
+
+static
+station_concurrent_processing_job_t
+station_concurrent_processing_submit_assignment(
+        station_concurrent_processing_context_t *context,
+        struct station_concurrent_processing_assignment assignment,
+        bool caller_participates,
+        bool blocking)
+{
+    if ((context == NULL) || (context->state == NULL) || (assignment.num_tasks == 0))
+        return 0;
+
+    struct station_concurrent_processing_threads_state *threads_state = context->state;
+
+    if (!assignment.fixed_schedule)
+        assignment.schedule = context->schedule;
+
+    if (assignment.cost_key == NULL)
+        assignment.cost_key = (assignment.pfunc_range == station_concurrent_processing_pfunc_adapter) ?
+            (void (*)(void))assignment.pfunc_adapter.pfunc :
+            (assignment.pfunc_range == station_concurrent_processing_pfunc_range64_adapter) ?
+            (void (*)(void))assignment.pfunc_adapter.pfunc_range64 : (void (*)(void))assignment.pfunc_range;
+
+    station_concurrent_processing_lock(&threads_state->persistent.submit_mtx);
+
+    // Only submitters modify the counter, and they are serialized by the mutex
+    uint_least64_t job_idx = atomic_load_explicit(&threads_state->num_submitted, memory_order_relaxed);
+
+    station_threads_number_t num_threads = ACTIVE_THREADS_NUMBER(
+            atomic_load_explicit(&threads_state->active, memory_order_relaxed));
+
+    // Context sharing threads uses only its share of them
+    if (num_threads > context->num_threads)
+        num_threads = context->num_threads;
+
+    // Wait until the slot is free
+    if (job_idx >= STATION_CONCURRENT_PROCESSING_MAX_JOBS)
+    {
+        uint_least64_t num_jobs = job_idx - STATION_CONCURRENT_PROCESSING_MAX_JOBS + 1;
+
+        // Thread processing a job of the same threads may wait for its own job, so it doesn't wait
+        if ((threads_state == station_concurrent_processing_current_state) &&
+                (atomic_load_explicit(&threads_state->num_completed, memory_order_acquire) < num_jobs))
+        {
+            station_concurrent_processing_unlock(&threads_state->persistent.submit_mtx);
+            return 0;
+        }
+
+        station_concurrent_processing_wait_for_jobs(threads_state, num_jobs, context->busy_wait);
+    }
+
+    if (num_threads == 0)
+    {
+        // All tasks are processed before the job can be cancelled
+        struct station_concurrent_processing_job *job =
+            &threads_state->jobs[job_idx % STATION_CONCURRENT_PROCESSING_MAX_JOBS];
+
+        atomic_store(&job->handle, job_idx + 1);
+        atomic_store_explicit(&job->num_workers, 0, memory_order_release);
+        atomic_store_explicit(&job->notification_fd, blocking ? -1 : context->notification_fd,
+                memory_order_relaxed);
+        atomic_store(&job->processed_tasks, assignment.num_tasks);
+
+        atomic_store(&threads_state->num_submitted, job_idx + 1);
+
+        station_concurrent_processing_unlock(&threads_state->persistent.submit_mtx);
+
+        // Process all tasks in the calling thread
+        if (threads_state->persistent.arenas != NULL)
+            threads_state->persistent.arenas[0].used = 0;
+
+        if (station_concurrent_processing_is_adapter(assignment.pfunc_range))
+            assignment.pfunc_range_data = &assignment;
+
+        struct station_concurrent_processing_threads_state *prev_state =
+            station_concurrent_processing_current_state;
+        station_thread_idx_t prev_thread_idx = station_concurrent_processing_current_thread_idx;
+        station_threads_number_t prev_num_threads = station_concurrent_processing_current_num_threads;
+
+        station_concurrent_processing_current_state = threads_state;
+        station_concurrent_processing_current_thread_idx = 0;
+        station_concurrent_processing_current_num_threads = 1;
+
+#ifdef STATION_IS_CONCURRENT_PROCESSING_INSTRUMENTATION_ENABLED
+        uint_least64_t start_ns = station_concurrent_processing_time_ns();
+#endif
+
+        assignment.pfunc_range(assignment.pfunc_range_data, 0, assignment.num_tasks, 0);
+
+#ifdef STATION_IS_CONCURRENT_PROCESSING_INSTRUMENTATION_ENABLED
+        {
+            struct station_concurrent_processing_thread_counters *counters =
+                &threads_state->persistent.thread_counters[0];
+
+            atomic_fetch_add_explicit(&counters->num_jobs, 1, memory_order_relaxed);
+            atomic_fetch_add_explicit(&counters->num_tasks, assignment.num_tasks, memory_order_relaxed);
+            atomic_fetch_add_explicit(&counters->num_batches, 1, memory_order_relaxed);
+            atomic_fetch_add_explicit(&counters->busy_ns,
+                    station_concurrent_processing_time_ns() - start_ns, memory_order_relaxed);
+
+            station_concurrent_processing_count_job(threads_state, 0, IMBALANCE_SCALE);
+        }
+#endif
+
+        if (assignment.finish != NULL)
+            assignment.finish(assignment.finish_data, 0, 1);
+
+        if (assignment.callback != NULL)
+            assignment.callback(assignment.callback_data, 0);
+
+        station_concurrent_processing_current_state = prev_state;
+        station_concurrent_processing_current_thread_idx = prev_thread_idx;
+        station_concurrent_processing_current_num_threads = prev_num_threads;
+
+        station_concurrent_processing_complete(threads_state, job, job_idx);
+
+        return job_idx + 1;
+    }
+
+    struct station_concurrent_processing_job *job =
+        &threads_state->jobs[job_idx % STATION_CONCURRENT_PROCESSING_MAX_JOBS];
+
+    // Set the assignment
+    assignment.num_threads = num_threads + caller_participates;
+
+    assignment.handle = job_idx + 1;
+    if (context->time_budget_ns != 0)
+        assignment.deadline_ns = station_concurrent_processing_time_ns() + context->time_budget_ns;
+
+    if (assignment.schedule == STATION_CONCURRENT_PROCESSING_SCHEDULE_ADAPTIVE)
+        assignment.batch_size = station_concurrent_processing_adaptive_batch_size(threads_state, &assignment);
+    else if (assignment.batch_size == 0) // automatic batch size
+        assignment.batch_size = (assignment.schedule == STATION_CONCURRENT_PROCESSING_SCHEDULE_GUIDED) ?
+            1 : (assignment.num_tasks - 1) / assignment.num_threads + 1;
+
+    job->assignment = assignment;
+
+    if (station_concurrent_processing_is_adapter(assignment.pfunc_range))
+        job->assignment.pfunc_range_data = &job->assignment;
+
+    // Initialize counters (handle goes first, so that queries for the previous job can detect reuse)
+    atomic_store(&job->handle, job_idx + 1);
+    atomic_store_explicit(&job->num_workers, num_threads, memory_order_release);
+    atomic_store_explicit(&job->notification_fd, blocking ? -1 : context->notification_fd,
+            memory_order_relaxed);
+    atomic_store(&job->processed_tasks, 0);
+
+    atomic_store_explicit(&job->done_tasks, 0, memory_order_relaxed);
+    atomic_store_explicit(&job->thread_counter, 0, memory_order_relaxed);
+    atomic_store_explicit(&job->busy_ns, 0, memory_order_relaxed);
+
+    if (assignment.schedule == STATION_CONCURRENT_PROCESSING_SCHEDULE_WORK_STEALING)
+    {
+        // Split tasks into contiguous ranges of (almost) equal sizes
+        for (station_threads_number_t i = 0; i < assignment.num_threads; i++)
+            atomic_store_explicit(&job->ranges[i].range,
+                    TASK_RANGE((uint_least64_t)assignment.num_tasks * i / assignment.num_threads,
+                        (uint_least64_t)assignment.num_tasks * (i + 1) / assignment.num_threads),
+                    memory_order_relaxed);
+    }
+
+#ifdef STATION_IS_CONCURRENT_PROCESSING_INSTRUMENTATION_ENABLED
+    atomic_store_explicit(&job->max_busy_ns, 0, memory_order_relaxed);
+    atomic_store_explicit(&job->first_finish_ns, UINT_LEAST64_MAX, memory_order_relaxed);
+
+    job->submit_ns = station_concurrent_processing_time_ns();
+#endif
+
+    // Publish the job
+    atomic_store(&threads_state->num_submitted, job_idx + 1);
+
+    station_concurrent_processing_unlock(&threads_state->persistent.submit_mtx);
+
+    // Wake sleeping threads
+    station_concurrent_processing_wake_threads(threads_state, job_idx, false);
+
+    return job_idx + 1;
+}
+
+static
+bool
+station_concurrent_processing_execute_assignment(
+        station_concurrent_processing_context_t *context,
+        struct station_concurrent_processing_assignment assignment,
+        bool busy_wait)
+{
+    if (context == NULL)
+        return false;
+    else if (assignment.callback != NULL)
+        return station_concurrent_processing_submit_assignment(context, assignment, false, false) != 0;
+    else if ((context->state != NULL) && (context->state == station_concurrent_processing_current_state))
+    {
+        // Called from a thread processing a job of the same threads, which cannot wait for
+        // the jobs queued after its own one, so tasks are processed by the calling thread
+        // with help of threads which run out of tasks
+        station_thread_idx_t thread_idx = station_concurrent_processing_current_thread_idx;
+        station_threads_number_t num_threads = (context->num_threads < (station_threads_number_t)-1) ?
+            context->num_threads + 1 : context->num_threads;
+
+        if ((thread_idx >= num_threads) || (assignment.num_tasks == 0))
+            return false;
+
+        station_concurrent_processing_execute_nested(context->state, assignment, num_threads, thread_idx);
+        return true;
+    }
+
+    // Index of the calling thread is context->num_threads, so it must be representable.
+    // With shared threads, that index may belong to a thread processing other jobs.
+    bool caller_participates = context->caller_participation && !context->shared &&
+        (context->num_threads > 0) && (context->num_threads < (station_threads_number_t)-1);
+
+    station_concurrent_processing_job_t job =
+        station_concurrent_processing_submit_assignment(context, assignment, caller_participates, true);
+
+    if (job == 0)
+        return false;
+
+    // Process tasks together with threads, then wait for the rest of them
+    // (job is completed already if there were no active threads at the moment of submission)
+    if (caller_participates && (atomic_load(&context->state->num_completed) < job))
+    {
+        // Index of the calling thread is the number of active threads the job was submitted to
+        station_concurrent_processing_do_job(context->state, job - 1, context->state->jobs[
+                (job - 1) % STATION_CONCURRENT_PROCESSING_MAX_JOBS].assignment.num_threads - 1);
+    }
+
+    station_concurrent_processing_wait_for_jobs(context->state, job, busy_wait);
+
+    return true;
+}
+
+#endif // STATION_IS_CONCURRENT_PROCESSING_SUPPORTED
+
+int
+station_concurrent_processing_initialize_context(
+        station_concurrent_processing_context_t *context,
+        station_threads_number_t num_threads,
+        bool busy_wait)
+{
+    return station_concurrent_processing_initialize_context_with_options(context, num_threads,
+            &(station_concurrent_processing_context_options_t){.busy_wait = busy_wait});
+}
+
+int
+station_concurrent_processing_initialize_context_with_options(
+        station_concurrent_processing_context_t *context,
+        station_threads_number_t num_threads,
+        const station_concurrent_processing_context_options_t *options)
+{
+#ifndef STATION_IS_CONCURRENT_PROCESSING_SUPPORTED
+    (void) context;
+    (void) options;
+
+    if (num_threads > 0)
+        return -2;
+
+    context->state = NULL;
+    context->num_threads = 0;
+    context->max_num_threads = 0;
+    context->spin_count = 0;
+    context->thread_cpus = NULL;
+    context->thread_nodes = NULL;
+    context->schedule = STATION_CONCURRENT_PROCESSING_SCHEDULE_DYNAMIC;
+    context->caller_participation = false;
+    context->time_budget_ns = 0;
+    context->notification_fd = -1;
+    context->arena_size = 0;
+    context->shared = false;
+
+    return 0;
+#else
+    if (context == NULL)
+        return -1;
+
+    bool busy_wait = (options != NULL) ? options->busy_wait : false;
+    uint32_t spin_count = (options != NULL) ? options->spin_count : 0;
+    const station_cpu_idx_t *thread_cpus = (options != NULL) ? options->thread_cpus : NULL;
+
+#ifndef STATION_IS_THREAD_AFFINITY_SUPPORTED
+    if ((thread_cpus != NULL) && (num_threads > 0))
+        return 4;
+#else
+    if (thread_cpus != NULL)
+    {
+        for (station_threads_number_t i = 0; i < num_threads; i++)
+            if (thread_cpus[i] >= CPU_SETSIZE)
+                return -1;
+    }
+#endif
+
+    // Initialize threads state
+    struct station_concurrent_processing_threads_state *threads_state =
+        aligned_alloc(CACHE_LINE_SIZE, sizeof(*threads_state));
+    if (threads_state == NULL)
+        return 1;
+
+    threads_state->persistent.num_threads = num_threads;
+    threads_state->persistent.threads = NULL;
+    threads_state->persistent.thread_cpus = NULL;
+    threads_state->persistent.thread_nodes = NULL;
+    threads_state->persistent.ranges = NULL;
+
+#ifdef STATION_IS_CONCURRENT_PROCESSING_INSTRUMENTATION_ENABLED
+    threads_state->persistent.thread_counters = NULL;
+#endif
+
+    threads_state->persistent.arenas = NULL;
+    threads_state->persistent.arenas_memory = NULL;
+    threads_state->persistent.arenas_memory_size = 0;
+
+    threads_state->persistent.arrival_nodes = NULL;
+
+    threads_state->persistent.wake_groups = NULL;
+    threads_state->persistent.num_wake_groups = 0;
+
+    threads_state->persistent.use_ping_cnd = !busy_wait;
+    threads_state->persistent.spin_count = busy_wait ? 0 : spin_count;
+
+    atomic_init(&threads_state->num_submitted, 0);
+    atomic_init(&threads_state->active, ACTIVE_THREADS(num_threads, 0));
+    atomic_init(&threads_state->terminate, false);
+    atomic_init(&threads_state->num_sleeping, 0);
+
+    atomic_init(&threads_state->num_completed, 0);
+    atomic_init(&threads_state->num_waiting, 0);
+    atomic_init(&threads_state->spin_budget, SPIN_BUDGET_INITIAL);
+
+    atomic_init(&threads_state->num_started, 0);
+    atomic_init(&threads_state->affinity_failed, false);
+
+    atomic_init(&threads_state->num_references, 1);
+
+    atomic_init(&threads_state->num_nested, 0);
+    threads_state->nested_jobs = NULL;
+
+    for (size_t i = 0; i < STATION_CONCURRENT_PROCESSING_MAX_JOBS; i++)
+    {
+        threads_state->jobs[i].ranges = NULL;
+        threads_state->jobs[i].arrival_nodes = NULL;
+
+        atomic_init(&threads_state->jobs[i].done_tasks, 0);
+        atomic_init(&threads_state->jobs[i].thread_counter, 0);
+        atomic_init(&threads_state->jobs[i].busy_ns, 0);
+        atomic_init(&threads_state->jobs[i].processed_tasks, 0);
+
+        atomic_init(&threads_state->jobs[i].handle, 0);
+        atomic_init(&threads_state->jobs[i].cancelled, 0);
+        atomic_init(&threads_state->jobs[i].completed, 0);
+        atomic_init(&threads_state->jobs[i].notification_fd, -1);
+        atomic_init(&threads_state->jobs[i].num_workers, 0);
+
+#ifdef STATION_IS_CONCURRENT_PROCESSING_INSTRUMENTATION_ENABLED
+        threads_state->jobs[i].submit_ns = 0;
+        atomic_init(&threads_state->jobs[i].max_busy_ns, 0);
+        atomic_init(&threads_state->jobs[i].first_finish_ns, 0);
+#endif
+    }
+
+#ifdef STATION_IS_CONCURRENT_PROCESSING_INSTRUMENTATION_ENABLED
+    atomic_init(&threads_state->counters.num_jobs, 0);
+    atomic_init(&threads_state->counters.tail_ns, 0);
+    atomic_init(&threads_state->counters.total_imbalance, 0);
+    atomic_init(&threads_state->counters.last_imbalance, 0);
+#endif
+
+    for (size_t i = 0; i < ADAPTIVE_NUM_TASK_COSTS; i++)
+        threads_state->task_costs[i] = (struct station_concurrent_processing_task_cost){0};
+    threads_state->next_task_cost = 0;
+
+    int code, res;
+
+    res = mtx_init(&threads_state->persistent.submit_mtx, mtx_plain);
+    if (res != thrd_success)
+    {
+        code = 3;
+        goto cleanup_state;
+    }
+
+    res = mtx_init(&threads_state->persistent.cost_mtx, mtx_plain);
+    if (res != thrd_success)
+    {
+        code = 3;
+        goto cleanup_submit_mtx;
+    }
+
+    res = mtx_init(&threads_state->persistent.nested_mtx, mtx_plain);
+    if (res != thrd_success)
+    {
+        code = 3;
+        goto cleanup_cost_mtx;
+    }
+
+    res = mtx_init(&threads_state->persistent.pong_mtx, mtx_plain);
+    if (res != thrd_success)
+    {
+        code = 3;
+        goto cleanup_nested_mtx;
+    }
+
+    res = cnd_init(&threads_state->persistent.pong_cnd);
+    if (res != thrd_success)
+    {
+        code = (res == thrd_nomem) ? 2 : 3;
+        goto cleanup_pong_mtx;
+    }
+
+    res = mtx_init(&threads_state->persistent.park_mtx, mtx_plain);
+    if (res != thrd_success)
+    {
+        code = 3;
+        goto cleanup_pong_cnd;
+    }
+
+    res = cnd_init(&threads_state->persistent.park_cnd);
+    if (res != thrd_success)
+    {
+        code = (res == thrd_nomem) ? 2 : 3;
+        goto cleanup_park_mtx;
+    }
+
+    if (threads_state->persistent.use_ping_cnd)
+    {
+        res = mtx_init(&threads_state->persistent.ping_mtx, mtx_plain);
+        if (res != thrd_success)
+        {
+            code = 3;
+            goto cleanup_park_cnd;
+        }
+
+        res = cnd_init(&threads_state->persistent.ping_cnd);
+        if (res != thrd_success)
+        {
+            code = (res == thrd_nomem) ? 2 : 3;
+            goto cleanup_ping_mtx;
+        }
+    }
+
+    // Create threads
+    station_thread_idx_t thread_idx = 0;
+
+#ifdef STATION_IS_CONCURRENT_PROCESSING_INSTRUMENTATION_ENABLED
+    threads_state->persistent.thread_counters = aligned_alloc(CACHE_LINE_SIZE,
+            sizeof(*threads_state->persistent.thread_counters) * (num_threads + 1));
+    if (threads_state->persistent.thread_counters == NULL)
+    {
+        code = 1;
+        goto cleanup;
+    }
+
+    for (station_threads_number_t i = 0; i <= num_threads; i++)
+    {
+        atomic_init(&threads_state->persistent.thread_counters[i].num_jobs, 0);
+        atomic_init(&threads_state->persistent.thread_counters[i].num_tasks, 0);
+        atomic_init(&threads_state->persistent.thread_counters[i].num_batches, 0);
+        atomic_init(&threads_state->persistent.thread_counters[i].busy_ns, 0);
+        atomic_init(&threads_state->persistent.thread_counters[i].idle_ns, 0);
+        atomic_init(&threads_state->persistent.thread_counters[i].wake_latency_ns, 0);
+    }
+#endif
+
+    if (num_threads > 0)
+    {
+        // One more thread is the calling one
+        size_t num_tree_nodes = station_concurrent_processing_tree_num_nodes((size_t)num_threads + 1);
+
+        // Many threads contend on a single counter and a single mutex, so use trees
+        if (num_threads >= STATION_CONCURRENT_PROCESSING_TREE_MIN_THREADS)
+        {
+            threads_state->persistent.arrival_nodes = aligned_alloc(CACHE_LINE_SIZE,
+                    sizeof(*threads_state->persistent.arrival_nodes) * num_tree_nodes *
+                    STATION_CONCURRENT_PROCESSING_MAX_JOBS);
+            if (threads_state->persistent.arrival_nodes == NULL)
+            {
+                code = 1;
+                goto cleanup;
+            }
+
+            for (size_t i = 0; i < num_tree_nodes * STATION_CONCURRENT_PROCESSING_MAX_JOBS; i++)
+                atomic_init(&threads_state->persistent.arrival_nodes[i].counter, 0);
+
+            for (size_t i = 0; i < STATION_CONCURRENT_PROCESSING_MAX_JOBS; i++)
+                threads_state->jobs[i].arrival_nodes = threads_state->persistent.arrival_nodes + num_tree_nodes * i;
+
+            if (threads_state->persistent.use_ping_cnd)
+            {
+                station_threads_number_t num_wake_groups = (num_threads - 1) / WAKE_GROUP_SIZE + 1;
+
+                threads_state->persistent.wake_groups = aligned_alloc(CACHE_LINE_SIZE,
+                        sizeof(*threads_state->persistent.wake_groups) * num_wake_groups);
+                if (threads_state->persistent.wake_groups == NULL)
+                {
+                    code = 1;
+                    goto cleanup;
+                }
+
+                for (; threads_state->persistent.num_wake_groups < num_wake_groups;
+                        threads_state->persistent.num_wake_groups++)
+                {
+                    struct station_concurrent_processing_wake_group *group =
+                        &threads_state->persistent.wake_groups[threads_state->persistent.num_wake_groups];
+
+                    res = mtx_init(&group->mtx, mtx_plain);
+                    if (res != thrd_success)
+                    {
+                        code = 3;
+                        goto cleanup;
+                    }
+
+                    res = cnd_init(&group->cnd);
+                    if (res != thrd_success)
+                    {
+                        mtx_destroy(&group->mtx);
+
+                        code = (res == thrd_nomem) ? 2 : 3;
+                        goto cleanup;
+                    }
+
+                    atomic_init(&group->num_sleeping, 0);
+                    atomic_init(&group->leader_job, 0);
+                }
+            }
+        }
+
+        threads_state->persistent.threads = malloc(sizeof(thrd_t) * num_threads);
+        if (threads_state->persistent.threads == NULL)
+        {
+            code = 1;
+            goto cleanup;
+        }
+
+        if (thread_cpus != NULL)
+        {
+            threads_state->persistent.thread_cpus = malloc(sizeof(*thread_cpus) * num_threads);
+            if (threads_state->persistent.thread_cpus == NULL)
+            {
+                code = 1;
+                goto cleanup;
+            }
+
+            memcpy(threads_state->persistent.thread_cpus, thread_cpus,
+                    sizeof(*thread_cpus) * num_threads);
+
+#ifdef STATION_IS_THREAD_AFFINITY_SUPPORTED
+            // Find NUMA nodes of pinned threads
+            threads_state->persistent.thread_nodes = malloc(
+                    sizeof(*threads_state->persistent.thread_nodes) * num_threads);
+            if (threads_state->persistent.thread_nodes == NULL)
+            {
+                code = 1;
+                goto cleanup;
+            }
+
+            for (station_threads_number_t i = 0; i < num_threads; i++)
+                threads_state->persistent.thread_nodes[i] = (thread_cpus[i] >= 0) ?
+                    station_concurrent_processing_cpu_numa_node(thread_cpus[i]) : -1;
+#endif
+        }
+
+        threads_state->persistent.ranges = aligned_alloc(CACHE_LINE_SIZE,
+                sizeof(*threads_state->persistent.ranges) * (num_threads + 1) *
+                STATION_CONCURRENT_PROCESSING_MAX_JOBS);
+        if (threads_state->persistent.ranges == NULL)
+        {
+            code = 1;
+            goto cleanup;
+        }
+
+        for (size_t i = 0; i < STATION_CONCURRENT_PROCESSING_MAX_JOBS; i++)
+        {
+            // One more range for the calling thread
+            threads_state->jobs[i].ranges = threads_state->persistent.ranges + (num_threads + 1) * i;
+
+            for (station_threads_number_t j = 0; j <= num_threads; j++)
+                atomic_init(&threads_state->jobs[i].ranges[j].range, 0);
+        }
+    }
+
+    for (thread_idx = 0; thread_idx < num_threads; thread_idx++)
+    {
+        struct station_concurrent_processing_thread_arg *thread_arg =
+            malloc(sizeof(*thread_arg));
+        if (thread_arg == NULL)
+        {
+            code = 1;
+            goto cleanup;
+        }
+
+        thread_arg->threads_state = threads_state;
+        thread_arg->thread_idx = thread_idx;
+
+        res = thrd_create(&threads_state->persistent.threads[thread_idx],
+                station_concurrent_processing_thread, thread_arg);
+
+        if (res != thrd_success)
+        {
+            free(thread_arg);
+
+            if (res == thrd_nomem)
+                code = 2;
+            else
+                code = 3;
+
+            goto cleanup;
+        }
+    }
+
+    if (threads_state->persistent.thread_cpus != NULL)
+    {
+        // Wait until all threads are pinned
+        while (atomic_load_explicit(&threads_state->num_started, memory_order_acquire) < num_threads)
+            thrd_yield();
+
+        if (atomic_load_explicit(&threads_state->affinity_failed, memory_order_relaxed))
+        {
+            code = 4;
+            goto cleanup;
+        }
+    }
+
+    context->state = threads_state;
+    context->num_threads = num_threads;
+    context->max_num_threads = num_threads;
+    context->busy_wait = busy_wait;
+    context->spin_count = threads_state->persistent.spin_count;
+    context->thread_cpus = threads_state->persistent.thread_cpus;
+    context->thread_nodes = threads_state->persistent.thread_nodes;
+    context->schedule = STATION_CONCURRENT_PROCESSING_SCHEDULE_DYNAMIC;
+    context->caller_participation = false;
+    context->time_budget_ns = 0;
+    context->notification_fd = -1;
+    context->arena_size = 0;
+    context->shared = false;
+
+    return 0;
+
+cleanup:
+    station_concurrent_processing_stop_threads(threads_state, thread_idx);
+
+    free(threads_state->persistent.threads);
+    free(threads_state->persistent.thread_cpus);
+    free(threads_state->persistent.thread_nodes);
+    free(threads_state->persistent.ranges);
+    free(threads_state->persistent.arrival_nodes);
+
+    for (station_threads_number_t i = 0; i < threads_state->persistent.num_wake_groups; i++)
+    {
+        cnd_destroy(&threads_state->persistent.wake_groups[i].cnd);
+        mtx_destroy(&threads_state->persistent.wake_groups[i].mtx);
+    }
+    free(threads_state->persistent.wake_groups);
+
+#ifdef STATION_IS_CONCURRENT_PROCESSING_INSTRUMENTATION_ENABLED
+    free(threads_state->persistent.thread_counters);
+#endif
+
+    if (threads_state->persistent.use_ping_cnd)
+        cnd_destroy(&threads_state->persistent.ping_cnd);
+cleanup_ping_mtx:
+    if (threads_state->persistent.use_ping_cnd)
+        mtx_destroy(&threads_state->persistent.ping_mtx);
+cleanup_park_cnd:
+    cnd_destroy(&threads_state->persistent.park_cnd);
+cleanup_park_mtx:
+    mtx_destroy(&threads_state->persistent.park_mtx);
+cleanup_pong_cnd:
+    cnd_destroy(&threads_state->persistent.pong_cnd);
+cleanup_pong_mtx:
+    mtx_destroy(&threads_state->persistent.pong_mtx);
+cleanup_nested_mtx:
+    mtx_destroy(&threads_state->persistent.nested_mtx);
+cleanup_cost_mtx:
+    mtx_destroy(&threads_state->persistent.cost_mtx);
+cleanup_submit_mtx:
+    mtx_destroy(&threads_state->persistent.submit_mtx);
+cleanup_state:
+    free(threads_state);
+
+    return code;
+#endif
+}
+
+int
+station_concurrent_processing_initialize_shared_context(
+        station_concurrent_processing_context_t *context,
+        const station_concurrent_processing_context_t *pool,
+        station_threads_number_t share)
+{
+#ifndef STATION_IS_CONCURRENT_PROCESSING_SUPPORTED
+    (void) context;
+    (void) pool;
+    (void) share;
+
+    return -2;
+#else
+    if ((context == NULL) || (pool == NULL) || (pool->state == NULL) || (share == 0))
+        return -1;
+
+    atomic_fetch_add(&pool->state->num_references, 1);
+
+    context->state = pool->state;
+    context->num_threads = (share < pool->max_num_threads) ? share : pool->max_num_threads;
+    context->max_num_threads = pool->max_num_threads;
+    context->busy_wait = pool->busy_wait;
+    context->spin_count = pool->spin_count;
+    context->thread_cpus = pool->thread_cpus;
+    context->thread_nodes = pool->thread_nodes;
+    context->schedule = STATION_CONCURRENT_PROCESSING_SCHEDULE_DYNAMIC;
+    context->caller_participation = false;
+    context->time_budget_ns = 0;
+    context->notification_fd = -1;
+    context->arena_size = pool->arena_size;
+    context->shared = true;
+
+    return 0;
+#endif
+}
+
+void
+station_concurrent_processing_destroy_context(
+        station_concurrent_processing_context_t *context)
+{
+#ifndef STATION_IS_CONCURRENT_PROCESSING_SUPPORTED
+    (void) context;
+
+    return;
+#else
+    if ((context == NULL) || (context->state == NULL))
+        return;
+
+    // Threads are destroyed together with the last context using them
+    if (atomic_fetch_sub(&context->state->num_references, 1) == 1)
+    {
+        // Threads finish all submitted jobs before termination
+        station_concurrent_processing_stop_threads(context->state,
+                context->state->persistent.num_threads);
+
+        free(context->state->persistent.threads);
+        free(context->state->persistent.thread_cpus);
+        free(context->state->persistent.thread_nodes);
+        free(context->state->persistent.ranges);
+        free(context->state->persistent.arrival_nodes);
+
+        for (station_threads_number_t i = 0; i < context->state->persistent.num_wake_groups; i++)
+        {
+            cnd_destroy(&context->state->persistent.wake_groups[i].cnd);
+            mtx_destroy(&context->state->persistent.wake_groups[i].mtx);
+        }
+        free(context->state->persistent.wake_groups);
+
+#ifdef STATION_IS_CONCURRENT_PROCESSING_INSTRUMENTATION_ENABLED
+        free(context->state->persistent.thread_counters);
+#endif
+
+        free(context->state->persistent.arenas);
+        if (context->state->persistent.arenas_memory != NULL)
+            munmap(context->state->persistent.arenas_memory, context->state->persistent.arenas_memory_size);
+
+        if (context->state->persistent.use_ping_cnd)
+        {
+            cnd_destroy(&context->state->persistent.ping_cnd);
+            mtx_destroy(&context->state->persistent.ping_mtx);
+        }
+
+        cnd_destroy(&context->state->persistent.pong_cnd);
+        mtx_destroy(&context->state->persistent.pong_mtx);
+
+        cnd_destroy(&context->state->persistent.park_cnd);
+        mtx_destroy(&context->state->persistent.park_mtx);
+
+        mtx_destroy(&context->state->persistent.nested_mtx);
+        mtx_destroy(&context->state->persistent.cost_mtx);
+        mtx_destroy(&context->state->persistent.submit_mtx);
+
+        free(context->state);
+    }
+
+    context->state = NULL;
+    context->num_threads = 0;
+    context->max_num_threads = 0;
+    context->busy_wait = false;
+    context->spin_count = 0;
+    context->thread_cpus = NULL;
+    context->thread_nodes = NULL;
+    context->schedule = STATION_CONCURRENT_PROCESSING_SCHEDULE_DYNAMIC;
+    context->caller_participation = false;
+    context->time_budget_ns = 0;
+    context->notification_fd = -1;
+    context->arena_size = 0;
+    context->shared = false;
+#endif
+}
+
+#ifdef STATION_IS_THREAD_AFFINITY_SUPPORTED
+
+struct station_concurrent_processing_cpu {
+    station_cpu_idx_t cpu;
+    int package;   // physical package (socket) ID
+    int core;      // core ID within package
+    int core_rank; // ordinal number of the core within package
+    int smt_rank;  // ordinal number of the hardware thread within core
+};
+
+static
+int
+station_concurrent_processing_read_cpu_topology(
+        station_cpu_idx_t cpu,
+        const char *name,
+        int default_value)
+{
+    char path[128];
+    snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%i/topology/%s", (int)cpu, name);
+
+    FILE *file = fopen(path, "r");
+    if (file == NULL)
+        return default_value;
+
+    int value;
+    if (fscanf(file, "%i", &value) != 1)
+        value = default_value;
+
+    fclose(file);
+    return value;
+}
+
+static
+int
+station_concurrent_processing_compare_cpus_compact(
+        const void *a,
+        const void *b)
+{
+    const struct station_concurrent_processing_cpu *cpu_a = a, *cpu_b = b;
+
+    if (cpu_a->package != cpu_b->package)
+        return (cpu_a->package > cpu_b->package) - (cpu_a->package < cpu_b->package);
+    else if (cpu_a->core != cpu_b->core)
+        return (cpu_a->core > cpu_b->core) - (cpu_a->core < cpu_b->core);
+    else
+        return (cpu_a->cpu > cpu_b->cpu) - (cpu_a->cpu < cpu_b->cpu);
+}
+
+static
+int
+station_concurrent_processing_compare_cpus_scatter(
+        const void *a,
+        const void *b)
+{
+    const struct station_concurrent_processing_cpu *cpu_a = a, *cpu_b = b;
+
+    if (cpu_a->smt_rank != cpu_b->smt_rank)
+        return (cpu_a->smt_rank > cpu_b->smt_rank) - (cpu_a->smt_rank < cpu_b->smt_rank);
+    else if (cpu_a->core_rank != cpu_b->core_rank)
+        return (cpu_a->core_rank > cpu_b->core_rank) - (cpu_a->core_rank < cpu_b->core_rank);
+    else
+        return (cpu_a->package > cpu_b->package) - (cpu_a->package < cpu_b->package);
+}
+
+#endif // STATION_IS_THREAD_AFFINITY_SUPPORTED
+
+bool
+station_concurrent_processing_place_threads(
+        station_concurrent_processing_placement_t policy,
+        station_threads_number_t num_threads,
+        station_cpu_idx_t *thread_cpus)
+{
+#ifndef STATION_IS_THREAD_AFFINITY_SUPPORTED
+    (void) policy;
+    (void) num_threads;
+    (void) thread_cpus;
+
+    return false;
+#else
+    if ((thread_cpus == NULL) && (num_threads > 0))
+        return false;
+
+    // Get CPUs available to the process
+    cpu_set_t cpu_set;
+    if (sched_getaffinity(0, sizeof(cpu_set), &cpu_set) != 0)
+        return false;
+
+    int num_cpus = CPU_COUNT(&cpu_set);
+    if (num_cpus == 0)
+        return false;
+
+    struct station_concurrent_processing_cpu *cpus = malloc(sizeof(*cpus) * num_cpus);
+    if (cpus == NULL)
+        return false;
+
+    for (int cpu = 0, i = 0; i < num_cpus; cpu++)
+    {
+        if (!CPU_ISSET(cpu, &cpu_set))
+            continue;
+
+        cpus[i++] = (struct station_concurrent_processing_cpu){
+            .cpu = cpu,
+            .package = station_concurrent_processing_read_cpu_topology(cpu, "physical_package_id", 0),
+            .core = station_concurrent_processing_read_cpu_topology(cpu, "core_id", cpu),
+        };
+    }
+
+    // Sort CPUs so that hardware threads of a core are adjacent, and rank them
+    qsort(cpus, num_cpus, sizeof(*cpus), station_concurrent_processing_compare_cpus_compact);
+
+    for (int i = 0; i < num_cpus; i++)
+    {
+        if ((i == 0) || (cpus[i].package != cpus[i-1].package))
+        {
+            cpus[i].core_rank = 0;
+            cpus[i].smt_rank = 0;
+        }
+        else if (cpus[i].core != cpus[i-1].core)
+        {
+            cpus[i].core_rank = cpus[i-1].core_rank + 1;
+            cpus[i].smt_rank = 0;
+        }
+        else
+        {
+            cpus[i].core_rank = cpus[i-1].core_rank;
+            cpus[i].smt_rank = cpus[i-1].smt_rank + 1;
+        }
+    }
+
+    bool result = true;
+
+    switch (policy)
+    {
+        case STATION_CONCURRENT_PROCESSING_PLACEMENT_COMPACT:
+            break;
+
+        case STATION_CONCURRENT_PROCESSING_PLACEMENT_SCATTER:
+            qsort(cpus, num_cpus, sizeof(*cpus), station_concurrent_processing_compare_cpus_scatter);
+            break;
+
+        case STATION_CONCURRENT_PROCESSING_PLACEMENT_PHYSICAL:
+            {
+                // Keep the first hardware thread of every core
+                int num_cores = 0;
+
+                for (int i = 0; i < num_cpus; i++)
+                    if (cpus[i].smt_rank == 0)
+                        cpus[num_cores++] = cpus[i];
+
+                num_cpus = num_cores;
+            }
+            break;
+
+        default:
+            result = false;
+    }
+
+    if (result)
+        for (station_threads_number_t i = 0; i < num_threads; i++)
+            thread_cpus[i] = cpus[i % num_cpus].cpu;
+
+    free(cpus);
+    return result;
+#endif
+}
+
+#ifdef STATION_IS_CONCURRENT_PROCESSING_SUPPORTED
+
+struct station_concurrent_processing_first_touch {
+    unsigned char *memory;
+    size_t task_size;
+};
+
+static
+STATION_PFUNC_RANGE(station_concurrent_processing_pfunc_first_touch)
+{
+    (void) thread_idx;
+
+    const struct station_concurrent_processing_first_touch *first_touch = data;
+
+    memset(first_touch->memory + task_idx_begin * first_touch->task_size, 0,
+            (task_idx_end - task_idx_begin) * first_touch->task_size);
+}
+
+#endif // STATION_IS_CONCURRENT_PROCESSING_SUPPORTED
+
+void*
+station_concurrent_processing_allocate_first_touch(
+        station_concurrent_processing_context_t *context,
+
+        station_tasks_number_t num_tasks,
+        size_t task_size)
+{
+    if ((num_tasks == 0) || (task_size == 0) || (task_size > SIZE_MAX / num_tasks))
+        return NULL;
+
+    size_t size = num_tasks * task_size;
+
+#ifndef STATION_IS_CONCURRENT_PROCESSING_SUPPORTED
+    (void) context;
+
+    return calloc(1, size);
+#else
+    // Align to page size, so that pages are shared by as few threads as possible
+    long page_size = sysconf(_SC_PAGESIZE);
+    size_t alignment = (page_size > 0) ? (size_t)page_size : CACHE_LINE_SIZE;
+
+    if (size > SIZE_MAX - alignment)
+        return NULL;
+
+    struct station_concurrent_processing_first_touch first_touch = {
+        .memory = aligned_alloc(alignment, (size + alignment - 1) / alignment * alignment),
+        .task_size = task_size,
+    };
+    if (first_touch.memory == NULL)
+        return NULL;
+
+    // Touch memory from threads in the same way as static schedule does
+    station_concurrent_processing_job_t job = 0;
+
+    // Nested call cannot wait for the job queued after the one being processed
+    if ((context != NULL) && (context->num_threads > 0) &&
+            (context->state != station_concurrent_processing_current_state))
+        job = station_concurrent_processing_submit_assignment(context,
+                (struct station_concurrent_processing_assignment){
+                    .pfunc_range = station_concurrent_processing_pfunc_first_touch,
+                    .pfunc_range_data = &first_touch,
+                    .num_tasks = num_tasks,
+                    .schedule = STATION_CONCURRENT_PROCESSING_SCHEDULE_STATIC,
+                    .fixed_schedule = true,
+                    .uncancellable = true, // memory must be zeroed completely
+                }, false, true);
+
+    if (job != 0)
+        station_concurrent_processing_wait_for_jobs(context->state, job, context->busy_wait);
+    else
+        memset(first_touch.memory, 0, size);
+
+    return first_touch.memory;
+#endif
+}
+
+bool
+station_concurrent_processing_static_range(
+        station_tasks_number_t num_tasks,
+        station_threads_number_t num_threads,
+        station_thread_idx_t thread_idx,
+
+        station_task_idx_t *begin,
+        station_task_idx_t *end)
+{
+    if (thread_idx >= num_threads)
+        return false;
+
+    if (begin != NULL)
+        *begin = (uint_least64_t)num_tasks * thread_idx / num_threads;
+
+    if (end != NULL)
+        *end = (uint_least64_t)num_tasks * (thread_idx + 1) / num_threads;
+
+    return true;
+}
+
+bool
+station_concurrent_processing_set_num_threads(
+        station_concurrent_processing_context_t *context,
+        station_threads_number_t num_threads)
+{
+#ifndef STATION_IS_CONCURRENT_PROCESSING_SUPPORTED
+    return (context != NULL) && (num_threads == 0);
+#else
+    if ((context == NULL) || (context->state == NULL) ||
+            (num_threads > context->state->persistent.num_threads))
+        return false;
+
+    // Share of threads is used by subsequent jobs, threads themselves are not affected
+    if (context->shared)
+    {
+        if (num_threads == 0)
+            return false;
+
+        context->num_threads = num_threads;
+        return true;
+    }
+
+    struct station_concurrent_processing_threads_state *threads_state = context->state;
+
+    station_concurrent_processing_lock(&threads_state->persistent.submit_mtx);
+
+    // Jobs in flight expect the current number of threads
+    uint_least64_t num_submitted = atomic_load_explicit(&threads_state->num_submitted, memory_order_relaxed);
+    station_concurrent_processing_wait_for_jobs(threads_state, num_submitted, context->busy_wait);
+
+    station_concurrent_processing_lock(&threads_state->persistent.park_mtx);
+    atomic_store(&threads_state->active, ACTIVE_THREADS(num_threads, num_submitted));
+    station_concurrent_processing_unlock(&threads_state->persistent.park_mtx);
+
+    station_concurrent_processing_unlock(&threads_state->persistent.submit_mtx);
+
+    // Wake parked threads which become active, and waiting threads which become inactive
+    cnd_broadcast(&threads_state->persistent.park_cnd);
+
+    station_concurrent_processing_wake_threads(threads_state, 0, true);
+
+    context->num_threads = num_threads;
+
+    return true;
+#endif
+}
+
+bool
+station_concurrent_processing_create_arenas(
+        station_concurrent_processing_context_t *context,
+        size_t arena_size,
+        bool huge_pages)
+{
+#ifndef STATION_IS_CONCURRENT_PROCESSING_SUPPORTED
+    (void) context;
+    (void) arena_size;
+    (void) huge_pages;
+
+    return false;
+#else
+    if ((context == NULL) || (context->state == NULL))
+        return false;
+
+    struct station_concurrent_processing_threads_state *threads_state = context->state;
+
+    // Round arena size up to page size, so that pages of different threads don't mix
+    long page_size = sysconf(_SC_PAGESIZE);
+    size_t alignment = huge_pages ? ARENA_HUGE_PAGE_SIZE : (page_size > 0) ? (size_t)page_size : CACHE_LINE_SIZE;
+
+    if (arena_size > SIZE_MAX - alignment)
+        return false;
+
+    size_t stride = (arena_size + alignment - 1) / alignment * alignment;
+    size_t num_arenas = (size_t)threads_state->persistent.num_threads + 1;
+
+    struct station_concurrent_processing_arena *arenas = NULL;
+    void *memory = NULL;
+    size_t memory_size = 0;
+
+    if (arena_size > 0)
+    {
+        if (stride > SIZE_MAX / num_arenas)
+            return false;
+
+        memory_size = stride * num_arenas;
+
+        arenas = aligned_alloc(CACHE_LINE_SIZE, sizeof(*arenas) * num_arenas);
+        if (arenas == NULL)
+            return false;
+
+        // Pages are not touched here, so they are placed near threads using them
+        memory = MAP_FAILED;
+#ifdef MAP_HUGETLB
+        if (huge_pages)
+            memory = mmap(NULL, memory_size, PROT_READ | PROT_WRITE,
+                    MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+#endif
+        if (memory == MAP_FAILED)
+        {
+            // Fall back to regular pages, which may still be merged into transparent huge pages
+            memory = mmap(NULL, memory_size, PROT_READ | PROT_WRITE,
+                    MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+            if (memory == MAP_FAILED)
+            {
+                free(arenas);
+                return false;
+            }
+
+#ifdef MADV_HUGEPAGE
+            if (huge_pages)
+                madvise(memory, memory_size, MADV_HUGEPAGE);
+#endif
+        }
+
+        for (size_t i = 0; i < num_arenas; i++)
+            arenas[i] = (struct station_concurrent_processing_arena){
+                .memory = (unsigned char*)memory + stride * i, .size = stride};
+    }
+
+    // Replace previous arenas
+    free(threads_state->persistent.arenas);
+    if (threads_state->persistent.arenas_memory != NULL)
+        munmap(threads_state->persistent.arenas_memory, threads_state->persistent.arenas_memory_size);
+
+    threads_state->persistent.arenas = arenas;
+    threads_state->persistent.arenas_memory = memory;
+    threads_state->persistent.arenas_memory_size = memory_size;
+
+    context->arena_size = (arena_size > 0) ? stride : 0;
+
+    return true;
+#endif
+}
+
+void*
+station_concurrent_processing_arena_allocate(
+        station_concurrent_processing_context_t *context,
+        station_thread_idx_t thread_idx,
+        size_t size,
+        size_t alignment)
+{
+#ifndef STATION_IS_CONCURRENT_PROCESSING_SUPPORTED
+    (void) context;
+    (void) thread_idx;
+    (void) size;
+    (void) alignment;
+
+    return NULL;
+#else
+    if ((context == NULL) || (context->state == NULL) ||
+            (context->state->persistent.arenas == NULL) ||
+            (thread_idx > context->state->persistent.num_threads))
+        return NULL;
+
+    if (alignment == 0)
+        alignment = _Alignof(max_align_t);
+    else if ((alignment & (alignment - 1)) != 0)
+        return NULL;
+
+    struct station_concurrent_processing_arena *arena = &context->state->persistent.arenas[thread_idx];
+
+    if (alignment > arena->size)
+        return NULL;
+
+    uintptr_t base = (uintptr_t)arena->memory;
+    size_t offset = ((base + arena->used + alignment - 1) & ~(uintptr_t)(alignment - 1)) - base;
+    if ((offset > arena->size) || (size > arena->size - offset))
+        return NULL;
+
+    arena->used = offset + size;
+    if (arena->high_watermark < arena->used)
+        arena->high_watermark = arena->used;
+
+    return arena->memory + offset;
+#endif
+}
+
+size_t
+station_concurrent_processing_arena_high_watermark(
+        const station_concurrent_processing_context_t *context,
+        station_thread_idx_t thread_idx)
+{
+#ifndef STATION_IS_CONCURRENT_PROCESSING_SUPPORTED
+    (void) context;
+    (void) thread_idx;
+
+    return 0;
+#else
+    if ((context == NULL) || (context->state == NULL) ||
+            (context->state->persistent.arenas == NULL) ||
+            (thread_idx > context->state->persistent.num_threads))
+        return 0;
+
+    return context->state->persistent.arenas[thread_idx].high_watermark;
+#endif
+}
+
+station_concurrent_processing_job_t
+station_concurrent_processing_submit(
+        station_concurrent_processing_context_t *context,
+
+        station_tasks_number_t num_tasks,
+        station_tasks_number_t batch_size,
+
+        station_pfunc_t pfunc,
+        void *pfunc_data,
+
+        station_pfunc_callback_t callback,
+        void *callback_data)
+{
+#ifndef STATION_IS_CONCURRENT_PROCESSING_SUPPORTED
+    (void) context;
+    (void) batch_size;
+
+    if ((pfunc == NULL) || (num_tasks == 0))
+        return 0;
+
+    for (station_task_idx_t task_idx = 0; task_idx < num_tasks; task_idx++)
+        pfunc(pfunc_data, task_idx, 0);
+
+    if (callback != NULL)
+        callback(callback_data, 0);
+
+    return 1;
+#else
+    if (pfunc == NULL)
+        return 0;
+
+    return station_concurrent_processing_submit_assignment(context,
+            (struct station_concurrent_processing_assignment){
+                .pfunc_range = station_concurrent_processing_pfunc_adapter,
+                .pfunc_adapter = {.pfunc = pfunc, .pfunc_data = pfunc_data},
+                .callback = callback, .callback_data = callback_data,
+                .num_tasks = num_tasks, .batch_size = batch_size,
+            }, false, false);
+#endif
+}
+
+station_concurrent_processing_job_t
+station_concurrent_processing_submit_range(
+        station_concurrent_processing_context_t *context,
+
+        station_tasks_number_t num_tasks,
+        station_tasks_number_t batch_size,
+
+        station_pfunc_range_t pfunc_range,
+        void *pfunc_data,
+
+        station_pfunc_callback_t callback,
+        void *callback_data)
+{
+#ifndef STATION_IS_CONCURRENT_PROCESSING_SUPPORTED
+    (void) context;
+    (void) batch_size;
+
+    if ((pfunc_range == NULL) || (num_tasks == 0))
+        return 0;
+
+    pfunc_range(pfunc_data, 0, num_tasks, 0);
+
+    if (callback != NULL)
+        callback(callback_data, 0);
+
+    return 1;
+#else
+    if (pfunc_range == NULL)
+        return 0;
+
+    return station_concurrent_processing_submit_assignment(context,
+            (struct station_concurrent_processing_assignment){
+                .pfunc_range = pfunc_range, .pfunc_range_data = pfunc_data,
+                .callback = callback, .callback_data = callback_data,
+                .num_tasks = num_tasks, .batch_size = batch_size,
+            }, false, false);
+#endif
+}
+
+bool
+station_concurrent_processing_wait(
+        station_concurrent_processing_context_t *context,
+        station_concurrent_processing_job_t job,
+        bool busy_wait)
+{
+#ifndef STATION_IS_CONCURRENT_PROCESSING_SUPPORTED
+    (void) context;
+    (void) busy_wait;
+
+    return job != 0;
+#else
+    if ((context == NULL) || (context->state == NULL) || (job == 0))
+        return false;
+    else if (job > atomic_load_explicit(&context->state->num_submitted, memory_order_relaxed))
+        return false;
+
+    station_concurrent_processing_wait_for_jobs(context->state, job, busy_wait);
+    return true;
+#endif
+}
+
+bool
+station_concurrent_processing_poll(
+        station_concurrent_processing_context_t *context,
+        station_concurrent_processing_job_t job)
+{
+#ifndef STATION_IS_CONCURRENT_PROCESSING_SUPPORTED
+    (void) context;
+
+    return job != 0;
+#else
+    if ((context == NULL) || (context->state == NULL) || (job == 0))
+        return false;
+
+    return atomic_load_explicit(&context->state->num_completed, memory_order_acquire) >= job;
+#endif
+}
+
+bool
+station_concurrent_processing_cancel(
+        station_concurrent_processing_context_t *context,
+        station_concurrent_processing_job_t job)
+{
+#ifndef STATION_IS_CONCURRENT_PROCESSING_SUPPORTED
+    (void) context;
+    (void) job;
+
+    return false;
+#else
+    if ((context == NULL) || (context->state == NULL))
+        return false;
+
+    struct station_concurrent_processing_threads_state *threads_state = context->state;
+
+    uint_least64_t first, last;
+
+    if (job == 0) // all jobs in flight
+    {
+        first = atomic_load(&threads_state->num_completed) + 1;
+        last = atomic_load(&threads_state->num_submitted);
+    }
+    else if (job <= atomic_load(&threads_state->num_submitted))
+        first = last = job;
+    else
+        return false;
+
+    for (uint_least64_t handle = first; handle <= last; handle++)
+    {
+        atomic_uint_least64_t *cancelled = &threads_state->jobs[
+            (handle - 1) % STATION_CONCURRENT_PROCESSING_MAX_JOBS].cancelled;
+
+        // Never overwrite cancellation of a later job in the same slot
+        uint_least64_t value = atomic_load_explicit(cancelled, memory_order_relaxed);
+        while ((value < handle) && !atomic_compare_exchange_weak_explicit(cancelled,
+                    &value, handle, memory_order_relaxed, memory_order_relaxed));
+    }
+
+    return true;
+#endif
+}
+
+bool
+station_concurrent_processing_num_processed_tasks(
+        station_concurrent_processing_context_t *context,
+        station_concurrent_processing_job_t job,
+        station_tasks_number_t *num_processed_tasks)
+{
+#ifndef STATION_IS_CONCURRENT_PROCESSING_SUPPORTED
+    (void) context;
+    (void) job;
+    (void) num_processed_tasks;
+
+    return false;
+#else
+    if ((context == NULL) || (context->state == NULL) || (job == 0))
+        return false;
+
+    struct station_concurrent_processing_threads_state *threads_state = context->state;
+
+    if (atomic_load(&threads_state->num_completed) < job)
+        return false;
+
+    struct station_concurrent_processing_job *slot =
+        &threads_state->jobs[(job - 1) % STATION_CONCURRENT_PROCESSING_MAX_JOBS];
+
+    // Submitter of a later job changes handle before resetting the counter
+    station_tasks_number_t processed = atomic_load(&slot->processed_tasks);
+    if (atomic_load(&slot->handle) != job)
+        return false;
+
+    if (num_processed_tasks != NULL)
+        *num_processed_tasks = processed;
+
+    return true;
+#endif
+}
+
+int
+station_concurrent_processing_create_notification(void)
+{
+#ifndef STATION_IS_EVENTFD_SUPPORTED
+    return -1;
+#else
+    return eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+#endif
+}
+
+void
+station_concurrent_processing_destroy_notification(
+        int fd)
+{
+#ifndef STATION_IS_EVENTFD_SUPPORTED
+    (void) fd;
+#else
+    if (fd >= 0)
+        close(fd);
+#endif
+}
+
+uint64_t
+station_concurrent_processing_read_notification(
+        int fd)
+{
+#ifndef STATION_IS_EVENTFD_SUPPORTED
+    (void) fd;
+
+    return 0;
+#else
+    if (fd < 0)
+        return 0;
+
+    // Counter is reset by reading, nothing is read if it is zero
+    uint64_t value;
+    ssize_t res;
+
+    do
+        res = read(fd, &value, sizeof(value));
+    while ((res < 0) && (errno == EINTR));
+
+    return (res == sizeof(value)) ? value : 0;
+#endif
+}
+
+bool
+station_concurrent_processing_get_stats(
+        const station_concurrent_processing_context_t *context,
+        station_concurrent_processing_stats_t *stats)
+{
+#ifndef STATION_IS_CONCURRENT_PROCESSING_INSTRUMENTATION_ENABLED
+    (void) context;
+    (void) stats;
+
+    return false;
+#else
+    if ((context == NULL) || (context->state == NULL) || (stats == NULL))
+        return false;
+
+    struct station_concurrent_processing_threads_state *threads_state = context->state;
+
+    uint64_t num_jobs = atomic_load_explicit(&threads_state->counters.num_jobs, memory_order_relaxed);
+
+    *stats = (station_concurrent_processing_stats_t){
+        .num_jobs = num_jobs,
+        .tail_ns = atomic_load_explicit(&threads_state->counters.tail_ns, memory_order_relaxed),
+        .last_imbalance = (double)atomic_load_explicit(&threads_state->counters.last_imbalance,
+                memory_order_relaxed) / IMBALANCE_SCALE,
+        .mean_imbalance = (num_jobs > 0) ?
+            (double)atomic_load_explicit(&threads_state->counters.total_imbalance,
+                    memory_order_relaxed) / IMBALANCE_SCALE / num_jobs : 0,
+    };
+
+    return true;
+#endif
+}
+
+bool
+station_concurrent_processing_get_thread_stats(
+        const station_concurrent_processing_context_t *context,
+        station_thread_idx_t thread_idx,
+        station_concurrent_processing_thread_stats_t *stats)
+{
+#ifndef STATION_IS_CONCURRENT_PROCESSING_INSTRUMENTATION_ENABLED
+    (void) context;
+    (void) thread_idx;
+    (void) stats;
+
+    return false;
+#else
+    if ((context == NULL) || (context->state == NULL) || (stats == NULL) ||
+            (thread_idx > context->state->persistent.num_threads))
+        return false;
+
+    struct station_concurrent_processing_thread_counters *counters =
+        &context->state->persistent.thread_counters[thread_idx];
+
+    *stats = (station_concurrent_processing_thread_stats_t){
+        .num_jobs = atomic_load_explicit(&counters->num_jobs, memory_order_relaxed),
+        .num_tasks = atomic_load_explicit(&counters->num_tasks, memory_order_relaxed),
+        .num_batches = atomic_load_explicit(&counters->num_batches, memory_order_relaxed),
+        .busy_ns = atomic_load_explicit(&counters->busy_ns, memory_order_relaxed),
+        .idle_ns = atomic_load_explicit(&counters->idle_ns, memory_order_relaxed),
+        .wake_latency_ns = atomic_load_explicit(&counters->wake_latency_ns, memory_order_relaxed),
+    };
+
+    return true;
+#endif
+}
+
+void
+station_concurrent_processing_reset_stats(
+        station_concurrent_processing_context_t *context)
+{
+#ifndef STATION_IS_CONCURRENT_PROCESSING_INSTRUMENTATION_ENABLED
+    (void) context;
+#else
+    if ((context == NULL) || (context->state == NULL))
+        return;
+
+    struct station_concurrent_processing_threads_state *threads_state = context->state;
+
+    atomic_store_explicit(&threads_state->counters.num_jobs, 0, memory_order_relaxed);
+    atomic_store_explicit(&threads_state->counters.tail_ns, 0, memory_order_relaxed);
+    atomic_store_explicit(&threads_state->counters.total_imbalance, 0, memory_order_relaxed);
+    atomic_store_explicit(&threads_state->counters.last_imbalance, 0, memory_order_relaxed);
+
+    for (station_threads_number_t i = 0; i <= threads_state->persistent.num_threads; i++)
+    {
+        struct station_concurrent_processing_thread_counters *counters =
+            &threads_state->persistent.thread_counters[i];
+
+        atomic_store_explicit(&counters->num_jobs, 0, memory_order_relaxed);
+        atomic_store_explicit(&counters->num_tasks, 0, memory_order_relaxed);
+        atomic_store_explicit(&counters->num_batches, 0, memory_order_relaxed);
+        atomic_store_explicit(&counters->busy_ns, 0, memory_order_relaxed);
+        atomic_store_explicit(&counters->idle_ns, 0, memory_order_relaxed);
+        atomic_store_explicit(&counters->wake_latency_ns, 0, memory_order_relaxed);
+    }
+#endif
+}
+
+bool
+station_concurrent_processing_execute(
+        station_concurrent_processing_context_t *context,
+
+        station_tasks_number_t num_tasks,
+        station_tasks_number_t batch_size,
+
+        station_pfunc_t pfunc,
+        void *pfunc_data,
+
+        station_pfunc_callback_t callback,
+        void *callback_data,
+
+        bool busy_wait)
+{
+#ifndef STATION_IS_CONCURRENT_PROCESSING_SUPPORTED
+    (void) context;
+    (void) batch_size;
+    (void) busy_wait;
+
+    if (pfunc == NULL)
+        return false;
+
+    for (station_task_idx_t task_idx = 0; task_idx < num_tasks; task_idx++)
+        pfunc(pfunc_data, task_idx, 0);
+
+    if (callback != NULL)
+        callback(callback_data, 0);
+
+    return true;
+#else
+    if (pfunc == NULL)
+        return false;
+
+    return station_concurrent_processing_execute_assignment(context,
+            (struct station_concurrent_processing_assignment){
+                .pfunc_range = station_concurrent_processing_pfunc_adapter,
+                .pfunc_adapter = {.pfunc = pfunc, .pfunc_data = pfunc_data},
+                .callback = callback, .callback_data = callback_data,
+                .num_tasks = num_tasks, .batch_size = batch_size,
+            }, busy_wait);
+#endif
+}
+
+bool
+station_concurrent_processing_execute_range(
+        station_concurrent_processing_context_t *context,
+
+        station_tasks_number_t num_tasks,
+        station_tasks_number_t batch_size,
+
+        station_pfunc_range_t pfunc_range,
+        void *pfunc_data,
+
+        station_pfunc_callback_t callback,
+        void *callback_data,
+
+        bool busy_wait)
+{
+#ifndef STATION_IS_CONCURRENT_PROCESSING_SUPPORTED
+    (void) context;
+    (void) batch_size;
+    (void) busy_wait;
+
+    if (pfunc_range == NULL)
+        return false;
+
+    if (num_tasks > 0)
+        pfunc_range(pfunc_data, 0, num_tasks, 0);
+
+    if (callback != NULL)
+        callback(callback_data, 0);
+
+    return true;
+#else
+    if (pfunc_range == NULL)
+        return false;
+
+    return station_concurrent_processing_execute_assignment(context,
+            (struct station_concurrent_processing_assignment){
+                .pfunc_range = pfunc_range, .pfunc_range_data = pfunc_data,
+                .callback = callback, .callback_data = callback_data,
+                .num_tasks = num_tasks, .batch_size = batch_size,
+            }, busy_wait);
+#endif
+}
+
+bool
+station_concurrent_processing_execute_range64(
+        station_concurrent_processing_context_t *context,
+
+        station_tasks_number64_t num_tasks,
+        station_tasks_number64_t batch_size,
+
+        station_pfunc_range64_t pfunc_range64,
+        void *pfunc_data,
+
+        station_pfunc_callback_t callback,
+        void *callback_data,
+
+        bool busy_wait)
+{
+#ifndef STATION_IS_CONCURRENT_PROCESSING_SUPPORTED
+    (void) context;
+    (void) batch_size;
+    (void) busy_wait;
+
+    if (pfunc_range64 == NULL)
+        return false;
+
+    if (num_tasks > 0)
+        pfunc_range64(pfunc_data, 0, num_tasks, 0);
+
+    if (callback != NULL)
+        callback(callback_data, 0);
+
+    return true;
+#else
+    if ((pfunc_range64 == NULL) || (num_tasks == 0))
+        return false;
+
+    // Group 64-bit tasks into blocks, so that the number of blocks fits into 32 bits
+    station_tasks_number64_t block_size = (num_tasks - 1) / (station_tasks_number_t)-1 + 1;
+    station_tasks_number64_t num_blocks = (num_tasks - 1) / block_size + 1;
+
+    station_tasks_number64_t batch_num_blocks = (batch_size - 1) / block_size + 1;
+    if (batch_size == 0)
+        batch_num_blocks = 0; // automatic batch size
+    else if (batch_num_blocks > num_blocks)
+        batch_num_blocks = num_blocks;
+
+    return station_concurrent_processing_execute_assignment(context,
+            (struct station_concurrent_processing_assignment){
+                .pfunc_range = station_concurrent_processing_pfunc_range64_adapter,
+                .pfunc_adapter = {.pfunc_range64 = pfunc_range64, .pfunc_data = pfunc_data,
+                    .num_tasks = num_tasks, .block_size = block_size},
+                .callback = callback, .callback_data = callback_data,
+                .num_tasks = num_blocks, .batch_size = batch_num_blocks,
+            }, busy_wait);
+#endif
+}
+
+// Maximum number of bits of a tile coordinate in keys of 3D curves
+#define TILE_KEY_MAX_BITS_3D 21
+
+struct station_concurrent_processing_tile_key {
+    uint64_t key; // position of a tile on a curve
+    station_task_idx_t tile_idx; // index of a tile in row-major order
+};
+
+struct station_concurrent_processing_tiling {
+    station_concurrent_processing_domain_t domain; // with zero depths replaced by 1
+    station_task_idx_t num_tiles_x, num_tiles_y;
+
+    struct station_concurrent_processing_tile_key *keys; // tiles sorted by keys, or NULL for row-major order
+
+    station_pfunc_tile_t pfunc_tile;
+    void *pfunc_data;
+
+    station_pfunc_callback_t callback;
+    void *callback_data;
+};
+
+static
+uint64_t
+station_concurrent_processing_tile_key(
+        station_task_idx_t *coords,
+        unsigned num_dims,
+        unsigned num_bits,
+        station_concurrent_processing_tile_order_t order)
+{
+    if ((order == STATION_CONCURRENT_PROCESSING_TILE_ORDER_HILBERT) && (num_bits > 0))
+    {
+        // Transform coordinates into transposed Hilbert index (J. Skilling, 2004)
+        station_task_idx_t high_bit = (station_task_idx_t)1 << (num_bits - 1);
+
+        for (station_task_idx_t q = high_bit; q > 1; q >>= 1)
+        {
+            station_task_idx_t p = q - 1;
+
+            for (unsigned i = 0; i < num_dims; i++)
+            {
+                if (coords[i] & q)
+                    coords[0] ^= p; // invert
+                else
+                {
+                    station_task_idx_t t = (coords[0] ^ coords[i]) & p; // exchange
+                    coords[0] ^= t;
+                    coords[i] ^= t;
+                }
+            }
+        }
+
+        // Gray encode
+        for (unsigned i = 1; i < num_dims; i++)
+            coords[i] ^= coords[i - 1];
+
+        station_task_idx_t t = 0;
+        for (station_task_idx_t q = high_bit; q > 1; q >>= 1)
+            if (coords[num_dims - 1] & q)
+                t ^= q - 1;
+
+        for (unsigned i = 0; i < num_dims; i++)
+            coords[i] ^= t;
+    }
+
+    // Interleave bits of coordinates, most significant first
+    uint64_t key = 0;
+
+    for (unsigned bit = num_bits; bit-- > 0;)
+        for (unsigned i = 0; i < num_dims; i++)
+            key = (key << 1) | ((coords[i] >> bit) & 1);
+
+    return key;
+}
+
+static
+int
+station_concurrent_processing_compare_tile_keys(
+        const void *a,
+        const void *b)
+{
+    const struct station_concurrent_processing_tile_key *key_a = a, *key_b = b;
+
+    return (key_a->key > key_b->key) - (key_a->key < key_b->key);
+}
+
+static
+struct station_concurrent_processing_tiling*
+station_concurrent_processing_create_tiling(
+        const station_concurrent_processing_domain_t *domain,
+        station_tasks_number_t *num_tiles)
+{
+    if (domain == NULL)
+        return NULL;
+
+    station_concurrent_processing_domain_t dom = *domain;
+
+    if (dom.extent.depth == 0)
+        dom.extent.depth = 1;
+    if (dom.tile.depth == 0)
+        dom.tile.depth = 1;
+
+    if ((dom.extent.width == 0) || (dom.extent.height == 0) ||
+            (dom.tile.width == 0) || (dom.tile.height == 0))
+        return NULL;
+
+    // Coordinates of all elements must be representable
+    if ((dom.extent.width > (station_task_idx_t)-1 - dom.origin.x) ||
+            (dom.extent.height > (station_task_idx_t)-1 - dom.origin.y) ||
+            (dom.extent.depth > (station_task_idx_t)-1 - dom.origin.z))
+        return NULL;
+
+    switch (dom.order)
+    {
+        case STATION_CONCURRENT_PROCESSING_TILE_ORDER_ROW_MAJOR:
+        case STATION_CONCURRENT_PROCESSING_TILE_ORDER_MORTON:
+        case STATION_CONCURRENT_PROCESSING_TILE_ORDER_HILBERT:
+            break;
+
+        default:
+            return NULL;
+    }
+
+    station_task_idx_t num_tiles_x = (dom.extent.width - 1) / dom.tile.width + 1;
+    station_task_idx_t num_tiles_y = (dom.extent.height - 1) / dom.tile.height + 1;
+    station_task_idx_t num_tiles_z = (dom.extent.depth - 1) / dom.tile.depth + 1;
+
+    uint_least64_t total = (uint_least64_t)num_tiles_x * num_tiles_y;
+    if ((total > (station_tasks_number_t)-1) ||
+            (total * num_tiles_z > (station_tasks_number_t)-1))
+        return NULL;
+
+    total *= num_tiles_z;
+
+    // Number of bits of the largest tile coordinate
+    unsigned num_dims = (num_tiles_z > 1) ? 3 : 2;
+    unsigned num_bits = 0;
+    {
+        station_task_idx_t max_coord = num_tiles_x - 1;
+        if (max_coord < num_tiles_y - 1)
+            max_coord = num_tiles_y - 1;
+        if (max_coord < num_tiles_z - 1)
+            max_coord = num_tiles_z - 1;
+
+        while (max_coord >> num_bits)
+            num_bits++;
+    }
+
+    bool use_keys = (dom.order != STATION_CONCURRENT_PROCESSING_TILE_ORDER_ROW_MAJOR) && (total > 1);
+
+    if (use_keys && (num_dims == 3) && (num_bits > TILE_KEY_MAX_BITS_3D))
+        return NULL;
+
+    size_t header_size = (sizeof(struct station_concurrent_processing_tiling) +
+            _Alignof(struct station_concurrent_processing_tile_key) - 1) /
+        _Alignof(struct station_concurrent_processing_tile_key) *
+        _Alignof(struct station_concurrent_processing_tile_key);
+
+    if (use_keys && (total > (SIZE_MAX - header_size) /
+                sizeof(struct station_concurrent_processing_tile_key)))
+        return NULL;
+
+    struct station_concurrent_processing_tiling *tiling = malloc(header_size +
+            (use_keys ? sizeof(struct station_concurrent_processing_tile_key) * total : 0));
+    if (tiling == NULL)
+        return NULL;
+
+    *tiling = (struct station_concurrent_processing_tiling){
+        .domain = dom,
+        .num_tiles_x = num_tiles_x,
+        .num_tiles_y = num_tiles_y,
+        .keys = use_keys ? (void*)((unsigned char*)tiling + header_size) : NULL,
+    };
+
+    if (use_keys)
+    {
+        // Sort tiles by their positions on the curve
+        station_task_idx_t tile_idx = 0;
+
+        for (station_task_idx_t z = 0; z < num_tiles_z; z++)
+            for (station_task_idx_t y = 0; y < num_tiles_y; y++)
+                for (station_task_idx_t x = 0; x < num_tiles_x; x++, tile_idx++)
+                {
+                    // X coordinate is the least significant one
+                    station_task_idx_t coords[3] = {z, y, x};
+
+                    tiling->keys[tile_idx] = (struct station_concurrent_processing_tile_key){
+                        .key = station_concurrent_processing_tile_key(coords + (3 - num_dims),
+                                num_dims, num_bits, dom.order),
+                        .tile_idx = tile_idx,
+                    };
+                }
+
+        qsort(tiling->keys, total, sizeof(*tiling->keys),
+                station_concurrent_processing_compare_tile_keys);
+    }
+
+    *num_tiles = total;
+    return tiling;
+}
+
+static
+STATION_PFUNC_RANGE(station_concurrent_processing_pfunc_tiled)
+{
+    const struct station_concurrent_processing_tiling *tiling = data;
+    const station_concurrent_processing_domain_t *domain = &tiling->domain;
+
+    for (station_task_idx_t task_idx = task_idx_begin; task_idx < task_idx_end; task_idx++)
+    {
+        station_task_idx_t tile_idx = (tiling->keys != NULL) ? tiling->keys[task_idx].tile_idx : task_idx;
+
+        // Offsets of the tile from the origin
+        station_task_idx_t x = tile_idx % tiling->num_tiles_x * domain->tile.width;
+        tile_idx /= tiling->num_tiles_x;
+        station_task_idx_t y = tile_idx % tiling->num_tiles_y * domain->tile.height;
+        station_task_idx_t z = tile_idx / tiling->num_tiles_y * domain->tile.depth;
+
+        station_concurrent_processing_tile_t tile = {
+            .x = {.begin = domain->origin.x + x, .end = domain->origin.x +
+                ((domain->extent.width - x > domain->tile.width) ? x + domain->tile.width : domain->extent.width)},
+            .y = {.begin = domain->origin.y + y, .end = domain->origin.y +
+                ((domain->extent.height - y > domain->tile.height) ? y + domain->tile.height : domain->extent.height)},
+            .z = {.begin = domain->origin.z + z, .end = domain->origin.z +
+                ((domain->extent.depth - z > domain->tile.depth) ? z + domain->tile.depth : domain->extent.depth)},
+        };
+
+        tiling->pfunc_tile(tiling->pfunc_data, &tile, thread_idx);
+    }
+}
+
+#ifdef STATION_IS_CONCURRENT_PROCESSING_SUPPORTED
+
+static
+STATION_PFUNC_CALLBACK(station_concurrent_processing_tiled_callback)
+{
+    struct station_concurrent_processing_tiling *tiling = data;
+
+    tiling->callback(tiling->callback_data, thread_idx);
+
+    free(tiling);
+}
+
+#endif // STATION_IS_CONCURRENT_PROCESSING_SUPPORTED
+
+bool
+station_concurrent_processing_execute_tiled(
+        station_concurrent_processing_context_t *context,
+
+        const station_concurrent_processing_domain_t *domain,
+        station_tasks_number_t batch_size,
+
+        station_pfunc_tile_t pfunc_tile,
+        void *pfunc_data,
+
+        station_pfunc_callback_t callback,
+        void *callback_data,
+
+        bool busy_wait)
+{
+    if (pfunc_tile == NULL)
+        return false;
+
+    station_tasks_number_t num_tiles;
+
+    struct station_concurrent_processing_tiling *tiling =
+        station_concurrent_processing_create_tiling(domain, &num_tiles);
+    if (tiling == NULL)
+        return false;
+
+    tiling->pfunc_tile = pfunc_tile;
+    tiling->pfunc_data = pfunc_data;
+    tiling->callback = callback;
+    tiling->callback_data = callback_data;
+
+#ifndef STATION_IS_CONCURRENT_PROCESSING_SUPPORTED
+    (void) context;
+    (void) batch_size;
+    (void) busy_wait;
+
+    station_concurrent_processing_pfunc_tiled(tiling, 0, num_tiles, 0);
+    free(tiling);
+
+    if (callback != NULL)
+        callback(callback_data, 0);
+
+    return true;
+#else
+    // Tiling is freed by the callback if the call is non-blocking
+    bool success = station_concurrent_processing_execute_assignment(context,
+            (struct station_concurrent_processing_assignment){
+                .pfunc_range = station_concurrent_processing_pfunc_tiled,
+                .pfunc_range_data = tiling,
+                .callback = (callback != NULL) ?
+                    station_concurrent_processing_tiled_callback : NULL,
+                .callback_data = tiling,
+                .cost_key = (void (*)(void))pfunc_tile,
+                .num_tasks = num_tiles, .batch_size = batch_size,
+            }, busy_wait);
+
+    if (!success || (callback == NULL))
+        free(tiling);
+
+    return success;
+#endif
+}
+
+#ifdef STATION_IS_CONCURRENT_PROCESSING_SUPPORTED
+
+// Index of the current phase and its next task packed into a single integer for atomic access
+#define PHASE_NEXT(phase_idx, task_idx) (((uint_least64_t)(phase_idx) << 32) | (uint_least64_t)(task_idx))
+#define PHASE_NEXT_PHASE(next) ((size_t)((next) >> 32))
+#define PHASE_NEXT_TASK(next) ((station_task_idx_t)((next) & 0xFFFFFFFF))
+
+struct station_concurrent_processing_phases {
+    _Alignas(CACHE_LINE_SIZE) atomic_uint_least64_t next; // see PHASE_NEXT()
+    _Alignas(CACHE_LINE_SIZE) atomic_uint done_tasks; // processed tasks of the current phase
+    struct station_concurrent_processing_event opened; // signaled when the next phase is opened
+
+    struct station_concurrent_processing_threads_state *threads_state; // of the context running the phases
+
+    station_threads_number_t num_threads; // for automatic batch size
+
+    station_pfunc_callback_t callback;
+    void *callback_data;
+
+    size_t num_phases;
+    station_concurrent_processing_phase_t phases[];
+};
+
+// Find the first phase with tasks, starting from the given one
+static
+size_t
+station_concurrent_processing_next_phase(
+        const station_concurrent_processing_phase_t *phases,
+        size_t num_phases,
+        size_t phase_idx)
+{
+    while ((phase_idx < num_phases) && (phases[phase_idx].num_tasks == 0))
+        phase_idx++;
+
+    return phase_idx;
+}
+
+#endif // STATION_IS_CONCURRENT_PROCESSING_SUPPORTED
+
+static
+void
+station_concurrent_processing_do_phase(
+        const station_concurrent_processing_phase_t *phase,
+        station_task_idx_t begin,
+        station_task_idx_t end,
+        station_thread_idx_t thread_idx)
+{
+    if (phase->pfunc_range != NULL)
+        phase->pfunc_range(phase->pfunc_data, begin, end, thread_idx);
+    else
+        for (station_task_idx_t task_idx = begin; task_idx < end; task_idx++)
+            phase->pfunc(phase->pfunc_data, task_idx, thread_idx);
+}
+
+#ifdef STATION_IS_CONCURRENT_PROCESSING_SUPPORTED
+
+static
+STATION_PFUNC_RANGE(station_concurrent_processing_pfunc_phases)
+{
+    (void) task_idx_begin;
+    (void) task_idx_end;
+
+    struct station_concurrent_processing_phases *phases = data;
+    struct station_concurrent_processing_event_waiter waiter = {0};
+
+    uint_least64_t next = atomic_load_explicit(&phases->next, memory_order_acquire);
+
+    for (;;)
+    {
+        size_t phase_idx = PHASE_NEXT_PHASE(next);
+        if (phase_idx >= phases->num_phases)
+            break;
+
+        const station_concurrent_processing_phase_t *phase = &phases->phases[phase_idx];
+        station_task_idx_t begin = PHASE_NEXT_TASK(next);
+
+        // Wait for other threads to finish the last batches of the phase
+        if (begin >= phase->num_tasks)
+        {
+            station_concurrent_processing_event_idle(phases->threads_state, &phases->opened, &waiter);
+
+            next = atomic_load_explicit(&phases->next, memory_order_acquire);
+            continue;
+        }
+
+        station_concurrent_processing_event_busy(&phases->opened, &waiter);
+
+        station_tasks_number_t batch_size = (phase->batch_size > 0) ? phase->batch_size :
+            (phase->num_tasks - 1) / phases->num_threads + 1;
+
+        station_task_idx_t end = (phase->num_tasks - begin > batch_size) ?
+            begin + batch_size : phase->num_tasks;
+
+        // Acquire the batch, unless the counter was changed by other threads
+        if (!atomic_compare_exchange_weak_explicit(&phases->next, &next, PHASE_NEXT(phase_idx, end),
+                    memory_order_acquire, memory_order_acquire))
+            continue;
+
+        station_concurrent_processing_do_phase(phase, begin, end, thread_idx);
+
+        // The thread finishing the last batch of the phase opens the next one
+        if (atomic_fetch_add_explicit(&phases->done_tasks, end - begin,
+                    memory_order_acq_rel) + (end - begin) == phase->num_tasks)
+        {
+            atomic_store_explicit(&phases->done_tasks, 0, memory_order_relaxed);
+
+            atomic_store_explicit(&phases->next, PHASE_NEXT(station_concurrent_processing_next_phase(
+                            phases->phases, phases->num_phases, phase_idx + 1), 0), memory_order_release);
+
+            station_concurrent_processing_event_signal(phases->threads_state, &phases->opened);
+        }
+
+        next = atomic_load_explicit(&phases->next, memory_order_acquire);
+    }
+
+    station_concurrent_processing_event_busy(&phases->opened, &waiter);
+}
+
+static
+STATION_PFUNC_CALLBACK(station_concurrent_processing_phases_callback)
+{
+    struct station_concurrent_processing_phases *phases = data;
+
+    phases->callback(phases->callback_data, thread_idx);
+
+    free(phases);
+}
+
+#endif // STATION_IS_CONCURRENT_PROCESSING_SUPPORTED
+
+bool
+station_concurrent_processing_execute_phases(
+        station_concurrent_processing_context_t *context,
+
+        const station_concurrent_processing_phase_t *phases,
+        size_t num_phases,
+
+        station_pfunc_callback_t callback,
+        void *callback_data,
+
+        bool busy_wait)
+{
+    if ((phases == NULL) || (num_phases == 0) || (num_phases > 0xFFFFFFFF))
+        return false;
+
+    for (size_t i = 0; i < num_phases; i++)
+        if ((phases[i].pfunc == NULL) == (phases[i].pfunc_range == NULL))
+            return false;
+
+#ifndef STATION_IS_CONCURRENT_PROCESSING_SUPPORTED
+    (void) context;
+    (void) busy_wait;
+
+    for (size_t i = 0; i < num_phases; i++)
+        station_concurrent_processing_do_phase(&phases[i], 0, phases[i].num_tasks, 0);
+
+    if (callback != NULL)
+        callback(callback_data, 0);
+
+    return true;
+#else
+    if (context == NULL)
+        return false;
+
+    size_t size = (sizeof(struct station_concurrent_processing_phases) +
+            sizeof(*phases) * num_phases + CACHE_LINE_SIZE - 1) / CACHE_LINE_SIZE * CACHE_LINE_SIZE;
+
+    struct station_concurrent_processing_phases *phases_state = aligned_alloc(CACHE_LINE_SIZE, size);
+    if (phases_state == NULL)
+        return false;
+
+    atomic_init(&phases_state->next, PHASE_NEXT(station_concurrent_processing_next_phase(
+                    phases, num_phases, 0), 0));
+    atomic_init(&phases_state->done_tasks, 0);
+    station_concurrent_processing_event_init(&phases_state->opened);
+
+    phases_state->threads_state = context->state;
+
+    phases_state->num_threads = (context->num_threads > 0) ? context->num_threads : 1;
+    phases_state->callback = callback;
+    phases_state->callback_data = callback_data;
+
+    phases_state->num_phases = num_phases;
+    memcpy(phases_state->phases, phases, sizeof(*phases) * num_phases);
+
+    // Every participating thread gets at least one task, as there are more tasks than threads.
+    // Phases state is freed by the callback if the call is non-blocking
+    bool success = station_concurrent_processing_execute_assignment(context,
+            (struct station_concurrent_processing_assignment){
+                .pfunc_range = station_concurrent_processing_pfunc_phases,
+                .pfunc_range_data = phases_state,
+                .callback = (callback != NULL) ?
+                    station_concurrent_processing_phases_callback : NULL,
+                .callback_data = phases_state,
+                .num_tasks = (station_tasks_number_t)context->num_threads + 1, .batch_size = 1,
+                .schedule = STATION_CONCURRENT_PROCESSING_SCHEDULE_STATIC, .fixed_schedule = true,
+            }, busy_wait);
+
+    if (!success || (callback == NULL))
+        free(phases_state);
+
+    return success;
+#endif
+}
+
+#ifdef STATION_IS_CONCURRENT_PROCESSING_SUPPORTED
+
+struct station_concurrent_processing_persistent {
+    station_pfunc_persistent_t pfunc_persistent;
+    void *pfunc_data;
+
+    station_pfunc_callback_t callback;
+    void *callback_data;
+
+    // Barriers belong to the job, as jobs of contexts sharing the threads may run simultaneously
+    _Alignas(CACHE_LINE_SIZE) atomic_uint_least64_t barrier_episode; // number of passed barriers
+    struct station_concurrent_processing_tree_node barrier_nodes[]; // combining tree, level by level
+};
+
+static
+STATION_PFUNC_RANGE(station_concurrent_processing_pfunc_persistent)
+{
+    (void) task_idx_begin;
+    (void) task_idx_end;
+
+    struct station_concurrent_processing_persistent *persistent = data;
+
+    // Barriers are allowed only while the thread is inside the function
+    struct station_concurrent_processing_persistent *prev_persistent =
+        station_concurrent_processing_current_persistent;
+    station_threads_number_t prev_num_threads = station_concurrent_processing_persistent_num_threads;
+
+    station_concurrent_processing_current_persistent = persistent;
+    station_concurrent_processing_persistent_num_threads = station_concurrent_processing_current_num_threads;
+
+    persistent->pfunc_persistent(persistent->pfunc_data, thread_idx,
+            station_concurrent_processing_current_num_threads);
+
+    station_concurrent_processing_current_persistent = prev_persistent;
+    station_concurrent_processing_persistent_num_threads = prev_num_threads;
+}
+
+static
+STATION_PFUNC_CALLBACK(station_concurrent_processing_persistent_callback)
+{
+    struct station_concurrent_processing_persistent *persistent = data;
+
+    persistent->callback(persistent->callback_data, thread_idx);
+
+    free(persistent);
+}
+
+#endif // STATION_IS_CONCURRENT_PROCESSING_SUPPORTED
+
+bool
+station_concurrent_processing_execute_persistent(
+        station_concurrent_processing_context_t *context,
+
+        station_pfunc_persistent_t pfunc_persistent,
+        void *pfunc_data,
+
+        station_pfunc_callback_t callback,
+        void *callback_data,
+
+        bool busy_wait)
+{
+    if (pfunc_persistent == NULL)
+        return false;
+
+#ifndef STATION_IS_CONCURRENT_PROCESSING_SUPPORTED
+    (void) context;
+    (void) busy_wait;
+
+    pfunc_persistent(pfunc_data, 0, 1);
+
+    if (callback != NULL)
+        callback(callback_data, 0);
+
+    return true;
+#else
+    if ((context == NULL) || (context->state == NULL))
+        return false;
+
+    // Nested jobs are processed by the calling thread alone
+    if ((callback == NULL) && (context->state == station_concurrent_processing_current_state))
+        return false;
+
+    // One more thread is the calling one
+    size_t num_tree_nodes = station_concurrent_processing_tree_num_nodes((size_t)context->num_threads + 1);
+
+    size_t size = (sizeof(struct station_concurrent_processing_persistent) +
+            sizeof(struct station_concurrent_processing_tree_node) * num_tree_nodes +
+            CACHE_LINE_SIZE - 1) / CACHE_LINE_SIZE * CACHE_LINE_SIZE;
+
+    struct station_concurrent_processing_persistent *persistent = aligned_alloc(CACHE_LINE_SIZE, size);
+    if (persistent == NULL)
+        return false;
+
+    persistent->pfunc_persistent = pfunc_persistent;
+    persistent->pfunc_data = pfunc_data;
+    persistent->callback = callback;
+    persistent->callback_data = callback_data;
+
+    atomic_init(&persistent->barrier_episode, 0);
+
+    for (size_t i = 0; i < num_tree_nodes; i++)
+        atomic_init(&persistent->barrier_nodes[i].counter, 0);
+
+    // Every participating thread gets a single batch, as there are not less tasks than threads.
+    // Persistent state is freed by the callback if the call is non-blocking
+    bool success = station_concurrent_processing_execute_assignment(context,
+            (struct station_concurrent_processing_assignment){
+                .pfunc_range = station_concurrent_processing_pfunc_persistent,
+                .pfunc_range_data = persistent,
+                .callback = (callback != NULL) ?
+                    station_concurrent_processing_persistent_callback : NULL,
+                .callback_data = persistent,
+                .num_tasks = (station_tasks_number_t)context->num_threads + 1,
+                .batch_size = (station_tasks_number_t)context->num_threads + 1,
+                .schedule = STATION_CONCURRENT_PROCESSING_SCHEDULE_STATIC, .fixed_schedule = true,
+                .uncancellable = true, // every thread must reach every barrier
+            }, busy_wait);
+
+    if (!success || (callback == NULL))
+        free(persistent);
+
+    return success;
+#endif
+}
+
+bool
+station_concurrent_processing_barrier(
+        station_concurrent_processing_context_t *context,
+        station_thread_idx_t thread_idx)
+{
+#ifndef STATION_IS_CONCURRENT_PROCESSING_SUPPORTED
+    (void) thread_idx;
+
+    return context != NULL;
+#else
+    if ((context == NULL) || (context->state == NULL) ||
+            (context->state != station_concurrent_processing_current_state))
+        return false;
+
+    struct station_concurrent_processing_persistent *persistent = station_concurrent_processing_current_persistent;
+    station_threads_number_t num_threads = station_concurrent_processing_persistent_num_threads;
+
+    if ((persistent == NULL) || (thread_idx >= num_threads))
+        return false;
+
+    struct station_concurrent_processing_threads_state *threads_state = context->state;
+
+    // Loaded before arrival, so the barrier cannot be passed by other threads yet
+    uint_least64_t episode = atomic_load_explicit(&persistent->barrier_episode, memory_order_acquire);
+
+    if (!station_concurrent_processing_tree_arrive(persistent->barrier_nodes,
+                num_threads, thread_idx))
+    {
+        station_concurrent_processing_wait_for_counter(threads_state, &persistent->barrier_episode,
+                episode + 1, context->busy_wait);
+        return true;
+    }
+
+    // The last thread releases all other threads
+    atomic_store(&persistent->barrier_episode, episode + 1);
+    station_concurrent_processing_wake_waiting(threads_state);
+
+    return true;
+#endif
+}
+
+#ifdef STATION_IS_CONCURRENT_PROCESSING_SUPPORTED
+
+struct station_concurrent_processing_reduction {
+    station_pfunc_accumulate_t accumulate;
+    station_pfunc_combine_t combine;
+    void *data;
+
+    unsigned char *partials; // partial results of threads, each in own cache lines
+    size_t partial_stride;
+    atomic_flag *nodes; // arrival flags of nodes of combining tree
+
+    size_t element_size;
+    void *result;
+
+    station_pfunc_callback_t callback;
+    void *callback_data;
+};
+
+static
+STATION_PFUNC_RANGE(station_concurrent_processing_pfunc_reduction)
+{
+    const struct station_concurrent_processing_reduction *reduction = data;
+
+    void *partial = reduction->partials + thread_idx * reduction->partial_stride;
+
+    for (station_task_idx_t task_idx = task_idx_begin; task_idx < task_idx_end; task_idx++)
+        reduction->accumulate(reduction->data, partial, task_idx, thread_idx);
+}
+
+static
+void
+station_concurrent_processing_reduction_finish(
+        void *data,
+        station_thread_idx_t thread_idx,
+        station_threads_number_t num_threads)
+{
+    struct station_concurrent_processing_reduction *reduction = data;
+
+    // Subtree of partial results [base; base + step) is combined into partial result of base.
+    // Node joining subtrees [base; base + step) and [base + step; base + 2*step)
+    // is identified by index of the right subtree, which is unique for all nodes.
+    size_t base = thread_idx;
+
+    for (size_t step = 1; step < num_threads; step <<= 1)
+    {
+        size_t node_idx;
+
+        if (base & step) // right subtree
+        {
+            node_idx = base;
+            base -= step;
+        }
+        else // left subtree
+        {
+            node_idx = base + step;
+
+            if (node_idx >= num_threads) // right subtree is empty
+                continue;
+        }
+
+        // The first arrived thread leaves, the second one combines both subtrees
+        if (!atomic_flag_test_and_set(&reduction->nodes[node_idx]))
+            return;
+
+        reduction->combine(reduction->data,
+                reduction->partials + base * reduction->partial_stride,
+                reduction->partials + node_idx * reduction->partial_stride);
+    }
+
+    memcpy(reduction->result, reduction->partials, reduction->element_size);
+}
+
+static
+STATION_PFUNC_CALLBACK(station_concurrent_processing_reduction_callback)
+{
+    struct station_concurrent_processing_reduction *reduction = data;
+
+    reduction->callback(reduction->callback_data, thread_idx);
+
+    free(reduction);
+}
+
+#endif // STATION_IS_CONCURRENT_PROCESSING_SUPPORTED
+
+bool
+station_concurrent_processing_reduce(
+        station_concurrent_processing_context_t *context,
+
+        station_tasks_number_t num_tasks,
+        station_tasks_number_t batch_size,
+
+        station_pfunc_accumulate_t accumulate,
+        station_pfunc_combine_t combine,
+        void *pfunc_data,
+
+        size_t element_size,
+        const void *identity,
+        void *result,
+
+        station_pfunc_callback_t callback,
+        void *callback_data,
+
+        bool busy_wait)
+{
+    if ((accumulate == NULL) || (combine == NULL) || (element_size == 0) || (result == NULL))
+        return false;
+
+#ifndef STATION_IS_CONCURRENT_PROCESSING_SUPPORTED
+    (void) context;
+    (void) batch_size;
+    (void) busy_wait;
+
+    if (identity != NULL)
+        memcpy(result, identity, element_size);
+    else
+        memset(result, 0, element_size);
+
+    for (station_task_idx_t task_idx = 0; task_idx < num_tasks; task_idx++)
+        accumulate(pfunc_data, result, task_idx, 0);
+
+    if (callback != NULL)
+        callback(callback_data, 0);
+
+    return true;
+#else
+    if (context == NULL)
+        return false;
+    else if (num_tasks == 0)
+    {
+        if (identity != NULL)
+            memcpy(result, identity, element_size);
+        else
+            memset(result, 0, element_size);
+
+        if (callback != NULL)
+            callback(callback_data, 0);
+
+        return true;
+    }
+
+    // Allocate the reduction with partial results of all possible participants
+    size_t num_partials = (size_t)context->num_threads + 1;
+
+    size_t header_size = (sizeof(struct station_concurrent_processing_reduction) +
+            CACHE_LINE_SIZE - 1) / CACHE_LINE_SIZE * CACHE_LINE_SIZE;
+
+    if (element_size > SIZE_MAX - CACHE_LINE_SIZE)
+        return false;
+
+    size_t partial_stride = (element_size + CACHE_LINE_SIZE - 1) / CACHE_LINE_SIZE * CACHE_LINE_SIZE;
+
+    if (partial_stride > (SIZE_MAX / 2 - header_size) / num_partials)
+        return false;
+
+    size_t nodes_size = (sizeof(atomic_flag) * num_partials +
+            CACHE_LINE_SIZE - 1) / CACHE_LINE_SIZE * CACHE_LINE_SIZE;
+
+    unsigned char *memory = aligned_alloc(CACHE_LINE_SIZE,
+            header_size + partial_stride * num_partials + nodes_size);
+    if (memory == NULL)
+        return false;
+
+    struct station_concurrent_processing_reduction *reduction = (void*)memory;
+    *reduction = (struct station_concurrent_processing_reduction){
+        .accumulate = accumulate,
+        .combine = combine,
+        .data = pfunc_data,
+        .partials = memory + header_size,
+        .partial_stride = partial_stride,
+        .nodes = (void*)(memory + header_size + partial_stride * num_partials),
+        .element_size = element_size,
+        .result = result,
+        .callback = callback,
+        .callback_data = callback_data,
+    };
+
+    for (size_t i = 0; i < num_partials; i++)
+    {
+        if (identity != NULL)
+            memcpy(reduction->partials + i * partial_stride, identity, element_size);
+        else
+            memset(reduction->partials + i * partial_stride, 0, element_size);
+
+        atomic_flag_clear_explicit(&reduction->nodes[i], memory_order_relaxed);
+    }
+
+    // Reduction is freed by the callback if the call is non-blocking
+    bool success = station_concurrent_processing_execute_assignment(context,
+            (struct station_concurrent_processing_assignment){
+                .pfunc_range = station_concurrent_processing_pfunc_reduction,
+                .pfunc_range_data = reduction,
+                .callback = (callback != NULL) ?
+                    station_concurrent_processing_reduction_callback : NULL,
+                .callback_data = reduction,
+                .finish = station_concurrent_processing_reduction_finish,
+                .finish_data = reduction,
+                .cost_key = (void (*)(void))accumulate,
+                .num_tasks = num_tasks, .batch_size = batch_size,
+            }, busy_wait);
+
+    if (!success || (callback == NULL))
+        free(reduction);
+
+    return success;
+#endif
+}
+
+// Parameters of parallel algorithms
+#define ALGORITHM_CHUNKS_PER_THREAD 4 // number of chunks per participating thread for load balancing
+#define ALGORITHM_MIN_CHUNK_SIZE 4096 // minimum number of elements in a chunk
+#define ALGORITHM_MIN_COPY_CHUNK_SIZE (1 << 16) // minimum number of bytes in a chunk of memory copying
+#define ALGORITHM_ALIGNMENT 64 // alignment of per-chunk and per-thread data (cache line size)
+#define ALGORITHM_RADIX_BITS 8 // number of key bits sorted by a pass of radix sort
+#define ALGORITHM_RADIX (1 << ALGORITHM_RADIX_BITS)
+
+// Round up to multiple of ALGORITHM_ALIGNMENT
+#define ALGORITHM_ALIGN(size) (((size) + ALGORITHM_ALIGNMENT - 1) / ALGORITHM_ALIGNMENT * ALGORITHM_ALIGNMENT)
+
+static
+size_t
+station_concurrent_processing_num_chunks(
+        const station_concurrent_processing_context_t *context,
+        size_t num_elements,
+        size_t min_chunk_size)
+{
+    size_t max_num_chunks = 1;
+
+#ifdef STATION_IS_CONCURRENT_PROCESSING_SUPPORTED
+    max_num_chunks = ((size_t)context->num_threads + 1) * ALGORITHM_CHUNKS_PER_THREAD;
+#else
+    (void) context;
+#endif
+
+    size_t num_chunks = (num_elements - 1) / min_chunk_size + 1;
+    return (num_chunks < max_num_chunks) ? num_chunks : max_num_chunks;
+}
+
+// Index of the first element of a chunk, chunk sizes differ by no more than 1
+static inline
+size_t
+station_concurrent_processing_chunk_begin(
+        size_t num_elements,
+        size_t num_chunks,
+        size_t chunk_idx)
+{
+    size_t remainder = num_elements % num_chunks;
+    return num_elements / num_chunks * chunk_idx + ((chunk_idx < remainder) ? chunk_idx : remainder);
+}
+
+static inline
+void
+station_concurrent_processing_copy_element(
+        unsigned char *restrict dest,
+        const unsigned char *restrict src,
+        size_t size)
+{
+    // Let the compiler inline copying of common sizes
+    switch (size)
+    {
+        case 4:
+            memcpy(dest, src, 4);
+            break;
+
+        case 8:
+            memcpy(dest, src, 8);
+            break;
+
+        default:
+            memcpy(dest, src, size);
+    }
+}
+
+// Process chunks by threads of the context, each chunk is a task
+static
+bool
+station_concurrent_processing_run_chunks(
+        station_concurrent_processing_context_t *context,
+        station_pfunc_range_t pfunc_range,
+        void *data,
+        size_t num_chunks,
+        bool busy_wait)
+{
+#ifndef STATION_IS_CONCURRENT_PROCESSING_SUPPORTED
+    (void) context;
+    (void) busy_wait;
+
+    pfunc_range(data, 0, num_chunks, 0);
+    return true;
+#else
+    return station_concurrent_processing_execute_assignment(context,
+            (struct station_concurrent_processing_assignment){
+                .pfunc_range = pfunc_range,
+                .pfunc_range_data = data,
+                .num_tasks = num_chunks, .batch_size = 1,
+                .schedule = STATION_CONCURRENT_PROCESSING_SCHEDULE_DYNAMIC,
+                .fixed_schedule = true,
+                .uncancellable = true, // results must be complete
+            }, busy_wait);
+#endif
+}
+
+struct station_concurrent_processing_copy {
+    unsigned char *dest;
+    const unsigned char *src; // NULL if memory is filled
+    int value;
+
+    size_t size;
+    size_t num_chunks;
+};
+
+static
+STATION_PFUNC_RANGE(station_concurrent_processing_pfunc_copy)
+{
+    (void) thread_idx;
+
+    const struct station_concurrent_processing_copy *copy = data;
+
+    // Chunks consist of whole cache lines, so that threads don't write to the same ones
+    size_t num_lines = (copy->size - 1) / ALGORITHM_ALIGNMENT + 1;
+
+    size_t begin = station_concurrent_processing_chunk_begin(
+            num_lines, copy->num_chunks, task_idx_begin) * ALGORITHM_ALIGNMENT;
+    size_t end = station_concurrent_processing_chunk_begin(
+            num_lines, copy->num_chunks, task_idx_end) * ALGORITHM_ALIGNMENT;
+
+    if (end > copy->size)
+        end = copy->size;
+
+    if (copy->src != NULL)
+        memcpy(copy->dest + begin, copy->src + begin, end - begin);
+    else
+        memset(copy->dest + begin, copy->value, end - begin);
+}
+
+static
+bool
+station_concurrent_processing_copy(
+        station_concurrent_processing_context_t *context,
+        void *dest,
+        const void *src,
+        int value,
+        size_t size,
+        bool busy_wait)
+{
+    if (context == NULL)
+        return false;
+    else if (size == 0)
+        return true;
+    else if (dest == NULL)
+        return false;
+
+    struct station_concurrent_processing_copy copy = {
+        .dest = dest,
+        .src = src,
+        .value = value,
+        .size = size,
+        .num_chunks = station_concurrent_processing_num_chunks(context,
+                (size - 1) / ALGORITHM_ALIGNMENT + 1, ALGORITHM_MIN_COPY_CHUNK_SIZE / ALGORITHM_ALIGNMENT),
+    };
+
+    return station_concurrent_processing_run_chunks(context,
+            station_concurrent_processing_pfunc_copy, &copy, copy.num_chunks, busy_wait);
+}
+
+bool
+station_concurrent_processing_memcpy(
+        station_concurrent_processing_context_t *context,
+        void *dest,
+        const void *src,
+        size_t size,
+        bool busy_wait)
+{
+    if ((size > 0) && (src == NULL))
+        return false;
+
+    return station_concurrent_processing_copy(context, dest, src, 0, size, busy_wait);
+}
+
+bool
+station_concurrent_processing_memset(
+        station_concurrent_processing_context_t *context,
+        void *dest,
+        int value,
+        size_t size,
+        bool busy_wait)
+{
+    return station_concurrent_processing_copy(context, dest, NULL, value, size, busy_wait);
+}
+
+struct station_concurrent_processing_scan {
+    const unsigned char *input;
+    unsigned char *output;
+
+    size_t num_elements;
+    size_t element_size;
+    size_t num_chunks;
+
+    station_pfunc_combine_t combine;
+    void *data;
+    const void *identity;
+    bool inclusive;
+
+    unsigned char *sums; // totals of chunks, then combinations of preceding elements, each in own cache lines
+    unsigned char *temps; // temporary elements of threads, each in own cache lines
+    size_t stride;
+};
+
+static
+STATION_PFUNC_RANGE(station_concurrent_processing_pfunc_scan_reduce)
+{
+    (void) thread_idx;
+
+    const struct station_concurrent_processing_scan *scan = data;
+
+    for (station_task_idx_t chunk_idx = task_idx_begin; chunk_idx < task_idx_end; chunk_idx++)
+    {
+        unsigned char *sum = scan->sums + chunk_idx * scan->stride;
+
+        size_t begin = station_concurrent_processing_chunk_begin(scan->num_elements, scan->num_chunks, chunk_idx);
+        size_t end = station_concurrent_processing_chunk_begin(scan->num_elements, scan->num_chunks, chunk_idx + 1);
+
+        memcpy(sum, scan->identity, scan->element_size);
+
+        for (size_t i = begin; i < end; i++)
+            scan->combine(scan->data, sum, scan->input + i * scan->element_size);
+    }
+}
+
+static
+STATION_PFUNC_RANGE(station_concurrent_processing_pfunc_scan_apply)
+{
+    const struct station_concurrent_processing_scan *scan = data;
+
+    unsigned char *temp = scan->temps + thread_idx * scan->stride;
+
+    for (station_task_idx_t chunk_idx = task_idx_begin; chunk_idx < task_idx_end; chunk_idx++)
+    {
+        unsigned char *sum = scan->sums + chunk_idx * scan->stride;
+
+        size_t begin = station_concurrent_processing_chunk_begin(scan->num_elements, scan->num_chunks, chunk_idx);
+        size_t end = station_concurrent_processing_chunk_begin(scan->num_elements, scan->num_chunks, chunk_idx + 1);
+
+        // Input element is read before output element is written, so that scan can be done in place
+        if (scan->inclusive)
+            for (size_t i = begin; i < end; i++)
+            {
+                scan->combine(scan->data, sum, scan->input + i * scan->element_size);
+                memcpy(scan->output + i * scan->element_size, sum, scan->element_size);
+            }
+        else
+            for (size_t i = begin; i < end; i++)
+            {
+                memcpy(temp, scan->input + i * scan->element_size, scan->element_size);
+                memcpy(scan->output + i * scan->element_size, sum, scan->element_size);
+                scan->combine(scan->data, sum, temp);
+            }
+    }
+}
+
+bool
+station_concurrent_processing_scan(
+        station_concurrent_processing_context_t *context,
+
+        const void *input,
+        void *output,
+        size_t num_elements,
+        size_t element_size,
+
+        station_pfunc_combine_t combine,
+        void *combine_data,
+        const void *identity,
+        bool inclusive,
+
+        bool busy_wait)
+{
+    if ((context == NULL) || (combine == NULL) || (element_size == 0))
+        return false;
+    else if (num_elements == 0)
+        return true;
+    else if ((input == NULL) || (output == NULL) || (num_elements > SIZE_MAX / element_size))
+        return false;
+
+    struct station_concurrent_processing_scan scan = {
+        .input = input,
+        .output = output,
+        .num_elements = num_elements,
+        .element_size = element_size,
+        .num_chunks = station_concurrent_processing_num_chunks(context, num_elements, ALGORITHM_MIN_CHUNK_SIZE),
+        .combine = combine,
+        .data = combine_data,
+        .inclusive = inclusive,
+    };
+
+    if (element_size > SIZE_MAX - ALGORITHM_ALIGNMENT)
+        return false;
+
+    scan.stride = ALGORITHM_ALIGN(element_size);
+
+    // Sums of chunks, temporary elements of all possible participants, identity and two more temporary elements
+    size_t num_temps = (size_t)context->num_threads + 1;
+    size_t num_slots = scan.num_chunks + num_temps + 3;
+
+    if (scan.stride > SIZE_MAX / num_slots)
+        return false;
+
+    unsigned char *memory = aligned_alloc(ALGORITHM_ALIGNMENT, scan.stride * num_slots);
+    if (memory == NULL)
+        return false;
+
+    scan.sums = memory;
+    scan.temps = scan.sums + scan.num_chunks * scan.stride;
+
+    unsigned char *identity_copy = scan.temps + num_temps * scan.stride;
+    unsigned char *carry = identity_copy + scan.stride;
+    unsigned char *temp = carry + scan.stride;
+
+    if (identity != NULL)
+        memcpy(identity_copy, identity, element_size);
+    else
+        memset(identity_copy, 0, element_size);
+
+    scan.identity = identity_copy;
+
+    bool success = true;
+
+    if (scan.num_chunks == 1)
+        memcpy(scan.sums, identity_copy, element_size);
+    else
+    {
+        // Compute totals of chunks
+        success = station_concurrent_processing_run_chunks(context,
+                station_concurrent_processing_pfunc_scan_reduce, &scan, scan.num_chunks, busy_wait);
+
+        // Replace totals of chunks with combinations of preceding chunks
+        memcpy(carry, identity_copy, element_size);
+
+        for (size_t chunk_idx = 0; success && (chunk_idx < scan.num_chunks); chunk_idx++)
+        {
+            unsigned char *sum = scan.sums + chunk_idx * scan.stride;
+
+            memcpy(temp, sum, element_size);
+            memcpy(sum, carry, element_size);
+            combine(combine_data, carry, temp);
+        }
+    }
+
+    // Scan chunks starting with combinations of preceding chunks
+    if (success)
+        success = station_concurrent_processing_run_chunks(context,
+                station_concurrent_processing_pfunc_scan_apply, &scan, scan.num_chunks, busy_wait);
+
+    free(memory);
+    return success;
+}
+
+struct station_concurrent_processing_radix_sort {
+    unsigned char *keys[2]; // source and destination of the current pass
+    unsigned char *payloads[2];
+
+    size_t num_elements;
+    size_t key_size;
+    size_t payload_size;
+    size_t num_chunks;
+
+    unsigned shift; // first sorted key bit of the current pass
+
+    size_t *counts; // per-chunk numbers of elements with every digit, then positions of them
+    size_t counts_stride;
+};
+
+static inline
+size_t
+station_concurrent_processing_radix_digit(
+        const struct station_concurrent_processing_radix_sort *sort,
+        const unsigned char *keys,
+        size_t element_idx)
+{
+    uint64_t key = (sort->key_size == sizeof(uint32_t)) ?
+        ((const uint32_t*)keys)[element_idx] : ((const uint64_t*)keys)[element_idx];
+
+    return (key >> sort->shift) & (ALGORITHM_RADIX - 1);
+}
+
+static
+STATION_PFUNC_RANGE(station_concurrent_processing_pfunc_radix_count)
+{
+    (void) thread_idx;
+
+    const struct station_concurrent_processing_radix_sort *sort = data;
+
+    for (station_task_idx_t chunk_idx = task_idx_begin; chunk_idx < task_idx_end; chunk_idx++)
+    {
+        size_t *counts = sort->counts + chunk_idx * sort->counts_stride;
+
+        size_t begin = station_concurrent_processing_chunk_begin(sort->num_elements, sort->num_chunks, chunk_idx);
+        size_t end = station_concurrent_processing_chunk_begin(sort->num_elements, sort->num_chunks, chunk_idx + 1);
+
+        for (size_t digit = 0; digit < ALGORITHM_RADIX; digit++)
+            counts[digit] = 0;
+
+        for (size_t i = begin; i < end; i++)
+            counts[station_concurrent_processing_radix_digit(sort, sort->keys[0], i)]++;
+    }
+}
+
+static
+STATION_PFUNC_RANGE(station_concurrent_processing_pfunc_radix_scatter)
+{
+    (void) thread_idx;
+
+    const struct station_concurrent_processing_radix_sort *sort = data;
+
+    for (station_task_idx_t chunk_idx = task_idx_begin; chunk_idx < task_idx_end; chunk_idx++)
+    {
+        size_t *positions = sort->counts + chunk_idx * sort->counts_stride;
+
+        size_t begin = station_concurrent_processing_chunk_begin(sort->num_elements, sort->num_chunks, chunk_idx);
+        size_t end = station_concurrent_processing_chunk_begin(sort->num_elements, sort->num_chunks, chunk_idx + 1);
+
+        for (size_t i = begin; i < end; i++)
+        {
+            size_t j = positions[station_concurrent_processing_radix_digit(sort, sort->keys[0], i)]++;
+
+            station_concurrent_processing_copy_element(sort->keys[1] + j * sort->key_size,
+                    sort->keys[0] + i * sort->key_size, sort->key_size);
+
+            if (sort->payload_size > 0)
+                station_concurrent_processing_copy_element(sort->payloads[1] + j * sort->payload_size,
+                        sort->payloads[0] + i * sort->payload_size, sort->payload_size);
+        }
+    }
+}
+
+bool
+station_concurrent_processing_radix_sort(
+        station_concurrent_processing_context_t *context,
+
+        void *keys,
+        size_t key_size,
+        void *payloads,
+        size_t payload_size,
+        size_t num_elements,
+
+        bool busy_wait)
+{
+    if ((context == NULL) || ((key_size != sizeof(uint32_t)) && (key_size != sizeof(uint64_t))))
+        return false;
+    else if (num_elements < 2)
+        return true;
+    else if ((keys == NULL) || (num_elements > SIZE_MAX / key_size))
+        return false;
+
+    if (payloads == NULL)
+        payload_size = 0;
+    else if ((payload_size > 0) && (num_elements > SIZE_MAX / payload_size))
+        return false;
+
+    struct station_concurrent_processing_radix_sort sort = {
+        .keys = {keys, malloc(num_elements * key_size)},
+        .payloads = {payloads, (payload_size > 0) ? malloc(num_elements * payload_size) : NULL},
+        .num_elements = num_elements,
+        .key_size = key_size,
+        .payload_size = payload_size,
+        .num_chunks = station_concurrent_processing_num_chunks(context, num_elements, ALGORITHM_MIN_CHUNK_SIZE),
+        .counts_stride = ALGORITHM_ALIGN(sizeof(size_t) * ALGORITHM_RADIX) / sizeof(size_t),
+    };
+
+    sort.counts = aligned_alloc(ALGORITHM_ALIGNMENT, sizeof(size_t) * sort.counts_stride * sort.num_chunks);
+
+    bool success = (sort.keys[1] != NULL) && ((payload_size == 0) || (sort.payloads[1] != NULL)) &&
+        (sort.counts != NULL);
+
+    for (sort.shift = 0; success && (sort.shift < key_size * CHAR_BIT); sort.shift += ALGORITHM_RADIX_BITS)
+    {
+        // Count digits in chunks
+        success = station_concurrent_processing_run_chunks(context,
+                station_concurrent_processing_pfunc_radix_count, &sort, sort.num_chunks, busy_wait);
+        if (!success)
+            break;
+
+        // Skip the pass if all keys have the same digit
+        bool same_digit = false;
+
+        for (size_t digit = 0; digit < ALGORITHM_RADIX; digit++)
+        {
+            size_t total = 0;
+
+            for (size_t chunk_idx = 0; chunk_idx < sort.num_chunks; chunk_idx++)
+                total += sort.counts[chunk_idx * sort.counts_stride + digit];
+
+            if (total != 0)
+            {
+                same_digit = (total == num_elements);
+                break;
+            }
+        }
+
+        if (same_digit)
+            continue;
+
+        // Compute positions of the first elements with every digit in chunks,
+        // elements with the same digit keep their order
+        size_t position = 0;
+
+        for (size_t digit = 0; digit < ALGORITHM_RADIX; digit++)
+            for (size_t chunk_idx = 0; chunk_idx < sort.num_chunks; chunk_idx++)
+            {
+                size_t count = sort.counts[chunk_idx * sort.counts_stride + digit];
+                sort.counts[chunk_idx * sort.counts_stride + digit] = position;
+                position += count;
+            }
+
+        // Move elements to their positions
+        success = station_concurrent_processing_run_chunks(context,
+                station_concurrent_processing_pfunc_radix_scatter, &sort, sort.num_chunks, busy_wait);
+        if (!success)
+            break;
+
+        unsigned char *swap = sort.keys[0];
+        sort.keys[0] = sort.keys[1];
+        sort.keys[1] = swap;
+
+        swap = sort.payloads[0];
+        sort.payloads[0] = sort.payloads[1];
+        sort.payloads[1] = swap;
+    }
+
+    // Move sorted elements back from temporary memory
+    if (success && (sort.keys[0] != keys))
+    {
+        success = station_concurrent_processing_memcpy(context, keys, sort.keys[0],
+                num_elements * key_size, busy_wait);
+
+        if (success && (payload_size > 0))
+            success = station_concurrent_processing_memcpy(context, payloads, sort.payloads[0],
+                    num_elements * payload_size, busy_wait);
+    }
+
+    free(sort.counts);
+    free((sort.keys[0] != keys) ? sort.keys[0] : sort.keys[1]);
+    free((sort.payloads[0] != payloads) ? sort.payloads[0] : sort.payloads[1]);
+
+    return success;
+}
+
+struct station_concurrent_processing_histogram {
+    station_pfunc_bin_t bin;
+    void *data;
+
+    size_t num_elements;
+    size_t num_chunks;
+    size_t num_bins;
+    size_t num_bin_chunks;
+
+    size_t *partials; // partial histograms of threads, each in own cache lines
+    size_t partials_stride;
+    size_t num_partials;
+
+    size_t *histogram;
+};
+
+static
+STATION_PFUNC_RANGE(station_concurrent_processing_pfunc_histogram_count)
+{
+    const struct station_concurrent_processing_histogram *histogram = data;
+
+    size_t *partial = histogram->partials + thread_idx * histogram->partials_stride;
+
+    for (station_task_idx_t chunk_idx = task_idx_begin; chunk_idx < task_idx_end; chunk_idx++)
+    {
+        size_t begin = station_concurrent_processing_chunk_begin(
+                histogram->num_elements, histogram->num_chunks, chunk_idx);
+        size_t end = station_concurrent_processing_chunk_begin(
+                histogram->num_elements, histogram->num_chunks, chunk_idx + 1);
+
+        for (size_t i = begin; i < end; i++)
+        {
+            size_t bin = histogram->bin(histogram->data, i);
+
+            if (bin < histogram->num_bins)
+                partial[bin]++;
+        }
+    }
+}
+
+static
+STATION_PFUNC_RANGE(station_concurrent_processing_pfunc_histogram_merge)
+{
+    (void) thread_idx;
+
+    const struct station_concurrent_processing_histogram *histogram = data;
+
+    size_t begin = station_concurrent_processing_chunk_begin(
+            histogram->num_bins, histogram->num_bin_chunks, task_idx_begin);
+    size_t end = station_concurrent_processing_chunk_begin(
+            histogram->num_bins, histogram->num_bin_chunks, task_idx_end);
+
+    for (size_t bin = begin; bin < end; bin++)
+    {
+        size_t count = 0;
+
+        for (size_t i = 0; i < histogram->num_partials; i++)
+            count += histogram->partials[i * histogram->partials_stride + bin];
+
+        histogram->histogram[bin] = count;
+    }
+}
+
+bool
+station_concurrent_processing_histogram(
+        station_concurrent_processing_context_t *context,
+
+        size_t num_elements,
+        station_pfunc_bin_t bin,
+        void *bin_data,
+
+        size_t num_bins,
+        size_t *histogram,
+
+        bool busy_wait)
+{
+    if ((context == NULL) || (bin == NULL) || (num_bins == 0) || (histogram == NULL))
+        return false;
+    else if (num_elements == 0)
+    {
+        memset(histogram, 0, sizeof(*histogram) * num_bins);
+        return true;
+    }
+    else if (num_bins > (SIZE_MAX - ALGORITHM_ALIGNMENT) / sizeof(size_t))
+        return false;
+
+    struct station_concurrent_processing_histogram state = {
+        .bin = bin,
+        .data = bin_data,
+        .num_elements = num_elements,
+        .num_chunks = station_concurrent_processing_num_chunks(context, num_elements, ALGORITHM_MIN_CHUNK_SIZE),
+        .num_bins = num_bins,
+        .num_bin_chunks = station_concurrent_processing_num_chunks(context, num_bins, ALGORITHM_MIN_CHUNK_SIZE),
+        .partials_stride = ALGORITHM_ALIGN(sizeof(size_t) * num_bins) / sizeof(size_t),
+        .num_partials = (size_t)context->num_threads + 1, // all possible participants
+        .histogram = histogram,
+    };
+
+    if (state.partials_stride > SIZE_MAX / sizeof(size_t) / state.num_partials)
+        return false;
+
+    size_t partials_size = sizeof(size_t) * state.partials_stride * state.num_partials;
+
+    state.partials = aligned_alloc(ALGORITHM_ALIGNMENT, partials_size);
+    if (state.partials == NULL)
+        return false;
+
+    memset(state.partials, 0, partials_size);
+
+    // Count elements in partial histograms of threads, then sum them
+    bool success = station_concurrent_processing_run_chunks(context,
+            station_concurrent_processing_pfunc_histogram_count, &state, state.num_chunks, busy_wait) &&
+        station_concurrent_processing_run_chunks(context,
+            station_concurrent_processing_pfunc_histogram_merge, &state, state.num_bin_chunks, busy_wait);
+
+    free(state.partials);
+    return success;
+}
+
+struct station_concurrent_processing_compaction {
+    station_pfunc_predicate_t predicate;
+    void *data;
+
+    const unsigned char *input;
+    unsigned char *output;
+
+    size_t num_elements;
+    size_t element_size;
+    size_t num_chunks;
+
+    size_t *counts; // numbers of selected elements of chunks, then their positions
+};
+
+static
+STATION_PFUNC_RANGE(station_concurrent_processing_pfunc_compaction_count)
+{
+    (void) thread_idx;
+
+    const struct station_concurrent_processing_compaction *compaction = data;
+
+    for (station_task_idx_t chunk_idx = task_idx_begin; chunk_idx < task_idx_end; chunk_idx++)
+    {
+        size_t begin = station_concurrent_processing_chunk_begin(
+                compaction->num_elements, compaction->num_chunks, chunk_idx);
+        size_t end = station_concurrent_processing_chunk_begin(
+                compaction->num_elements, compaction->num_chunks, chunk_idx + 1);
+
+        size_t count = 0;
+
+        for (size_t i = begin; i < end; i++)
+            if (compaction->predicate(compaction->data, i))
+                count++;
+
+        compaction->counts[chunk_idx] = count;
+    }
+}
+
+static
+STATION_PFUNC_RANGE(station_concurrent_processing_pfunc_compaction_move)
+{
+    (void) thread_idx;
+
+    const struct station_concurrent_processing_compaction *compaction = data;
+
+    for (station_task_idx_t chunk_idx = task_idx_begin; chunk_idx < task_idx_end; chunk_idx++)
+    {
+        size_t begin = station_concurrent_processing_chunk_begin(
+                compaction->num_elements, compaction->num_chunks, chunk_idx);
+        size_t end = station_concurrent_processing_chunk_begin(
+                compaction->num_elements, compaction->num_chunks, chunk_idx + 1);
+
+        size_t j = compaction->counts[chunk_idx];
+
+        for (size_t i = begin; i < end; i++)
+            if (compaction->predicate(compaction->data, i))
+                station_concurrent_processing_copy_element(
+                        compaction->output + (j++) * compaction->element_size,
+                        compaction->input + i * compaction->element_size, compaction->element_size);
+    }
+}
+
+bool
+station_concurrent_processing_compact(
+        station_concurrent_processing_context_t *context,
+
+        const void *input,
+        void *output,
+        size_t num_elements,
+        size_t element_size,
+
+        station_pfunc_predicate_t predicate,
+        void *predicate_data,
+
+        size_t *num_selected,
+
+        bool busy_wait)
+{
+    if ((context == NULL) || (predicate == NULL) || (element_size == 0))
+        return false;
+    else if (num_elements == 0)
+    {
+        if (num_selected != NULL)
+            *num_selected = 0;
+
+        return true;
+    }
+    else if ((input == NULL) || (output == NULL) || (num_elements > SIZE_MAX / element_size))
+        return false;
+
+    struct station_concurrent_processing_compaction compaction = {
+        .predicate = predicate,
+        .data = predicate_data,
+        .input = input,
+        .output = output,
+        .num_elements = num_elements,
+        .element_size = element_size,
+        .num_chunks = station_concurrent_processing_num_chunks(context, num_elements, ALGORITHM_MIN_CHUNK_SIZE),
+    };
+
+    compaction.counts = malloc(sizeof(*compaction.counts) * compaction.num_chunks);
+    if (compaction.counts == NULL)
+        return false;
+
+    // Count selected elements of chunks
+    bool success = station_concurrent_processing_run_chunks(context,
+            station_concurrent_processing_pfunc_compaction_count, &compaction, compaction.num_chunks, busy_wait);
+
+    if (success)
+    {
+        // Compute positions of the first selected elements of chunks
+        size_t position = 0;
+
+        for (size_t chunk_idx = 0; chunk_idx < compaction.num_chunks; chunk_idx++)
+        {
+            size_t count = compaction.counts[chunk_idx];
+            compaction.counts[chunk_idx] = position;
+            position += count;
+        }
+
+        // Move selected elements to their positions
+        success = station_concurrent_processing_run_chunks(context,
+                station_concurrent_processing_pfunc_compaction_move, &compaction, compaction.num_chunks, busy_wait);
+
+        if (success && (num_selected != NULL))
+            *num_selected = position;
+    }
+
+    free(compaction.counts);
+    return success;
+}
+
+#ifdef STATION_IS_CONCURRENT_PROCESSING_SUPPORTED
+
+struct station_concurrent_processing_graph_node_state {
+    _Alignas(CACHE_LINE_SIZE) atomic_uint_least64_t next_task; // first task not yet acquired by threads
+    atomic_uint done_tasks;
+    atomic_size_t num_pending; // number of dependencies not yet done
+
+    station_tasks_number_t batch_size;
+};
+
+#endif // STATION_IS_CONCURRENT_PROCESSING_SUPPORTED
+
+struct station_concurrent_processing_graph {
+    size_t num_nodes;
+    station_concurrent_processing_graph_node_t *nodes;
+
+    size_t *order; // topological order of nodes, starts with nodes without dependencies
+    size_t num_initial; // number of nodes without dependencies
+
+    size_t *successors_begin; // successors of node i are successors[successors_begin[i]; successors_begin[i+1])
+    size_t *successors;
+
+#ifdef STATION_IS_CONCURRENT_PROCESSING_SUPPORTED
+    struct station_concurrent_processing_graph_node_state *states;
+
+    atomic_size_t *ready; // nodes in the order of becoming ready, SIZE_MAX if not yet written
+    _Alignas(CACHE_LINE_SIZE) atomic_size_t num_ready;
+    _Alignas(CACHE_LINE_SIZE) atomic_size_t num_done;
+
+    struct station_concurrent_processing_threads_state *threads_state; // of the context running the graph
+    struct station_concurrent_processing_event progress; // signaled when a node is done
+#endif
+};
+
+struct station_concurrent_processing_graph*
+station_concurrent_processing_create_graph(
+        const station_concurrent_processing_graph_node_t *nodes,
+        size_t num_nodes)
+{
+    if ((nodes == NULL) || (num_nodes == 0) || (num_nodes == SIZE_MAX))
+        return NULL;
+
+    size_t num_edges = 0;
+
+    for (size_t i = 0; i < num_nodes; i++)
+    {
+        if ((nodes[i].pfunc == NULL) == (nodes[i].pfunc_range == NULL))
+            return NULL;
+        else if (nodes[i].num_tasks == 0)
+            return NULL;
+        else if ((nodes[i].num_dependencies > 0) && (nodes[i].dependencies == NULL))
+            return NULL;
+
+        for (size_t j = 0; j < nodes[i].num_dependencies; j++)
+            if (nodes[i].dependencies[j] >= num_nodes)
+                return NULL;
+
+        if (nodes[i].num_dependencies > SIZE_MAX / sizeof(size_t) - num_edges)
+            return NULL;
+
+        num_edges += nodes[i].num_dependencies;
+    }
+
+#ifndef STATION_IS_CONCURRENT_PROCESSING_SUPPORTED
+    struct station_concurrent_processing_graph *graph = malloc(sizeof(*graph));
+#else
+    struct station_concurrent_processing_graph *graph = aligned_alloc(CACHE_LINE_SIZE,
+            (sizeof(*graph) + CACHE_LINE_SIZE - 1) / CACHE_LINE_SIZE * CACHE_LINE_SIZE);
+#endif
+    if (graph == NULL)
+        return NULL;
+
+    graph->num_nodes = num_nodes;
+    graph->nodes = malloc(sizeof(*graph->nodes) * num_nodes);
+    graph->order = malloc(sizeof(*graph->order) * num_nodes);
+    graph->successors_begin = calloc(num_nodes + 1, sizeof(*graph->successors_begin));
+    graph->successors = malloc(sizeof(*graph->successors) * (num_edges > 0 ? num_edges : 1));
+
+#ifdef STATION_IS_CONCURRENT_PROCESSING_SUPPORTED
+    graph->states = aligned_alloc(CACHE_LINE_SIZE, sizeof(*graph->states) * num_nodes);
+    graph->ready = malloc(sizeof(*graph->ready) * num_nodes);
+
+    if ((graph->states == NULL) || (graph->ready == NULL))
+        goto failure;
+#endif
+
+    if ((graph->nodes == NULL) || (graph->order == NULL) ||
+            (graph->successors_begin == NULL) || (graph->successors == NULL))
+        goto failure;
+
+    memcpy(graph->nodes, nodes, sizeof(*graph->nodes) * num_nodes);
+
+    // Build lists of successors
+    for (size_t i = 0; i < num_nodes; i++)
+        for (size_t j = 0; j < nodes[i].num_dependencies; j++)
+            graph->successors_begin[nodes[i].dependencies[j] + 1]++;
+
+    for (size_t i = 0; i < num_nodes; i++)
+        graph->successors_begin[i + 1] += graph->successors_begin[i];
+
+    // order is used as temporary array of positions of next successors
+    for (size_t i = 0; i < num_nodes; i++)
+        graph->order[i] = graph->successors_begin[i];
+
+    for (size_t i = 0; i < num_nodes; i++)
+        for (size_t j = 0; j < nodes[i].num_dependencies; j++)
+            graph->successors[graph->order[nodes[i].dependencies[j]]++] = i;
+
+    // Sort nodes topologically, dependencies are not needed anymore
+    size_t num_sorted = 0;
+
+    for (size_t i = 0; i < num_nodes; i++)
+    {
+        graph->nodes[i].dependencies = NULL;
+
+        if (nodes[i].num_dependencies == 0)
+            graph->order[num_sorted++] = i;
+    }
+
+    graph->num_initial = num_sorted;
+
+    // Number of not yet sorted dependencies is kept in the copy of a node
+    for (size_t i = 0; i < num_sorted; i++)
+    {
+        size_t node_idx = graph->order[i];
+
+        for (size_t j = graph->successors_begin[node_idx];
+                j < graph->successors_begin[node_idx + 1]; j++)
+        {
+            size_t successor_idx = graph->successors[j];
+
+            if (--graph->nodes[successor_idx].num_dependencies == 0)
+                graph->order[num_sorted++] = successor_idx;
+        }
+    }
+
+    if (num_sorted < num_nodes) // dependencies form a cycle
+        goto failure;
+
+    for (size_t i = 0; i < num_nodes; i++)
+        graph->nodes[i].num_dependencies = nodes[i].num_dependencies;
+
+#ifdef STATION_IS_CONCURRENT_PROCESSING_SUPPORTED
+    for (size_t i = 0; i < num_nodes; i++)
+    {
+        atomic_init(&graph->states[i].next_task, 0);
+        atomic_init(&graph->states[i].done_tasks, 0);
+        atomic_init(&graph->states[i].num_pending, 0);
+        graph->states[i].batch_size = 0;
+
+        atomic_init(&graph->ready[i], SIZE_MAX);
+    }
+
+    atomic_init(&graph->num_ready, 0);
+    atomic_init(&graph->num_done, 0);
+
+    graph->threads_state = NULL;
+    station_concurrent_processing_event_init(&graph->progress);
+#endif
+
+    return graph;
+
+failure:
+    station_concurrent_processing_destroy_graph(graph);
+    return NULL;
+}
+
+void
+station_concurrent_processing_destroy_graph(
+        struct station_concurrent_processing_graph *graph)
+{
+    if (graph == NULL)
+        return;
+
+    free(graph->nodes);
+    free(graph->order);
+    free(graph->successors_begin);
+    free(graph->successors);
+
+#ifdef STATION_IS_CONCURRENT_PROCESSING_SUPPORTED
+    free(graph->states);
+    free(graph->ready);
+#endif
+
+    free(graph);
+}
+
+#ifdef STATION_IS_CONCURRENT_PROCESSING_SUPPORTED
+
+static
+void
+station_concurrent_processing_graph_node_done(
+        struct station_concurrent_processing_graph *graph,
+        size_t node_idx)
+{
+    // Make successors without pending dependencies ready
+    for (size_t j = graph->successors_begin[node_idx]; j < graph->successors_begin[node_idx + 1]; j++)
+    {
+        size_t successor_idx = graph->successors[j];
+
+        if (atomic_fetch_sub_explicit(&graph->states[successor_idx].num_pending, 1,
+                    memory_order_acq_rel) == 1)
+        {
+            size_t ready_idx = atomic_fetch_add_explicit(&graph->num_ready, 1, memory_order_relaxed);
+            atomic_store_explicit(&graph->ready[ready_idx], successor_idx, memory_order_release);
+        }
+    }
+
+    atomic_fetch_add_explicit(&graph->num_done, 1, memory_order_release);
+
+    station_concurrent_processing_event_signal(graph->threads_state, &graph->progress);
+}
+
+// Called once by every participating thread, processes tasks until all nodes are done
+static
+STATION_PFUNC_RANGE(station_concurrent_processing_pfunc_graph)
+{
+    (void) task_idx_begin;
+    (void) task_idx_end;
+
+    struct station_concurrent_processing_graph *graph = data;
+    struct station_concurrent_processing_event_waiter waiter = {0};
+
+    size_t first_ready = 0; // nodes before it have no tasks left to acquire
+
+    while (atomic_load_explicit(&graph->num_done, memory_order_acquire) < graph->num_nodes)
+    {
+        bool acquired = false;
+        bool exhausted = true; // whether all checked nodes have no tasks left to acquire
+
+        size_t num_ready = atomic_load_explicit(&graph->num_ready, memory_order_relaxed);
+
+        // Take a batch from the earliest ready node
+        for (size_t i = first_ready; (i < num_ready) && !acquired; i++)
+        {
+            size_t node_idx = atomic_load_explicit(&graph->ready[i], memory_order_acquire);
+
+            if (node_idx == SIZE_MAX) // not yet written
+            {
+                exhausted = false;
+                continue;
+            }
+
+            const station_concurrent_processing_graph_node_t *node = &graph->nodes[node_idx];
+            struct station_concurrent_processing_graph_node_state *state = &graph->states[node_idx];
+
+            if (atomic_load_explicit(&state->next_task, memory_order_relaxed) < node->num_tasks)
+            {
+                uint_least64_t begin = atomic_fetch_add_explicit(
+                        &state->next_task, state->batch_size, memory_order_relaxed);
+
+                if (begin < node->num_tasks)
+                {
+                    station_task_idx_t end = (node->num_tasks - begin > state->batch_size) ?
+                        begin + state->batch_size : node->num_tasks;
+
+                    // Execute concurrent processing function
+                    if (node->pfunc_range != NULL)
+                        node->pfunc_range(node->pfunc_data, begin, end, thread_idx);
+                    else
+                        for (station_task_idx_t task_idx = begin; task_idx < end; task_idx++)
+                            node->pfunc(node->pfunc_data, task_idx, thread_idx);
+
+                    // The thread finishing the last batch completes the node
+                    if (atomic_fetch_add_explicit(&state->done_tasks, end - begin,
+                                memory_order_acq_rel) + (end - begin) == node->num_tasks)
+                        station_concurrent_processing_graph_node_done(graph, node_idx);
+
+                    acquired = true;
+                    continue;
+                }
+            }
+
+            if (exhausted)
+                first_ready = i + 1;
+        }
+
+        // Wait for new ready nodes
+        if (acquired)
+            station_concurrent_processing_event_busy(&graph->progress, &waiter);
+        else
+            station_concurrent_processing_event_idle(graph->threads_state, &graph->progress, &waiter);
+    }
+
+    station_concurrent_processing_event_busy(&graph->progress, &waiter);
+}
+
+#endif // STATION_IS_CONCURRENT_PROCESSING_SUPPORTED
+
+bool
+station_concurrent_processing_run_graph(
+        station_concurrent_processing_context_t *context,
+        struct station_concurrent_processing_graph *graph,
+
+        station_pfunc_callback_t callback,
+        void *callback_data,
+
+        bool busy_wait)
+{
+    if (graph == NULL)
+        return false;
+
 #ifndef STATION_IS_CONCURRENT_PROCESSING_SUPPORTED
     (void) context;
     (void) busy_wait;
 
-    if (num_threads > 0)
-        return -2;
+    // Process nodes one by one in topological order
+    for (size_t i = 0; i < graph->num_nodes; i++)
+    {
+        const station_concurrent_processing_graph_node_t *node = &graph->nodes[graph->order[i]];
 
-    context->state = NULL;
-    context->num_threads = 0;
+        if (node->pfunc_range != NULL)
+            node->pfunc_range(node->pfunc_data, 0, node->num_tasks, 0);
+        else
+            for (station_task_idx_t task_idx = 0; task_idx < node->num_tasks; task_idx++)
+                node->pfunc(node->pfunc_data, task_idx, 0);
+    }
 
-    return 0;
+    if (callback != NULL)
+        callback(callback_data, 0);
+
+    return true;
 #else
     if (context == NULL)
-        return -1;
+        return false;
 
-    // Initialize threads state
-    struct station_concurrent_processing_threads_state *threads_state = malloc(sizeof(*threads_state));
-    if (threads_state == NULL)
-        return 1;
+    // Reset state of the graph
+    station_threads_number_t num_threads = (context->num_threads > 0) ? context->num_threads : 1;
+
+    for (size_t i = 0; i < graph->num_nodes; i++)
+    {
+        const station_concurrent_processing_graph_node_t *node = &graph->nodes[i];
+        struct station_concurrent_processing_graph_node_state *state = &graph->states[i];
+
+        atomic_store_explicit(&state->next_task, 0, memory_order_relaxed);
+        atomic_store_explicit(&state->done_tasks, 0, memory_order_relaxed);
+        atomic_store_explicit(&state->num_pending, node->num_dependencies, memory_order_relaxed);
+
+        state->batch_size = (node->batch_size > 0) ? node->batch_size :
+            (node->num_tasks - 1) / num_threads + 1;
+
+        atomic_store_explicit(&graph->ready[i], (i < graph->num_initial) ?
+                graph->order[i] : SIZE_MAX, memory_order_relaxed);
+    }
+
+    atomic_store_explicit(&graph->num_ready, graph->num_initial, memory_order_relaxed);
+    atomic_store_explicit(&graph->num_done, 0, memory_order_relaxed);
+
+    graph->threads_state = context->state;
+
+    // Every participating thread gets at least one task, as there are more tasks than threads
+    return station_concurrent_processing_execute_assignment(context,
+            (struct station_concurrent_processing_assignment){
+                .pfunc_range = station_concurrent_processing_pfunc_graph,
+                .pfunc_range_data = graph,
+                .callback = callback, .callback_data = callback_data,
+                .num_tasks = (station_tasks_number_t)context->num_threads + 1, .batch_size = 1,
+                .schedule = STATION_CONCURRENT_PROCESSING_SCHEDULE_STATIC, .fixed_schedule = true,
+            }, busy_wait);
+#endif
+}
+
+#ifdef STATION_IS_CONCURRENT_PROCESSING_SUPPORTED
+
+struct station_concurrent_processing_pipeline_stage_state {
+    _Alignas(CACHE_LINE_SIZE) atomic_uint_least64_t num_items; // items processed by the stage function
+    atomic_uint_least64_t num_popped; // items popped from the input queue
+    atomic_uint_least64_t num_pushed; // items pushed to the output queue
+    atomic_uint_least64_t busy_ns;
+    atomic_uint_least64_t num_starved;
+    atomic_uint_least64_t num_blocked;
+    atomic_uint_least64_t total_occupancy; // sum of numbers of items in the output queue after pushes
+    atomic_uint_least64_t max_occupancy;
+
+    atomic_uint num_finished; // number of threads of the stage which are done
+    atomic_bool exhausted; // whether the source stage function has returned false
+
+    struct station_queue *output; // NULL for the last stage
+};
+
+// Thread bound to a stage
+struct station_concurrent_processing_pipeline_slot {
+    _Alignas(CACHE_LINE_SIZE) size_t stage_idx;
+
+    unsigned char *input; // item popped from the input queue
+    unsigned char *output; // item produced by the stage function
+
+    bool has_output; // whether the output item is waiting for space in the output queue
+    bool finished;
+};
+
+#endif // STATION_IS_CONCURRENT_PROCESSING_SUPPORTED
+
+struct station_concurrent_processing_pipeline {
+    size_t num_stages;
+    station_concurrent_processing_pipeline_stage_t *stages;
+
+    unsigned char *items; // memory of items of stages (or of slots)
+    size_t item_stride; // distance between items in memory
+
+#ifdef STATION_IS_CONCURRENT_PROCESSING_SUPPORTED
+    struct station_concurrent_processing_pipeline_stage_state *states;
+
+    struct station_concurrent_processing_pipeline_slot *slots;
+    size_t num_slots;
+
+    size_t num_workers; // number of tasks of the current run, slots are distributed between them
+
+    uint_least64_t start_ns;
+    atomic_uint_least64_t end_ns;
+
+    struct station_concurrent_processing_threads_state *threads_state; // of the context running the pipeline
+    struct station_concurrent_processing_event progress; // signaled when items move or slots finish
+#endif
+};
+
+struct station_concurrent_processing_pipeline*
+station_concurrent_processing_create_pipeline(
+        const station_concurrent_processing_pipeline_stage_t *stages,
+        size_t num_stages)
+{
+    if ((stages == NULL) || (num_stages == 0))
+        return NULL;
+
+    size_t num_slots = 0;
+
+    // Every item is placed in own cache lines with the strictest of required alignments
+    size_t item_alignment = ALGORITHM_ALIGNMENT;
+    size_t item_size = 0;
+
+    for (size_t i = 0; i < num_stages; i++)
+    {
+        if ((stages[i].pfunc == NULL) || (stages[i].num_threads == 0))
+            return NULL;
+
+        num_slots += stages[i].num_threads;
+
+        if (i == num_stages - 1) // last stage doesn't output items
+            break;
+
+        if (stages[i].output_alignment_log2 >= sizeof(size_t) * CHAR_BIT / 2)
+            return NULL;
+
+        if (((size_t)1 << stages[i].output_alignment_log2) > item_alignment)
+            item_alignment = (size_t)1 << stages[i].output_alignment_log2;
+
+        if (stages[i].output_size > item_size)
+            item_size = stages[i].output_size;
+    }
+
+    if (item_size > SIZE_MAX / 2 - item_alignment)
+        return NULL;
+
+    size_t item_stride = (item_size + item_alignment - 1) / item_alignment * item_alignment;
+    if (item_stride == 0)
+        item_stride = item_alignment;
+
+    // Sequentially, every stage has an output item.
+    // Concurrently, every slot has input and output items.
+#ifndef STATION_IS_CONCURRENT_PROCESSING_SUPPORTED
+    size_t num_items = num_stages;
+#else
+    size_t num_items = num_slots * 2;
+#endif
+
+    if (item_stride > SIZE_MAX / num_items)
+        return NULL;
+
+#ifndef STATION_IS_CONCURRENT_PROCESSING_SUPPORTED
+    struct station_concurrent_processing_pipeline *pipeline = malloc(sizeof(*pipeline));
+#else
+    struct station_concurrent_processing_pipeline *pipeline = aligned_alloc(CACHE_LINE_SIZE,
+            (sizeof(*pipeline) + CACHE_LINE_SIZE - 1) / CACHE_LINE_SIZE * CACHE_LINE_SIZE);
+#endif
+    if (pipeline == NULL)
+        return NULL;
+
+    pipeline->num_stages = num_stages;
+    pipeline->stages = malloc(sizeof(*pipeline->stages) * num_stages);
+    pipeline->items = aligned_alloc(item_alignment, item_stride * num_items);
+    pipeline->item_stride = item_stride;
+
+#ifdef STATION_IS_CONCURRENT_PROCESSING_SUPPORTED
+    pipeline->states = aligned_alloc(CACHE_LINE_SIZE, sizeof(*pipeline->states) * num_stages);
+    pipeline->slots = aligned_alloc(CACHE_LINE_SIZE, sizeof(*pipeline->slots) * num_slots);
+    pipeline->num_slots = num_slots;
+
+    if (pipeline->states != NULL)
+        for (size_t i = 0; i < num_stages; i++)
+            pipeline->states[i].output = NULL;
+#endif
+
+    if ((pipeline->stages == NULL) || (pipeline->items == NULL))
+        goto failure;
+
+    memcpy(pipeline->stages, stages, sizeof(*pipeline->stages) * num_stages);
+
+#ifndef STATION_IS_CONCURRENT_PROCESSING_SUPPORTED
+    (void) num_slots;
+#else
+    if ((pipeline->states == NULL) || (pipeline->slots == NULL))
+        goto failure;
+
+    // Create queues between stages
+    for (size_t i = 0; i < num_stages - 1; i++)
+    {
+        pipeline->states[i].output = station_create_queue(stages[i].output_size,
+                stages[i].output_alignment_log2, stages[i].output_capacity_log2);
+        if (pipeline->states[i].output == NULL)
+            goto failure;
+    }
+
+    for (size_t i = 0; i < num_stages; i++)
+    {
+        struct station_concurrent_processing_pipeline_stage_state *state = &pipeline->states[i];
+
+        atomic_init(&state->num_items, 0);
+        atomic_init(&state->num_popped, 0);
+        atomic_init(&state->num_pushed, 0);
+        atomic_init(&state->busy_ns, 0);
+        atomic_init(&state->num_starved, 0);
+        atomic_init(&state->num_blocked, 0);
+        atomic_init(&state->total_occupancy, 0);
+        atomic_init(&state->max_occupancy, 0);
+        atomic_init(&state->num_finished, 0);
+        atomic_init(&state->exhausted, false);
+    }
+
+    // Bind slots to stages and distribute memory of items
+    {
+        size_t slot_idx = 0;
+
+        for (size_t i = 0; i < num_stages; i++)
+            for (station_threads_number_t j = 0; j < stages[i].num_threads; j++)
+            {
+                struct station_concurrent_processing_pipeline_slot *slot = &pipeline->slots[slot_idx];
+
+                slot->stage_idx = i;
+                slot->input = pipeline->items + item_stride * (slot_idx * 2);
+                slot->output = pipeline->items + item_stride * (slot_idx * 2 + 1);
+                slot->has_output = false;
+                slot->finished = false;
+
+                slot_idx++;
+            }
+    }
 
-    threads_state->persistent.num_threads = num_threads;
-    threads_state->persistent.threads = NULL;
+    pipeline->num_workers = 0;
+    pipeline->start_ns = 0;
+    atomic_init(&pipeline->end_ns, 0);
 
-    threads_state->persistent.busy = (atomic_flag)ATOMIC_FLAG_INIT;
+    pipeline->threads_state = NULL;
+    station_concurrent_processing_event_init(&pipeline->progress);
+#endif
 
-    atomic_init(&threads_state->persistent.ping_flag, false);
-    atomic_init(&threads_state->persistent.pong_flag, false);
-    threads_state->persistent.ping_sense = false;
-    threads_state->persistent.pong_sense = false;
+    return pipeline;
 
-    threads_state->persistent.use_ping_cnd = !busy_wait;
+failure:
+    station_concurrent_processing_destroy_pipeline(pipeline);
+    return NULL;
+}
 
-    if (threads_state->persistent.use_ping_cnd)
-    {
-        int res;
+void
+station_concurrent_processing_destroy_pipeline(
+        struct station_concurrent_processing_pipeline *pipeline)
+{
+    if (pipeline == NULL)
+        return;
 
-        res = cnd_init(&threads_state->persistent.ping_cnd);
-        if (res != thrd_success)
-        {
-            if (res == thrd_nomem)
-                return 2;
-            else
-                return 3;
-        }
+#ifdef STATION_IS_CONCURRENT_PROCESSING_SUPPORTED
+    if (pipeline->states != NULL)
+        for (size_t i = 0; i < pipeline->num_stages; i++)
+            station_destroy_queue(pipeline->states[i].output);
 
-        res = mtx_init(&threads_state->persistent.ping_mtx, mtx_plain);
-        if (res != thrd_success)
-        {
-            cnd_destroy(&threads_state->persistent.ping_cnd);
+    free(pipeline->states);
+    free(pipeline->slots);
+#endif
 
-            return 3;
-        }
-    }
+    free(pipeline->stages);
+    free(pipeline->items);
 
-    {
-        int res;
+    free(pipeline);
+}
 
-        res = cnd_init(&threads_state->persistent.pong_cnd);
-        if (res != thrd_success)
-        {
-            cnd_destroy(&threads_state->persistent.ping_cnd);
-            mtx_destroy(&threads_state->persistent.ping_mtx);
+#ifdef STATION_IS_CONCURRENT_PROCESSING_SUPPORTED
 
-            if (res == thrd_nomem)
-                return 2;
-            else
-                return 3;
-        }
+// Result of an attempt of a slot to make progress
+enum station_concurrent_processing_pipeline_step {
+    PIPELINE_STEP_PROGRESS,
+    PIPELINE_STEP_WAIT, // input queue is empty or output queue is full
+    PIPELINE_STEP_FINISHED,
+};
 
-        res = mtx_init(&threads_state->persistent.pong_mtx, mtx_plain);
-        if (res != thrd_success)
-        {
-            cnd_destroy(&threads_state->persistent.ping_cnd);
-            mtx_destroy(&threads_state->persistent.ping_mtx);
-            cnd_destroy(&threads_state->persistent.pong_cnd);
+static
+void
+station_concurrent_processing_pipeline_pushed(
+        struct station_concurrent_processing_pipeline *pipeline,
+        size_t stage_idx)
+{
+    struct station_concurrent_processing_pipeline_stage_state *state = &pipeline->states[stage_idx];
 
-            return 3;
-        }
-    }
+    // Number of items in the queue is estimated by counters of both its ends
+    uint_least64_t num_pushed = atomic_fetch_add_explicit(&state->num_pushed, 1, memory_order_relaxed) + 1;
+    uint_least64_t num_popped = atomic_load_explicit(&pipeline->states[stage_idx + 1].num_popped,
+            memory_order_relaxed);
 
-    threads_state->terminate = false;
+    uint_least64_t occupancy = (num_pushed > num_popped) ? num_pushed - num_popped : 0;
 
-    atomic_init(&threads_state->current.done_tasks, 0);
-    atomic_init(&threads_state->current.thread_counter, 0);
+    atomic_fetch_add_explicit(&state->total_occupancy, occupancy, memory_order_relaxed);
 
-    int code;
+    uint_least64_t value = atomic_load_explicit(&state->max_occupancy, memory_order_relaxed);
+    while ((value < occupancy) && !atomic_compare_exchange_weak_explicit(&state->max_occupancy,
+                &value, occupancy, memory_order_relaxed, memory_order_relaxed));
+}
 
-    // Create threads
-    station_thread_idx_t thread_idx = 0;
+static
+enum station_concurrent_processing_pipeline_step
+station_concurrent_processing_pipeline_step(
+        struct station_concurrent_processing_pipeline *pipeline,
+        struct station_concurrent_processing_pipeline_slot *slot,
+        station_thread_idx_t thread_idx)
+{
+    size_t stage_idx = slot->stage_idx;
+    bool last = (stage_idx == pipeline->num_stages - 1);
 
-    if (num_threads > 0)
-    {
-        threads_state->persistent.threads = malloc(sizeof(thrd_t) * num_threads);
-        if (threads_state->persistent.threads == NULL)
-        {
-            code = 1;
-            goto cleanup;
-        }
-    }
+    const station_concurrent_processing_pipeline_stage_t *stage = &pipeline->stages[stage_idx];
+    struct station_concurrent_processing_pipeline_stage_state *state = &pipeline->states[stage_idx];
 
-    for (thread_idx = 0; thread_idx < num_threads; thread_idx++)
+    // Push the item left from the previous step
+    if (slot->has_output)
     {
-        struct station_concurrent_processing_thread_arg *thread_arg =
-            malloc(sizeof(*thread_arg));
-        if (thread_arg == NULL)
+        if (!station_queue_push(state->output, slot->output))
         {
-            code = 1;
-            goto cleanup;
+            atomic_fetch_add_explicit(&state->num_blocked, 1, memory_order_relaxed);
+            return PIPELINE_STEP_WAIT;
         }
 
-        thread_arg->threads_state = threads_state;
-        thread_arg->thread_idx = thread_idx;
+        slot->has_output = false;
+        station_concurrent_processing_pipeline_pushed(pipeline, stage_idx);
 
-        int res = thrd_create(&threads_state->persistent.threads[thread_idx],
-                station_concurrent_processing_thread, thread_arg);
+        return PIPELINE_STEP_PROGRESS;
+    }
 
-        if (res != thrd_success)
-        {
-            free(thread_arg);
+    // Acquire an input item
+    const void *input = NULL;
 
-            if (res == thrd_nomem)
-                code = 2;
-            else
-                code = 3;
+    if (stage_idx == 0)
+    {
+        if (atomic_load_explicit(&state->exhausted, memory_order_relaxed))
+            return PIPELINE_STEP_FINISHED;
+    }
+    else
+    {
+        struct station_concurrent_processing_pipeline_stage_state *prev_state = &pipeline->states[stage_idx - 1];
 
-            goto cleanup;
+        if (!station_queue_pop(prev_state->output, slot->input))
+        {
+            // Threads of the previous stage push all their items before they finish
+            if (atomic_load_explicit(&prev_state->num_finished, memory_order_acquire) <
+                    pipeline->stages[stage_idx - 1].num_threads)
+            {
+                atomic_fetch_add_explicit(&state->num_starved, 1, memory_order_relaxed);
+                return PIPELINE_STEP_WAIT;
+            }
+            else if (!station_queue_pop(prev_state->output, slot->input))
+                return PIPELINE_STEP_FINISHED;
         }
+
+        atomic_fetch_add_explicit(&state->num_popped, 1, memory_order_relaxed);
+        input = slot->input;
     }
 
-    context->state = threads_state;
-    context->num_threads = num_threads;
-    context->busy_wait = busy_wait;
+    // Process the item
+    uint_least64_t start_ns = station_concurrent_processing_time_ns();
 
-    return 0;
+    bool produced = stage->pfunc(stage->pfunc_data, input, last ? NULL : slot->output, thread_idx);
 
-cleanup:
-    // Wake threads
-    threads_state->terminate = true;
+    atomic_fetch_add_explicit(&state->busy_ns, station_concurrent_processing_time_ns() - start_ns,
+            memory_order_relaxed);
+
+    if ((stage_idx == 0) && !produced) // end of the stream
+    {
+        atomic_store_explicit(&state->exhausted, true, memory_order_relaxed);
+        return PIPELINE_STEP_FINISHED;
+    }
 
-    atomic_store_explicit(&threads_state->persistent.ping_flag,
-            !threads_state->persistent.ping_sense, memory_order_release);
+    atomic_fetch_add_explicit(&state->num_items, 1, memory_order_relaxed);
 
-    if (threads_state->persistent.use_ping_cnd)
+    // Pass the item to the next stage
+    if (produced && !last)
     {
+        if (station_queue_push(state->output, slot->output))
+            station_concurrent_processing_pipeline_pushed(pipeline, stage_idx);
+        else
         {
-#ifndef NDEBUG
-            int res =
-#endif
-                mtx_lock(&threads_state->persistent.ping_mtx);
-            assert(res == thrd_success);
-        }
-        cnd_broadcast(&threads_state->persistent.ping_cnd);
-        {
-#ifndef NDEBUG
-            int res =
-#endif
-                mtx_unlock(&threads_state->persistent.ping_mtx);
-            assert(res == thrd_success);
+            atomic_fetch_add_explicit(&state->num_blocked, 1, memory_order_relaxed);
+            slot->has_output = true;
         }
     }
 
-    for (station_threads_number_t i = 0; i < thread_idx; i++)
-        thrd_join(threads_state->persistent.threads[i], (int*)NULL);
+    return PIPELINE_STEP_PROGRESS;
+}
 
-    free(threads_state->persistent.threads);
+static
+STATION_PFUNC_RANGE(station_concurrent_processing_pfunc_pipeline)
+{
+    struct station_concurrent_processing_pipeline *pipeline = data;
+    struct station_concurrent_processing_event_waiter waiter = {0};
 
-    if (threads_state->persistent.use_ping_cnd)
-    {
-        cnd_destroy(&threads_state->persistent.ping_cnd);
-        mtx_destroy(&threads_state->persistent.ping_mtx);
-    }
+    // Slot i is bound to task (i % num_workers)
+    size_t num_remaining = 0;
+
+    for (size_t worker_idx = task_idx_begin; worker_idx < task_idx_end; worker_idx++)
+        for (size_t i = worker_idx; i < pipeline->num_slots; i += pipeline->num_workers)
+            num_remaining++;
 
+    // A thread with several slots switches between them, so that none of them blocks the others
+    while (num_remaining > 0)
     {
-        cnd_destroy(&threads_state->persistent.pong_cnd);
-        mtx_destroy(&threads_state->persistent.pong_mtx);
-    }
+        bool progress = false;
 
-    free(threads_state);
+        for (size_t worker_idx = task_idx_begin; worker_idx < task_idx_end; worker_idx++)
+            for (size_t i = worker_idx; i < pipeline->num_slots; i += pipeline->num_workers)
+            {
+                struct station_concurrent_processing_pipeline_slot *slot = &pipeline->slots[i];
 
-    return code;
-#endif
-}
+                if (slot->finished)
+                    continue;
 
-void
-station_concurrent_processing_destroy_context(
-        station_concurrent_processing_context_t *context)
-{
-#ifndef STATION_IS_CONCURRENT_PROCESSING_SUPPORTED
-    (void) context;
+                switch (station_concurrent_processing_pipeline_step(pipeline, slot, thread_idx))
+                {
+                    case PIPELINE_STEP_PROGRESS:
+                        progress = true;
+                        break;
 
-    return;
-#else
-    if ((context == NULL) || (context->state == NULL))
-        return;
+                    case PIPELINE_STEP_WAIT:
+                        break;
 
-    context->state->terminate = true;
+                    case PIPELINE_STEP_FINISHED:
+                        slot->finished = true;
+                        num_remaining--;
+                        progress = true;
 
-    atomic_store_explicit(&context->state->persistent.ping_flag,
-            !context->state->persistent.ping_sense, memory_order_release);
+                        atomic_fetch_add_explicit(&pipeline->states[slot->stage_idx].num_finished,
+                                1, memory_order_release);
+                }
+            }
 
-    if (context->state->persistent.use_ping_cnd)
-    {
+        // Items moved by the thread may unblock other threads, otherwise wait for items of other stages
+        if (progress)
         {
-#ifndef NDEBUG
-            int res =
-#endif
-                mtx_lock(&context->state->persistent.ping_mtx);
-            assert(res == thrd_success);
-        }
-        cnd_broadcast(&context->state->persistent.ping_cnd);
-        {
-#ifndef NDEBUG
-            int res =
-#endif
-                mtx_unlock(&context->state->persistent.ping_mtx);
-            assert(res == thrd_success);
+            station_concurrent_processing_event_busy(&pipeline->progress, &waiter);
+            station_concurrent_processing_event_signal(pipeline->threads_state, &pipeline->progress);
         }
+        else
+            station_concurrent_processing_event_idle(pipeline->threads_state, &pipeline->progress, &waiter);
     }
 
-    for (station_threads_number_t i = 0; i < context->state->persistent.num_threads; i++)
-        thrd_join(context->state->persistent.threads[i], (int*)NULL);
-
-    free(context->state->persistent.threads);
-
-    if (context->state->persistent.use_ping_cnd)
-    {
-        cnd_destroy(&context->state->persistent.ping_cnd);
-        mtx_destroy(&context->state->persistent.ping_mtx);
-    }
-
-    {
-        cnd_destroy(&context->state->persistent.pong_cnd);
-        mtx_destroy(&context->state->persistent.pong_mtx);
-    }
+    station_concurrent_processing_event_busy(&pipeline->progress, &waiter);
 
-    free(context->state);
+    uint_least64_t end_ns = station_concurrent_processing_time_ns();
 
-    context->state = NULL;
-    context->num_threads = 0;
-    context->busy_wait = false;
-#endif
+    uint_least64_t value = atomic_load_explicit(&pipeline->end_ns, memory_order_relaxed);
+    while ((value < end_ns) && !atomic_compare_exchange_weak_explicit(&pipeline->end_ns,
+                &value, end_ns, memory_order_relaxed, memory_order_relaxed));
 }
 
+#endif // STATION_IS_CONCURRENT_PROCESSING_SUPPORTED
+
 bool
-station_concurrent_processing_execute(
+station_concurrent_processing_run_pipeline(
         station_concurrent_processing_context_t *context,
-
-        station_tasks_number_t num_tasks,
-        station_tasks_number_t batch_size,
-
-        station_pfunc_t pfunc,
-        void *pfunc_data,
+        struct station_concurrent_processing_pipeline *pipeline,
 
         station_pfunc_callback_t callback,
         void *callback_data,
 
         bool busy_wait)
 {
+    if (pipeline == NULL)
+        return false;
+
 #ifndef STATION_IS_CONCURRENT_PROCESSING_SUPPORTED
     (void) context;
-    (void) batch_size;
     (void) busy_wait;
 
-    if (pfunc == NULL)
-        return false;
+    // Pass every item through all stages
+    const station_concurrent_processing_pipeline_stage_t *stages = pipeline->stages;
+    size_t num_stages = pipeline->num_stages;
 
-    for (station_task_idx_t task_idx = 0; task_idx < num_tasks; task_idx++)
-        pfunc(pfunc_data, task_idx, 0);
+    for (;;)
+    {
+        unsigned char *output = (num_stages > 1) ? pipeline->items : NULL;
+
+        if (!stages[0].pfunc(stages[0].pfunc_data, NULL, output, 0))
+            break;
+
+        for (size_t i = 1; i < num_stages; i++)
+        {
+            const unsigned char *input = output;
+            output = (i < num_stages - 1) ? output + pipeline->item_stride : NULL;
+
+            if (!stages[i].pfunc(stages[i].pfunc_data, input, output, 0))
+                break;
+        }
+    }
 
     if (callback != NULL)
         callback(callback_data, 0);
 
     return true;
 #else
-    if ((context == NULL) || (context->state == NULL) ||
-            (pfunc == NULL) || (num_tasks == 0))
+    if (context == NULL)
         return false;
 
-    if (context->state->persistent.num_threads > 0)
+    // Reset state of the pipeline
+    for (size_t i = 0; i < pipeline->num_stages; i++)
     {
-        // Check if threads are busy, and set the flag if not
-        if (atomic_flag_test_and_set_explicit(&context->state->persistent.busy,
-                    memory_order_acquire))
-            return false;
-
-        // Set the assignment
-        if (batch_size == 0) // automatic batch size
-            batch_size = (num_tasks - 1) / context->state->persistent.num_threads + 1;
-
-        context->state->current.assignment = (struct station_concurrent_processing_assignment){
-            .pfunc = pfunc, .pfunc_data = pfunc_data,
-            .callback = callback, .callback_data = callback_data,
-            .num_tasks = num_tasks, .batch_size = batch_size,
-            .use_pong_cnd = !busy_wait,
-        };
+        struct station_concurrent_processing_pipeline_stage_state *state = &pipeline->states[i];
+
+        atomic_store_explicit(&state->num_items, 0, memory_order_relaxed);
+        atomic_store_explicit(&state->num_popped, 0, memory_order_relaxed);
+        atomic_store_explicit(&state->num_pushed, 0, memory_order_relaxed);
+        atomic_store_explicit(&state->busy_ns, 0, memory_order_relaxed);
+        atomic_store_explicit(&state->num_starved, 0, memory_order_relaxed);
+        atomic_store_explicit(&state->num_blocked, 0, memory_order_relaxed);
+        atomic_store_explicit(&state->total_occupancy, 0, memory_order_relaxed);
+        atomic_store_explicit(&state->max_occupancy, 0, memory_order_relaxed);
+        atomic_store_explicit(&state->num_finished, 0, memory_order_relaxed);
+        atomic_store_explicit(&state->exhausted, false, memory_order_relaxed);
+    }
 
-        // Initialize counters and flags
-        context->state->current.done_tasks = 0;
-        context->state->current.thread_counter = 0;
+    for (size_t i = 0; i < pipeline->num_slots; i++)
+    {
+        pipeline->slots[i].has_output = false;
+        pipeline->slots[i].finished = false;
+    }
 
-        bool ping_sense = context->state->persistent.ping_sense =
-            !context->state->persistent.ping_sense;
-        bool pong_sense = context->state->persistent.pong_sense =
-            !context->state->persistent.pong_sense;
+    // Every slot gets own thread if there are enough of them
+    pipeline->num_workers = (size_t)context->num_threads + 1;
+    if (pipeline->num_workers > pipeline->num_slots)
+        pipeline->num_workers = pipeline->num_slots;
+
+    pipeline->start_ns = station_concurrent_processing_time_ns();
+    atomic_store_explicit(&pipeline->end_ns, 0, memory_order_relaxed);
+
+    pipeline->threads_state = context->state;
+
+    // All tasks of a thread are processed in a single call, as they depend on each other
+    return station_concurrent_processing_execute_assignment(context,
+            (struct station_concurrent_processing_assignment){
+                .pfunc_range = station_concurrent_processing_pfunc_pipeline,
+                .pfunc_range_data = pipeline,
+                .callback = callback, .callback_data = callback_data,
+                .num_tasks = pipeline->num_workers, .batch_size = pipeline->num_workers,
+                .schedule = STATION_CONCURRENT_PROCESSING_SCHEDULE_STATIC, .fixed_schedule = true,
+                .uncancellable = true, // items must not be left in queues
+            }, busy_wait);
+#endif
+}
 
-        // Wake slave threads
-        atomic_store_explicit(&context->state->persistent.ping_flag, ping_sense, memory_order_release);
+bool
+station_concurrent_processing_get_pipeline_stats(
+        const struct station_concurrent_processing_pipeline *pipeline,
+        size_t stage_idx,
+        station_concurrent_processing_pipeline_stats_t *stats)
+{
+#ifndef STATION_IS_CONCURRENT_PROCESSING_SUPPORTED
+    (void) pipeline;
+    (void) stage_idx;
+    (void) stats;
 
-        if (context->state->persistent.use_ping_cnd)
-        {
-            {
-#ifndef NDEBUG
-                int res =
-#endif
-                    mtx_lock(&context->state->persistent.ping_mtx);
-                assert(res == thrd_success);
-            }
-            cnd_broadcast(&context->state->persistent.ping_cnd);
-            {
-#ifndef NDEBUG
-                int res =
-#endif
-                    mtx_unlock(&context->state->persistent.ping_mtx);
-                assert(res == thrd_success);
-            }
-        }
+    return false;
+#else
+    if ((pipeline == NULL) || (stage_idx >= pipeline->num_stages) || (stats == NULL))
+        return false;
 
-        if (callback == NULL)
-        {
-            if (context->state->current.assignment.use_pong_cnd)
-            {
-#ifndef NDEBUG
-                int res =
-#endif
-                    mtx_lock(&context->state->persistent.pong_mtx);
-                assert(res == thrd_success);
-            }
+    struct station_concurrent_processing_pipeline_stage_state *state = &pipeline->states[stage_idx];
 
-            // Wait until all tasks are done
-            while (atomic_load_explicit(&context->state->persistent.pong_flag,
-                        memory_order_acquire) != pong_sense)
-            {
-                if (context->state->current.assignment.use_pong_cnd)
-                {
-#ifndef NDEBUG
-                    int res =
-#endif
-                        cnd_wait(&context->state->persistent.pong_cnd,
-                                &context->state->persistent.pong_mtx);
-                    assert(res == thrd_success);
-                }
-            }
+    uint_least64_t end_ns = atomic_load_explicit(&pipeline->end_ns, memory_order_relaxed);
+    uint_least64_t num_pushed = atomic_load_explicit(&state->num_pushed, memory_order_relaxed);
 
-            if (context->state->current.assignment.use_pong_cnd)
-            {
-#ifndef NDEBUG
-                int res =
-#endif
-                    mtx_unlock(&context->state->persistent.pong_mtx);
-                assert(res == thrd_success);
-            }
-        }
-    }
-    else
-    {
-        for (station_task_idx_t task_idx = 0; task_idx < num_tasks; task_idx++)
-            pfunc(pfunc_data, task_idx, 0);
+    *stats = (station_concurrent_processing_pipeline_stats_t){
+        .num_items = atomic_load_explicit(&state->num_items, memory_order_relaxed),
+        .busy_ns = atomic_load_explicit(&state->busy_ns, memory_order_relaxed),
+        .num_starved = atomic_load_explicit(&state->num_starved, memory_order_relaxed),
+        .num_blocked = atomic_load_explicit(&state->num_blocked, memory_order_relaxed),
+        .max_occupancy = atomic_load_explicit(&state->max_occupancy, memory_order_relaxed),
+        .mean_occupancy = (num_pushed > 0) ? (double)atomic_load_explicit(&state->total_occupancy,
+                memory_order_relaxed) / num_pushed : 0,
+    };
 
-        if (callback != NULL)
-            callback(callback_data, 0);
-    }
+    stats->throughput = (end_ns > pipeline->start_ns) ?
+        stats->num_items * 1e9 / (end_ns - pipeline->start_ns) : 0;
 
     return true;
 #endif
@@ -1526,6 +6799,40 @@ station_sdl_window_unlock_texture_and_render(
 #endif
 }
 
+bool
+station_sdl_window_texture_domain(
+        const station_sdl_window_context_t *context,
+
+        uint32_t tile_width,
+        uint32_t tile_height,
+        station_concurrent_processing_tile_order_t tile_order,
+
+        station_concurrent_processing_domain_t *domain)
+{
+#ifndef STATION_IS_SDL_SUPPORTED
+    (void) context;
+    (void) tile_width;
+    (void) tile_height;
+    (void) tile_order;
+    (void) domain;
+
+    return false;
+#else
+    if ((context == NULL) || (context->texture.lock.pixels == NULL) || (domain == NULL))
+        return false;
+
+    *domain = (station_concurrent_processing_domain_t){
+        .origin = {.x = context->texture.lock.rectangle.x, .y = context->texture.lock.rectangle.y},
+        .extent = {.width = context->texture.lock.rectangle.width,
+            .height = context->texture.lock.rectangle.height, .depth = 1},
+        .tile = {.width = tile_width, .height = tile_height, .depth = 1},
+        .order = tile_order,
+    };
+
+    return true;
+#endif
+}
+
 bool
 station_sdl_window_texture_draw_glyph(
         station_sdl_window_context_t *context,